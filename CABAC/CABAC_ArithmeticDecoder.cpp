@@ -34,7 +34,8 @@
 #include "CABAC_ArithmeticDecoder.h"
 #include <assert.h>
 
-CABAC_ArithmeticDecoder::CABAC_ArithmeticDecoder(CABAC_BitstreamFile* ptCabacBitstream)
+template <class TBitstream>
+TCABAC_ArithmeticDecoder<TBitstream>::TCABAC_ArithmeticDecoder(TBitstream* ptCabacBitstream)
 {
   m_ptBitstream = ptCabacBitstream;
 #if RWTH_TRACE_CABAC_TO_FILE
@@ -42,22 +43,28 @@ CABAC_ArithmeticDecoder::CABAC_ArithmeticDecoder(CABAC_BitstreamFile* ptCabacBit
 #endif
 }
 
-CABAC_ArithmeticDecoder::~CABAC_ArithmeticDecoder()
+template <class TBitstream>
+TCABAC_ArithmeticDecoder<TBitstream>::~TCABAC_ArithmeticDecoder()
 {
 }
 
-void CABAC_ArithmeticDecoder::setBitstream( CABAC_BitstreamFile* ptCabacBitstream )
+template <class TBitstream>
+void TCABAC_ArithmeticDecoder<TBitstream>::setBitstream( TBitstream* ptCabacBitstream )
 {
   m_ptBitstream = ptCabacBitstream;
 }
 
-void CABAC_ArithmeticDecoder::start()
+template <class TBitstream>
+void TCABAC_ArithmeticDecoder<TBitstream>::start()
 {
   assert( m_ptBitstream->getNumBitsUntilByteAligned() == 0 );
   m_uiRange    = 510;
   m_bitsNeeded = -8;
   m_uiValue    = (m_ptBitstream->readByte() << 8);
   m_uiValue   |= m_ptBitstream->readByte();
+#if TRACE_STATISTICS_BITRATE
+  m_fracBits   = 0;
+#endif
 #if RWTH_TRACE_CABAC
   m_uiLow = 0;
   m_bitsLeft = 23;
@@ -70,7 +77,8 @@ void CABAC_ArithmeticDecoder::start()
   DTRACE_CABAC_N;
 }
 
-void CABAC_ArithmeticDecoder::finish()
+template <class TBitstream>
+void TCABAC_ArithmeticDecoder<TBitstream>::finish()
 {
   // Decode terminating bit and assert it is 1
   unsigned int uiBit;
@@ -84,7 +92,8 @@ void CABAC_ArithmeticDecoder::finish()
 #endif
 }
 
-void CABAC_ArithmeticDecoder::decodeBin( unsigned int& ruiBin, ContextModel *rcCtxModel )
+template <class TBitstream>
+void TCABAC_ArithmeticDecoder<TBitstream>::decodeBin( unsigned int& ruiBin, ContextModel *rcCtxModel )
 {
 #if RWTH_TRACE_CABAC
   unsigned int uiMpsBefore = rcCtxModel->getMps();
@@ -101,7 +110,7 @@ void CABAC_ArithmeticDecoder::decodeBin( unsigned int& ruiBin, ContextModel *rcC
     ruiBin = rcCtxModel->getMps();
 #if TRACE_STATISTICS_BITRATE
     // MPS recieved. Add frac bits before updating the context
-    m_fracBits += rcCtxModel.getEntropyBits( ruiBin );
+    m_fracBits += rcCtxModel->getEntropyBits( ruiBin );
 #endif
     rcCtxModel->updateMPS();
     
@@ -151,6 +160,9 @@ void CABAC_ArithmeticDecoder::decodeBin( unsigned int& ruiBin, ContextModel *rcC
 #endif
     m_uiRange   = uiLPS << numBits;
     ruiBin      = 1 - rcCtxModel->getMps();
+#if TRACE_STATISTICS_BITRATE
+    m_fracBits += rcCtxModel->getEntropyBits( ruiBin );
+#endif
     rcCtxModel->updateLPS();
     
     m_bitsNeeded += numBits;
@@ -189,8 +201,109 @@ void CABAC_ArithmeticDecoder::decodeBin( unsigned int& ruiBin, ContextModel *rcC
 #endif
 }
 
+/**
+ * \brief Decode one bin with the dual-rate model, see TCABAC_ArithmeticEncoder::encodeBin()
+ *
+ * \param ruiBin     decoded bin
+ * \param rcCtxModel context model
+ */
+template <class TBitstream>
+void TCABAC_ArithmeticDecoder<TBitstream>::decodeBin( unsigned int& ruiBin, ContextModelDualRate *rcCtxModel )
+{
+  unsigned int uiLPS = rcCtxModel->getLPS( m_uiRange );
+  m_uiRange -= uiLPS;
+  unsigned int scaledRange = m_uiRange << 7;
+
+  if( m_uiValue < scaledRange )
+  {
+    // MPS path
+    ruiBin = rcCtxModel->getMps();
+    if ( scaledRange < ( 256 << 7 ) )
+    {
+      m_uiRange = scaledRange >> 6;
+      m_uiValue += m_uiValue;
+#if RWTH_TRACE_CABAC
+      m_uiLow <<= 1;
+      m_bitsLeft--;
+#endif
+      if ( ++m_bitsNeeded == 0 )
+      {
+        m_bitsNeeded = -8;
+        m_uiValue += m_ptBitstream->readByte();
+      }
+    }
+  }
+  else
+  {
+    // LPS path
+    int numBits = sm_aucRenormTable[ uiLPS >> 3 ];
+    m_uiValue   = ( m_uiValue - scaledRange ) << numBits;
+#if RWTH_TRACE_CABAC
+    m_uiLow = (m_uiLow + m_uiRange) << numBits;
+    m_bitsLeft -= numBits;
+#endif
+    m_uiRange   = uiLPS << numBits;
+    ruiBin      = 1 - rcCtxModel->getMps();
+    m_bitsNeeded += numBits;
+    if ( m_bitsNeeded >= 0 )
+    {
+      m_uiValue += m_ptBitstream->readByte() << m_bitsNeeded;
+      m_bitsNeeded -= 8;
+    }
+  }
+  rcCtxModel->update( ruiBin );
+#if RWTH_TRACE_CABAC
+  if (m_bitsLeft < 12)
+  {
+    m_bitsLeft += 8;
+    m_uiLow &= 0xffffffffu >> m_bitsLeft;
+  }
+#endif
+}
+
+/** Decode one bin like decodeBin, using the packed state table and without branching on MPS/LPS
+ *
+ * The LPS ranges and both next states of the context are read from one 8 byte entry of
+ * sm_asPackedStateTable. MPS and LPS are selected with conditional moves and the number
+ * of renormalization bits is derived from the leading zeros of the new range. Setting bit 2
+ * limits it to 6, which is what sm_aucRenormTable gives for the LPS range 2 of the terminating
+ * state 63. The decoded bins and context states are identical to decodeBin.
+ */
+template <class TBitstream>
+void TCABAC_ArithmeticDecoder<TBitstream>::decodeBinPacked( unsigned int& ruiBin, ContextModel *rcCtxModel )
+{
+#if RWTH_TRACE_CABAC
+  decodeBin( ruiBin, rcCtxModel );
+#else
+  unsigned int uiStateIdx = rcCtxModel->getStateIdx();
+  const PackedState& rcState = sm_asPackedStateTable[ uiStateIdx ];
+
+  unsigned int uiLPS = rcState.aucLPS[ ( m_uiRange >> 6 ) & 3 ];
+  unsigned int uiRangeMPS = m_uiRange - uiLPS;
+  unsigned int scaledRange = uiRangeMPS << 7;
+
+  unsigned int uiIsLPS = ( m_uiValue >= scaledRange );
+  m_uiValue -= scaledRange & ( 0u - uiIsLPS );
+  unsigned int uiRange = uiIsLPS ? uiLPS : uiRangeMPS;
+  ruiBin = ( uiStateIdx & 1 ) ^ uiIsLPS;
+  rcCtxModel->updateStateIdx( rcState.aucNextState[ uiIsLPS ] );
+
+  int numBits = (int)countLeadingZeros32( uiRange | 4 ) - 23;
+  m_uiValue <<= numBits;
+  m_uiRange    = uiRange << numBits;
+  m_bitsNeeded += numBits;
+
+  if ( m_bitsNeeded >= 0 )
+  {
+    m_uiValue += m_ptBitstream->readByte() << m_bitsNeeded;
+    m_bitsNeeded -= 8;
+  }
+#endif
+}
+
 #if RWTH_CABAC_FIXED_PROBABILITY
-void CABAC_ArithmeticDecoder::decodeBinProb(unsigned int& ruiBin, unsigned int uiProbability)
+template <class TBitstream>
+void TCABAC_ArithmeticDecoder<TBitstream>::decodeBinProb(unsigned int& ruiBin, unsigned int uiProbability)
 {
   assert(uiProbability > 0 && uiProbability < 100);
   if (uiProbability == 50)
@@ -285,7 +398,8 @@ void CABAC_ArithmeticDecoder::decodeBinProb(unsigned int& ruiBin, unsigned int u
 }
 #endif
 
-void CABAC_ArithmeticDecoder::decodeBinEP( unsigned int& ruiBin )
+template <class TBitstream>
+void TCABAC_ArithmeticDecoder<TBitstream>::decodeBinEP( unsigned int& ruiBin )
 {
   m_uiValue += m_uiValue;
 #if TRACE_STATISTICS_BITRATE
@@ -330,97 +444,94 @@ void CABAC_ArithmeticDecoder::decodeBinEP( unsigned int& ruiBin )
 #endif
 }
 
-void CABAC_ArithmeticDecoder::decodeBinsEP( unsigned int& ruiBin, int numBins )
+/**
+ * \brief Decode up to 32 equiprobable bins, the first bin ends up in the most significant bit of ruiBin
+ *
+ * The bins are taken from the value register in chunks of up to 16 at once. The bins of
+ * a chunk are the quotient of the value and the range. Instead of comparing and subtracting 
+ * bin by bin, the quotient is computed with a multiplication by the reciprocal of the range 
+ * (sm_auiRangeReciprocal) and one correction step. This gives the same bins as decoding 
+ * them one by one with decodeBinEP.
+ *
+ * \param ruiBin  decoded bins
+ * \param numBins number of bins (0...32)
+ */
+template <class TBitstream>
+void TCABAC_ArithmeticDecoder<TBitstream>::decodeBinsEP( unsigned int& ruiBin, int numBins )
 {
+  assert( numBins >= 0 && numBins <= 32 );
   unsigned int bins = 0;
+#if TRACE_STATISTICS_BITRATE
+  m_fracBits += (uint64_t)numBins << 15;
+#endif
 
-  while ( numBins > 8 )
+  if ( numBins > 16 )
   {
-    m_uiValue = ( m_uiValue << 8 ) + ( m_ptBitstream->readByte() << ( 8 + m_bitsNeeded ) );
-    
-    unsigned int scaledRange = m_uiRange << 15;
-    for ( int i = 0; i < 8; i++ )
-    {
-      bins += bins;
-      scaledRange >>= 1;
-      if ( m_uiValue >= scaledRange )
-      {
-        bins++;
-        m_uiValue -= scaledRange;
-      }
-    }
-    numBins -= 8;
-
-    DTRACE_CABAC_T("CABAC encode EP 8_symbol=");
-    DTRACE_CABAC_VB(bins & 255, 8);
-    DTRACE_CABAC_T(" EP");
-#if RWTH_TRACE_CABAC    
-    m_uiLow <<= 8;
-    unsigned int pattern = bins & 255;
-    m_uiLow += m_uiRange * pattern;
-    m_bitsLeft -= 8;
-    DTRACE_CABAC_T(" L=");
-    DTRACE_CABAC_V(m_uiLow);
-    DTRACE_CABAC_T(" R=");
-    DTRACE_CABAC_V(m_uiRange);
-    // Test and write out
-    if (m_bitsLeft < 12)
-    {
-      m_bitsLeft += 8;
-      m_uiLow &= 0xffffffffu >> m_bitsLeft;
-    }
-#endif
-    DTRACE_CABAC_N;
+    bins = xDecodeBinsEP( numBins - 16 ) << 16;
+    numBins = 16;
   }
-  
+  bins |= xDecodeBinsEP( numBins );
+
+  ruiBin = bins;
+}
+
+/**
+ * \brief Decode a chunk of up to 16 equiprobable bins, see decodeBinsEP()
+ */
+template <class TBitstream>
+unsigned int TCABAC_ArithmeticDecoder<TBitstream>::xDecodeBinsEP( int numBins )
+{
+  // Shift the bins into the value register, m_uiValue < ( m_uiRange << 7 ) so 16 bins fit into 32 bits
+  unsigned int uiValue = m_uiValue << numBins;
   m_bitsNeeded += numBins;
-  m_uiValue <<= numBins;
-  
-  if ( m_bitsNeeded >= 0 )
+  while ( m_bitsNeeded >= 0 )
   {
-    m_uiValue += m_ptBitstream->readByte() << m_bitsNeeded;
+    uiValue += m_ptBitstream->readByte() << m_bitsNeeded;
     m_bitsNeeded -= 8;
   }
-  
-  unsigned int scaledRange = m_uiRange << ( numBins + 7 );
-  for ( int i = 0; i < numBins; i++ )
-  {
-    bins += bins;
-    scaledRange >>= 1;
-    if ( m_uiValue >= scaledRange )
-    {
-      bins++;
-      m_uiValue -= scaledRange;
-    }
-  }
 
-  DTRACE_CABAC_T("CABAC encode EP ");
+  // The bins are ( uiValue >> 7 ) / m_uiRange. The estimate is exact or one too small.
+  unsigned int uiScaledValue = uiValue >> 7;
+  unsigned int bins = (unsigned int)( ( (uint64_t)uiScaledValue * sm_auiRangeReciprocal[ m_uiRange - 256 ] ) >> 32 );
+  unsigned int uiRemainder = uiScaledValue - bins * m_uiRange;
+  unsigned int uiCorrection = ( uiRemainder >= m_uiRange );
+  bins += uiCorrection;
+  uiRemainder -= m_uiRange & ( 0u - uiCorrection );
+  m_uiValue = ( uiRemainder << 7 ) | ( uiValue & 0x7f );
+
+  DTRACE_CABAC_T("CABAC decode EP ");
   DTRACE_CABAC_V(numBins);
   DTRACE_CABAC_T("_symbol=");
-  DTRACE_CABAC_VB(bins & ((1<<numBins)-1), numBins);
+  DTRACE_CABAC_VB(bins, numBins);
   DTRACE_CABAC_T(" EP");
 #if RWTH_TRACE_CABAC
-  m_uiLow <<= numBins;
-  unsigned int pattern = bins & ((1 << numBins) - 1);
-  m_uiLow += m_uiRange * pattern;
-  m_bitsLeft -= numBins;
+  for ( int i = numBins - 1; i >= 0; i-- )
+  {
+    m_uiLow <<= 1;
+    if ( ( bins >> i ) & 1 )
+    {
+      m_uiLow += m_uiRange;
+    }
+    m_bitsLeft--;
+    // Test and write out
+    if (m_bitsLeft < 12)
+    {
+      m_bitsLeft += 8;
+      m_uiLow &= 0xffffffffu >> m_bitsLeft;
+    }
+  }
   DTRACE_CABAC_T(" L=");
   DTRACE_CABAC_V(m_uiLow);
   DTRACE_CABAC_T(" R=");
   DTRACE_CABAC_V(m_uiRange);
-  // Test and write out
-  if (m_bitsLeft < 12)
-  {
-    m_bitsLeft += 8;
-    m_uiLow &= 0xffffffffu >> m_bitsLeft;
-  }
 #endif
   DTRACE_CABAC_N;
 
-  ruiBin = bins;
+  return bins;
 }
 
-void CABAC_ArithmeticDecoder::decodeBinTrm( unsigned int& ruiBin )
+template <class TBitstream>
+void TCABAC_ArithmeticDecoder<TBitstream>::decodeBinTrm( unsigned int& ruiBin )
 {
   m_uiRange -= 2;
   unsigned int scaledRange = m_uiRange << 7;
@@ -471,7 +582,8 @@ void CABAC_ArithmeticDecoder::decodeBinTrm( unsigned int& ruiBin )
 #endif
 }
 
-const unsigned char CABAC_ArithmeticDecoder::sm_aucLPSTable[64][4] =
+template <class TBitstream>
+const unsigned char TCABAC_ArithmeticDecoder<TBitstream>::sm_aucLPSTable[64][4] =
 {
   { 128, 176, 208, 240},
   { 128, 167, 197, 227},
@@ -539,7 +651,8 @@ const unsigned char CABAC_ArithmeticDecoder::sm_aucLPSTable[64][4] =
   {   2,   2,   2,   2}
 };
 
-const unsigned char CABAC_ArithmeticDecoder::sm_aucRenormTable[32] =
+template <class TBitstream>
+const unsigned char TCABAC_ArithmeticDecoder<TBitstream>::sm_aucRenormTable[32] =
 {
   6,  5,  4,  4,
   3,  3,  3,  3,
@@ -551,8 +664,181 @@ const unsigned char CABAC_ArithmeticDecoder::sm_aucRenormTable[32] =
   1,  1,  1,  1
 };
 
+/// floor( 2^32 / range ) for the ranges 256...511
+template <class TBitstream>
+const unsigned int TCABAC_ArithmeticDecoder<TBitstream>::sm_auiRangeReciprocal[256] =
+{
+  0x1000000, 0xff00ff, 0xfe03f8, 0xfd08e5, 0xfc0fc0, 0xfb1885, 0xfa232c, 0xf92fb2,
+  0xf83e0f, 0xf74e3f, 0xf6603d, 0xf57403, 0xf4898d, 0xf3a0d5, 0xf2b9d6, 0xf1d48b,
+  0xf0f0f0, 0xf00f00, 0xef2eb7, 0xee500e, 0xed7303, 0xec9791, 0xebbdb2, 0xeae564,
+  0xea0ea0, 0xe93965, 0xe865ac, 0xe79372, 0xe6c2b4, 0xe5f36c, 0xe52598, 0xe45932,
+  0xe38e38, 0xe2c4a6, 0xe1fc78, 0xe135a9, 0xe07038, 0xdfac1f, 0xdee95c, 0xde27eb,
+  0xdd67c8, 0xdca8f1, 0xdbeb61, 0xdb2f17, 0xda740d, 0xd9ba42, 0xd901b2, 0xd84a59,
+  0xd79435, 0xd6df43, 0xd62b80, 0xd578e9, 0xd4c77b, 0xd41732, 0xd3680d, 0xd2ba08,
+  0xd20d20, 0xd16154, 0xd0b69f, 0xd00d00, 0xcf6474, 0xcebcf8, 0xce168a, 0xcd7127,
+  0xcccccc, 0xcc2978, 0xcb8727, 0xcae5d8, 0xca4587, 0xc9a633, 0xc907da, 0xc86a78,
+  0xc7ce0c, 0xc73293, 0xc6980c, 0xc5fe74, 0xc565c8, 0xc4ce07, 0xc4372f, 0xc3a13d,
+  0xc30c30, 0xc27806, 0xc1e4bb, 0xc15250, 0xc0c0c0, 0xc0300c, 0xbfa02f, 0xbf112a,
+  0xbe82fa, 0xbdf59c, 0xbd6910, 0xbcdd53, 0xbc5264, 0xbbc840, 0xbb3ee7, 0xbab656,
+  0xba2e8b, 0xb9a786, 0xb92143, 0xb89bc3, 0xb81702, 0xb79300, 0xb70fbb, 0xb68d31,
+  0xb60b60, 0xb58a48, 0xb509e6, 0xb48a39, 0xb40b40, 0xb38cf9, 0xb30f63, 0xb2927c,
+  0xb21642, 0xb19ab5, 0xb11fd3, 0xb0a59b, 0xb02c0b, 0xafb321, 0xaf3add, 0xaec33e,
+  0xae4c41, 0xadd5e6, 0xad602b, 0xaceb0f, 0xac7691, 0xac02b0, 0xab8f69, 0xab1cbd,
+  0xaaaaaa, 0xaa392f, 0xa9c84a, 0xa957fa, 0xa8e83f, 0xa87917, 0xa80a80, 0xa79c7b,
+  0xa72f05, 0xa6c21d, 0xa655c4, 0xa5e9f6, 0xa57eb5, 0xa513fd, 0xa4a9cf, 0xa44029,
+  0xa3d70a, 0xa36e71, 0xa3065e, 0xa29ecf, 0xa237c3, 0xa1d139, 0xa16b31, 0xa105a9,
+  0xa0a0a0, 0xa03c16, 0x9fd809, 0x9f747a, 0x9f1165, 0x9eaecc, 0x9e4cad, 0x9deb06,
+  0x9d89d8, 0x9d2921, 0x9cc8e1, 0x9c6916, 0x9c09c0, 0x9baade, 0x9b4c6f, 0x9aee72,
+  0x9a90e7, 0x9a33cd, 0x99d722, 0x997ae7, 0x991f1a, 0x98c3ba, 0x9868c8, 0x980e41,
+  0x97b425, 0x975a75, 0x97012e, 0x96a850, 0x964fda, 0x95f7cc, 0x95a025, 0x9548e4,
+  0x94f209, 0x949b92, 0x944580, 0x93efd1, 0x939a85, 0x93459b, 0x92f113, 0x929ceb,
+  0x924924, 0x91f5bc, 0x91a2b3, 0x915009, 0x90fdbc, 0x90abcc, 0x905a38, 0x900900,
+  0x8fb823, 0x8f67a1, 0x8f1779, 0x8ec7ab, 0x8e7835, 0x8e2917, 0x8dda52, 0x8d8be3,
+  0x8d3dcb, 0x8cf008, 0x8ca29c, 0x8c5584, 0x8c08c0, 0x8bbc50, 0x8b7034, 0x8b246a,
+  0x8ad8f2, 0x8a8dcd, 0x8a42f8, 0x89f874, 0x89ae40, 0x89645c, 0x891ac7, 0x88d180,
+  0x888888, 0x883fdd, 0x87f780, 0x87af6f, 0x8767ab, 0x872032, 0x86d905, 0x869222,
+  0x864b8a, 0x86053c, 0x85bf37, 0x85797b, 0x853408, 0x84eedd, 0x84a9f9, 0x84655d,
+  0x842108, 0x83dcf9, 0x839930, 0x8355ac, 0x83126e, 0x82cf75, 0x828cbf, 0x824a4e,
+  0x820820, 0x81c635, 0x81848d, 0x814327, 0x810204, 0x80c121, 0x808080, 0x804020
+};
+
+/// sm_aucLPSTable and the ContextModel state transitions combined per (state << 1) + MPS
+template <class TBitstream>
+const typename TCABAC_ArithmeticDecoder<TBitstream>::PackedState TCABAC_ArithmeticDecoder<TBitstream>::sm_asPackedStateTable[128] =
+{
+  { { 128, 176, 208, 240 }, {   2,   1 }, { 0, 0 } }, // state  0, mps 0
+  { { 128, 176, 208, 240 }, {   3,   0 }, { 0, 0 } }, // state  0, mps 1
+  { { 128, 167, 197, 227 }, {   4,   0 }, { 0, 0 } }, // state  1, mps 0
+  { { 128, 167, 197, 227 }, {   5,   1 }, { 0, 0 } }, // state  1, mps 1
+  { { 128, 158, 187, 216 }, {   6,   2 }, { 0, 0 } }, // state  2, mps 0
+  { { 128, 158, 187, 216 }, {   7,   3 }, { 0, 0 } }, // state  2, mps 1
+  { { 123, 150, 178, 205 }, {   8,   4 }, { 0, 0 } }, // state  3, mps 0
+  { { 123, 150, 178, 205 }, {   9,   5 }, { 0, 0 } }, // state  3, mps 1
+  { { 116, 142, 169, 195 }, {  10,   4 }, { 0, 0 } }, // state  4, mps 0
+  { { 116, 142, 169, 195 }, {  11,   5 }, { 0, 0 } }, // state  4, mps 1
+  { { 111, 135, 160, 185 }, {  12,   8 }, { 0, 0 } }, // state  5, mps 0
+  { { 111, 135, 160, 185 }, {  13,   9 }, { 0, 0 } }, // state  5, mps 1
+  { { 105, 128, 152, 175 }, {  14,   8 }, { 0, 0 } }, // state  6, mps 0
+  { { 105, 128, 152, 175 }, {  15,   9 }, { 0, 0 } }, // state  6, mps 1
+  { { 100, 122, 144, 166 }, {  16,  10 }, { 0, 0 } }, // state  7, mps 0
+  { { 100, 122, 144, 166 }, {  17,  11 }, { 0, 0 } }, // state  7, mps 1
+  { {  95, 116, 137, 158 }, {  18,  12 }, { 0, 0 } }, // state  8, mps 0
+  { {  95, 116, 137, 158 }, {  19,  13 }, { 0, 0 } }, // state  8, mps 1
+  { {  90, 110, 130, 150 }, {  20,  14 }, { 0, 0 } }, // state  9, mps 0
+  { {  90, 110, 130, 150 }, {  21,  15 }, { 0, 0 } }, // state  9, mps 1
+  { {  85, 104, 123, 142 }, {  22,  16 }, { 0, 0 } }, // state 10, mps 0
+  { {  85, 104, 123, 142 }, {  23,  17 }, { 0, 0 } }, // state 10, mps 1
+  { {  81,  99, 117, 135 }, {  24,  18 }, { 0, 0 } }, // state 11, mps 0
+  { {  81,  99, 117, 135 }, {  25,  19 }, { 0, 0 } }, // state 11, mps 1
+  { {  77,  94, 111, 128 }, {  26,  18 }, { 0, 0 } }, // state 12, mps 0
+  { {  77,  94, 111, 128 }, {  27,  19 }, { 0, 0 } }, // state 12, mps 1
+  { {  73,  89, 105, 122 }, {  28,  22 }, { 0, 0 } }, // state 13, mps 0
+  { {  73,  89, 105, 122 }, {  29,  23 }, { 0, 0 } }, // state 13, mps 1
+  { {  69,  85, 100, 116 }, {  30,  22 }, { 0, 0 } }, // state 14, mps 0
+  { {  69,  85, 100, 116 }, {  31,  23 }, { 0, 0 } }, // state 14, mps 1
+  { {  66,  80,  95, 110 }, {  32,  24 }, { 0, 0 } }, // state 15, mps 0
+  { {  66,  80,  95, 110 }, {  33,  25 }, { 0, 0 } }, // state 15, mps 1
+  { {  62,  76,  90, 104 }, {  34,  26 }, { 0, 0 } }, // state 16, mps 0
+  { {  62,  76,  90, 104 }, {  35,  27 }, { 0, 0 } }, // state 16, mps 1
+  { {  59,  72,  86,  99 }, {  36,  26 }, { 0, 0 } }, // state 17, mps 0
+  { {  59,  72,  86,  99 }, {  37,  27 }, { 0, 0 } }, // state 17, mps 1
+  { {  56,  69,  81,  94 }, {  38,  30 }, { 0, 0 } }, // state 18, mps 0
+  { {  56,  69,  81,  94 }, {  39,  31 }, { 0, 0 } }, // state 18, mps 1
+  { {  53,  65,  77,  89 }, {  40,  30 }, { 0, 0 } }, // state 19, mps 0
+  { {  53,  65,  77,  89 }, {  41,  31 }, { 0, 0 } }, // state 19, mps 1
+  { {  51,  62,  73,  85 }, {  42,  32 }, { 0, 0 } }, // state 20, mps 0
+  { {  51,  62,  73,  85 }, {  43,  33 }, { 0, 0 } }, // state 20, mps 1
+  { {  48,  59,  69,  80 }, {  44,  32 }, { 0, 0 } }, // state 21, mps 0
+  { {  48,  59,  69,  80 }, {  45,  33 }, { 0, 0 } }, // state 21, mps 1
+  { {  46,  56,  66,  76 }, {  46,  36 }, { 0, 0 } }, // state 22, mps 0
+  { {  46,  56,  66,  76 }, {  47,  37 }, { 0, 0 } }, // state 22, mps 1
+  { {  43,  53,  63,  72 }, {  48,  36 }, { 0, 0 } }, // state 23, mps 0
+  { {  43,  53,  63,  72 }, {  49,  37 }, { 0, 0 } }, // state 23, mps 1
+  { {  41,  50,  59,  69 }, {  50,  38 }, { 0, 0 } }, // state 24, mps 0
+  { {  41,  50,  59,  69 }, {  51,  39 }, { 0, 0 } }, // state 24, mps 1
+  { {  39,  48,  56,  65 }, {  52,  38 }, { 0, 0 } }, // state 25, mps 0
+  { {  39,  48,  56,  65 }, {  53,  39 }, { 0, 0 } }, // state 25, mps 1
+  { {  37,  45,  54,  62 }, {  54,  42 }, { 0, 0 } }, // state 26, mps 0
+  { {  37,  45,  54,  62 }, {  55,  43 }, { 0, 0 } }, // state 26, mps 1
+  { {  35,  43,  51,  59 }, {  56,  42 }, { 0, 0 } }, // state 27, mps 0
+  { {  35,  43,  51,  59 }, {  57,  43 }, { 0, 0 } }, // state 27, mps 1
+  { {  33,  41,  48,  56 }, {  58,  44 }, { 0, 0 } }, // state 28, mps 0
+  { {  33,  41,  48,  56 }, {  59,  45 }, { 0, 0 } }, // state 28, mps 1
+  { {  32,  39,  46,  53 }, {  60,  44 }, { 0, 0 } }, // state 29, mps 0
+  { {  32,  39,  46,  53 }, {  61,  45 }, { 0, 0 } }, // state 29, mps 1
+  { {  30,  37,  43,  50 }, {  62,  46 }, { 0, 0 } }, // state 30, mps 0
+  { {  30,  37,  43,  50 }, {  63,  47 }, { 0, 0 } }, // state 30, mps 1
+  { {  29,  35,  41,  48 }, {  64,  48 }, { 0, 0 } }, // state 31, mps 0
+  { {  29,  35,  41,  48 }, {  65,  49 }, { 0, 0 } }, // state 31, mps 1
+  { {  27,  33,  39,  45 }, {  66,  48 }, { 0, 0 } }, // state 32, mps 0
+  { {  27,  33,  39,  45 }, {  67,  49 }, { 0, 0 } }, // state 32, mps 1
+  { {  26,  31,  37,  43 }, {  68,  50 }, { 0, 0 } }, // state 33, mps 0
+  { {  26,  31,  37,  43 }, {  69,  51 }, { 0, 0 } }, // state 33, mps 1
+  { {  24,  30,  35,  41 }, {  70,  52 }, { 0, 0 } }, // state 34, mps 0
+  { {  24,  30,  35,  41 }, {  71,  53 }, { 0, 0 } }, // state 34, mps 1
+  { {  23,  28,  33,  39 }, {  72,  52 }, { 0, 0 } }, // state 35, mps 0
+  { {  23,  28,  33,  39 }, {  73,  53 }, { 0, 0 } }, // state 35, mps 1
+  { {  22,  27,  32,  37 }, {  74,  54 }, { 0, 0 } }, // state 36, mps 0
+  { {  22,  27,  32,  37 }, {  75,  55 }, { 0, 0 } }, // state 36, mps 1
+  { {  21,  26,  30,  35 }, {  76,  54 }, { 0, 0 } }, // state 37, mps 0
+  { {  21,  26,  30,  35 }, {  77,  55 }, { 0, 0 } }, // state 37, mps 1
+  { {  20,  24,  29,  33 }, {  78,  56 }, { 0, 0 } }, // state 38, mps 0
+  { {  20,  24,  29,  33 }, {  79,  57 }, { 0, 0 } }, // state 38, mps 1
+  { {  19,  23,  27,  31 }, {  80,  58 }, { 0, 0 } }, // state 39, mps 0
+  { {  19,  23,  27,  31 }, {  81,  59 }, { 0, 0 } }, // state 39, mps 1
+  { {  18,  22,  26,  30 }, {  82,  58 }, { 0, 0 } }, // state 40, mps 0
+  { {  18,  22,  26,  30 }, {  83,  59 }, { 0, 0 } }, // state 40, mps 1
+  { {  17,  21,  25,  28 }, {  84,  60 }, { 0, 0 } }, // state 41, mps 0
+  { {  17,  21,  25,  28 }, {  85,  61 }, { 0, 0 } }, // state 41, mps 1
+  { {  16,  20,  23,  27 }, {  86,  60 }, { 0, 0 } }, // state 42, mps 0
+  { {  16,  20,  23,  27 }, {  87,  61 }, { 0, 0 } }, // state 42, mps 1
+  { {  15,  19,  22,  25 }, {  88,  60 }, { 0, 0 } }, // state 43, mps 0
+  { {  15,  19,  22,  25 }, {  89,  61 }, { 0, 0 } }, // state 43, mps 1
+  { {  14,  18,  21,  24 }, {  90,  62 }, { 0, 0 } }, // state 44, mps 0
+  { {  14,  18,  21,  24 }, {  91,  63 }, { 0, 0 } }, // state 44, mps 1
+  { {  14,  17,  20,  23 }, {  92,  64 }, { 0, 0 } }, // state 45, mps 0
+  { {  14,  17,  20,  23 }, {  93,  65 }, { 0, 0 } }, // state 45, mps 1
+  { {  13,  16,  19,  22 }, {  94,  64 }, { 0, 0 } }, // state 46, mps 0
+  { {  13,  16,  19,  22 }, {  95,  65 }, { 0, 0 } }, // state 46, mps 1
+  { {  12,  15,  18,  21 }, {  96,  66 }, { 0, 0 } }, // state 47, mps 0
+  { {  12,  15,  18,  21 }, {  97,  67 }, { 0, 0 } }, // state 47, mps 1
+  { {  12,  14,  17,  20 }, {  98,  66 }, { 0, 0 } }, // state 48, mps 0
+  { {  12,  14,  17,  20 }, {  99,  67 }, { 0, 0 } }, // state 48, mps 1
+  { {  11,  14,  16,  19 }, { 100,  66 }, { 0, 0 } }, // state 49, mps 0
+  { {  11,  14,  16,  19 }, { 101,  67 }, { 0, 0 } }, // state 49, mps 1
+  { {  11,  13,  15,  18 }, { 102,  68 }, { 0, 0 } }, // state 50, mps 0
+  { {  11,  13,  15,  18 }, { 103,  69 }, { 0, 0 } }, // state 50, mps 1
+  { {  10,  12,  15,  17 }, { 104,  68 }, { 0, 0 } }, // state 51, mps 0
+  { {  10,  12,  15,  17 }, { 105,  69 }, { 0, 0 } }, // state 51, mps 1
+  { {  10,  12,  14,  16 }, { 106,  70 }, { 0, 0 } }, // state 52, mps 0
+  { {  10,  12,  14,  16 }, { 107,  71 }, { 0, 0 } }, // state 52, mps 1
+  { {   9,  11,  13,  15 }, { 108,  70 }, { 0, 0 } }, // state 53, mps 0
+  { {   9,  11,  13,  15 }, { 109,  71 }, { 0, 0 } }, // state 53, mps 1
+  { {   9,  11,  12,  14 }, { 110,  70 }, { 0, 0 } }, // state 54, mps 0
+  { {   9,  11,  12,  14 }, { 111,  71 }, { 0, 0 } }, // state 54, mps 1
+  { {   8,  10,  12,  14 }, { 112,  72 }, { 0, 0 } }, // state 55, mps 0
+  { {   8,  10,  12,  14 }, { 113,  73 }, { 0, 0 } }, // state 55, mps 1
+  { {   8,   9,  11,  13 }, { 114,  72 }, { 0, 0 } }, // state 56, mps 0
+  { {   8,   9,  11,  13 }, { 115,  73 }, { 0, 0 } }, // state 56, mps 1
+  { {   7,   9,  11,  12 }, { 116,  72 }, { 0, 0 } }, // state 57, mps 0
+  { {   7,   9,  11,  12 }, { 117,  73 }, { 0, 0 } }, // state 57, mps 1
+  { {   7,   9,  10,  12 }, { 118,  74 }, { 0, 0 } }, // state 58, mps 0
+  { {   7,   9,  10,  12 }, { 119,  75 }, { 0, 0 } }, // state 58, mps 1
+  { {   7,   8,  10,  11 }, { 120,  74 }, { 0, 0 } }, // state 59, mps 0
+  { {   7,   8,  10,  11 }, { 121,  75 }, { 0, 0 } }, // state 59, mps 1
+  { {   6,   8,   9,  11 }, { 122,  74 }, { 0, 0 } }, // state 60, mps 0
+  { {   6,   8,   9,  11 }, { 123,  75 }, { 0, 0 } }, // state 60, mps 1
+  { {   6,   7,   9,  10 }, { 124,  76 }, { 0, 0 } }, // state 61, mps 0
+  { {   6,   7,   9,  10 }, { 125,  77 }, { 0, 0 } }, // state 61, mps 1
+  { {   6,   7,   8,   9 }, { 124,  76 }, { 0, 0 } }, // state 62, mps 0
+  { {   6,   7,   8,   9 }, { 125,  77 }, { 0, 0 } }, // state 62, mps 1
+  { {   2,   2,   2,   2 }, { 126, 126 }, { 0, 0 } }, // state 63, mps 0
+  { {   2,   2,   2,   2 }, { 127, 127 }, { 0, 0 } }, // state 63, mps 1
+};
+
 #if RWTH_CABAC_FIXED_PROBABILITY
-const unsigned char CABAC_ArithmeticDecoder::sm_aucLPSTProbTable[49][4] =
+template <class TBitstream>
+const unsigned char TCABAC_ArithmeticDecoder<TBitstream>::sm_aucLPSTProbTable[49][4] =
 {
   { 139, 171, 202, 234 },
   { 136, 167, 198, 229 },
@@ -604,4 +890,10 @@ const unsigned char CABAC_ArithmeticDecoder::sm_aucLPSTProbTable[49][4] =
   { 6, 7, 8, 10 },
   { 4, 4, 4, 5 }
 };
-#endif
\ No newline at end of file
+#endif
+
+// Instantiate the engine for the bitstreams of this package
+template class TCABAC_ArithmeticDecoder<CABAC_Bitstream>;
+template class TCABAC_ArithmeticDecoder<CABAC_BitstreamFile>;
+template class TCABAC_ArithmeticDecoder<CABAC_BitstreamMemory>;
+template class TCABAC_ArithmeticDecoder<CABAC_BitstreamMmap>;
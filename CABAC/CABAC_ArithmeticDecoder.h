@@ -34,38 +34,62 @@
 #pragma once
 
 #include "CABAC_BitstreamFile.h"
+#include "CABAC_BitstreamMemory.h"
+#include "CABAC_BitstreamMmap.h"
 #include "ContextModel.h"
+#include "ContextModelDualRate.h"
 #include "CommonDef.h"
 #include "assert.h"
+#include <stdint.h>
 #if RWTH_TRACE_CABAC_TO_FILE
 #include <cstdio>
 #endif
-class CABAC_ArithmeticDecoder
+
+/** The arithmetic decoder engine class
+  *
+  * Reads the bytes from a bitstream of the template parameter type, see 
+  * TCABAC_ArithmeticEncoder and the typedefs below.
+  */
+template <class TBitstream>
+class TCABAC_ArithmeticDecoder
 {
 public:
-  CABAC_ArithmeticDecoder(CABAC_BitstreamFile* ptCabacBitstream=NULL);
-  ~CABAC_ArithmeticDecoder();
-  void setBitstream(CABAC_BitstreamFile* ptCabacBitstream);
-  CABAC_BitstreamFile* getBitstream() { assert(m_ptBitstream); return m_ptBitstream; };
+  TCABAC_ArithmeticDecoder(TBitstream* ptCabacBitstream=NULL);
+  ~TCABAC_ArithmeticDecoder();
+  void setBitstream(TBitstream* ptCabacBitstream);
+  TBitstream* getBitstream() { assert(m_ptBitstream); return m_ptBitstream; };
 
 
   void  start            ();
   void  finish           ();
 
   void  decodeBin         ( unsigned int& ruiBin, ContextModel *rcCtxModel );
+  void  decodeBinPacked   ( unsigned int& ruiBin, ContextModel *rcCtxModel );
+  void  decodeBin         ( unsigned int& ruiBin, ContextModelDualRate *rcCtxModel );
+  /// there is no packed table for the dual-rate model
+  void  decodeBinPacked   ( unsigned int& ruiBin, ContextModelDualRate *rcCtxModel ) { decodeBin( ruiBin, rcCtxModel ); }
   void  decodeBinEP       ( unsigned int& ruiBin                           );
   void  decodeBinsEP      ( unsigned int& ruiBin, int numBins              );
   void  decodeBinTrm      ( unsigned int& ruiBin                           );
 #if RWTH_CABAC_FIXED_PROBABILITY
   void  decodeBinProb     ( unsigned int& binValue, unsigned int uiProbability     );
 #endif
+#if TRACE_STATISTICS_BITRATE
+  /// the estimated bits of the decoded bins in 1/32768 bits (decodeBinPacked and the dual-rate model are not counted)
+  uint64_t getFracBits() const { return m_fracBits; }
+#endif
 
 protected:
-  CABAC_BitstreamFile *m_ptBitstream;
+  unsigned int xDecodeBinsEP( int numBins );
+
+  TBitstream *m_ptBitstream;
 
   unsigned int        m_uiRange;
   unsigned int        m_uiValue;
   int                 m_bitsNeeded;
+#if TRACE_STATISTICS_BITRATE
+  uint64_t            m_fracBits;
+#endif
 #if RWTH_TRACE_CABAC
   unsigned int        m_uiLow;
   int                 m_bitsLeft;
@@ -76,8 +100,24 @@ protected:
 
   const static unsigned char  sm_aucLPSTable[64][4];
   const static unsigned char  sm_aucRenormTable[32];
+  const static unsigned int   sm_auiRangeReciprocal[256];
+
+  /// One entry of the packed transition table used by decodeBinPacked, indexed by (state << 1) + MPS
+  struct PackedState
+  {
+    unsigned char aucLPS[4];        ///< LPS range for each quarter of the current range
+    unsigned char aucNextState[2];  ///< next (state << 1) + MPS after an MPS (0) or LPS (1)
+    unsigned char aucReserved[2];   ///< pads the entry to 8 bytes
+  };
+  const static PackedState    sm_asPackedStateTable[128];
 #if RWTH_CABAC_FIXED_PROBABILITY
   const static unsigned char  sm_aucLPSTProbTable[49][4];
 #endif
 };
 
+/// Decoder reading from any CABAC_Bitstream
+typedef TCABAC_ArithmeticDecoder<CABAC_Bitstream>       CABAC_ArithmeticDecoder;
+/// Decoders for a specific bitstream class
+typedef TCABAC_ArithmeticDecoder<CABAC_BitstreamFile>   CABAC_ArithmeticDecoderFile;
+typedef TCABAC_ArithmeticDecoder<CABAC_BitstreamMemory> CABAC_ArithmeticDecoderMemory;
+typedef TCABAC_ArithmeticDecoder<CABAC_BitstreamMmap>   CABAC_ArithmeticDecoderMmap;
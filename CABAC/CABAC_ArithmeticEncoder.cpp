@@ -32,9 +32,11 @@
  */
  
 #include "CABAC_ArithmeticEncoder.h"
+#include "CABAC_BitstreamSink.h"
 #include <assert.h>
 
-CABAC_ArithmeticEncoder::CABAC_ArithmeticEncoder(CABAC_BitstreamFile* ptCabacBitstream)
+template <class TBitstream>
+TCABAC_ArithmeticEncoder<TBitstream>::TCABAC_ArithmeticEncoder(TBitstream* ptCabacBitstream)
 {
   m_ptBitstream = ptCabacBitstream;
 #if RWTH_TRACE_CABAC_TO_FILE
@@ -42,16 +44,49 @@ CABAC_ArithmeticEncoder::CABAC_ArithmeticEncoder(CABAC_BitstreamFile* ptCabacBit
 #endif
 }
 
-CABAC_ArithmeticEncoder::~CABAC_ArithmeticEncoder()
+template <class TBitstream>
+TCABAC_ArithmeticEncoder<TBitstream>::~TCABAC_ArithmeticEncoder()
 {
 }
 
-void CABAC_ArithmeticEncoder::setBitstream( CABAC_BitstreamFile* ptCabacBitstream )
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder<TBitstream>::setBitstream( TBitstream* ptCabacBitstream )
 {
   m_ptBitstream = ptCabacBitstream;
 }
 
-void CABAC_ArithmeticEncoder::start()
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder<TBitstream>::checkpoint( State &rState ) const
+{
+  rState.uiLow            = m_uiLow;
+  rState.uiRange          = m_uiRange;
+  rState.bufferedByte     = m_bufferedByte;
+  rState.numBufferedBytes = m_numBufferedBytes;
+  rState.bitsLeft         = m_bitsLeft;
+  rState.uiBinsCoded      = m_uiBinsCoded;
+}
+
+/**
+ * \brief Restore the registers of a checkpoint
+ *
+ * The bytes written before the checkpoint are final, a later carry only changes the buffered
+ * byte and the outstanding 0xff bytes, which are part of the registers. So after the bitstream
+ * is truncated to the position of the checkpoint, coding continues as if nothing was coded 
+ * after the checkpoint.
+ */
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder<TBitstream>::restore( const State &rState )
+{
+  m_uiLow            = rState.uiLow;
+  m_uiRange          = rState.uiRange;
+  m_bufferedByte     = rState.bufferedByte;
+  m_numBufferedBytes = rState.numBufferedBytes;
+  m_bitsLeft         = rState.bitsLeft;
+  m_uiBinsCoded      = rState.uiBinsCoded;
+}
+
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder<TBitstream>::start()
 {
   m_uiLow            = 0;
   m_uiRange          = 510;
@@ -67,7 +102,8 @@ void CABAC_ArithmeticEncoder::start()
   DTRACE_CABAC_N;
 }
 
-void CABAC_ArithmeticEncoder::finish()
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder<TBitstream>::finish()
 {
   // Encode the terminating bit
   encodeBinTrm(1);
@@ -110,7 +146,8 @@ void CABAC_ArithmeticEncoder::finish()
  * \param binValue   bin value
  * \param rcCtxModel context model
  */
-void CABAC_ArithmeticEncoder::encodeBin( unsigned int binValue, ContextModel *rcCtxModel )
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder<TBitstream>::encodeBin( unsigned int binValue, ContextModel *rcCtxModel )
 {
 #if RWTH_TRACE_CABAC
   DTRACE_CABAC_T("EncodeBinSymbol=");
@@ -177,13 +214,49 @@ void CABAC_ArithmeticEncoder::encodeBin( unsigned int binValue, ContextModel *rc
   testAndWriteOut();
 }
 
+/**
+ * \brief Encode bin with the dual-rate model
+ *
+ * Same renormalization as for ContextModel, the LPS range is computed by the model.
+ * \param binValue   bin value
+ * \param rcCtxModel context model
+ */
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder<TBitstream>::encodeBin( unsigned int binValue, ContextModelDualRate *rcCtxModel )
+{
+  m_uiBinsCoded++;
+
+  unsigned int  uiLPS   = rcCtxModel->getLPS( m_uiRange );
+  m_uiRange    -= uiLPS;
+
+  if( binValue != rcCtxModel->getMps() )
+  {
+    // Coding a LPS, the LPS range is at least 4, so at most 6 bits are written
+    int numBits = sm_aucRenormTable[ uiLPS >> 3 ];
+    m_uiLow     = ( m_uiLow + m_uiRange ) << numBits;
+    m_uiRange   = uiLPS << numBits;
+    m_bitsLeft -= numBits;
+  }
+  else if ( m_uiRange < 256 )
+  {
+    // Coding a MPS with 1 bit renormalization, the MPS range is always above 128
+    m_uiLow <<= 1;
+    m_uiRange <<= 1;
+    m_bitsLeft--;
+  }
+  rcCtxModel->update( binValue );
+
+  testAndWriteOut();
+}
+
 #if RWTH_CABAC_FIXED_PROBABILITY
 /**
  * Encode a bit with a certain probability. This function requires no context update operations.
  * \param binValue bin Vale
  * \param uiProbability The probability of the bit to encode being one in percent. (1...99).
  */
-void CABAC_ArithmeticEncoder::encodeBinProb(unsigned int  binValue, unsigned int uiProbability)
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder<TBitstream>::encodeBinProb(unsigned int  binValue, unsigned int uiProbability)
 {
   if (uiProbability == 50)
   {
@@ -247,7 +320,8 @@ void CABAC_ArithmeticEncoder::encodeBinProb(unsigned int  binValue, unsigned int
  *
  * \param binValue bin value
  */
-void CABAC_ArithmeticEncoder::encodeBinEP( unsigned int binValue )
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder<TBitstream>::encodeBinEP( unsigned int binValue )
 {
   m_uiBinsCoded++;
   m_uiLow <<= 1;
@@ -275,7 +349,8 @@ void CABAC_ArithmeticEncoder::encodeBinEP( unsigned int binValue )
  * \param binValues bin values
  * \param numBins number of bins
  */
-void CABAC_ArithmeticEncoder::encodeBinsEP( unsigned int binValues, int numBins )
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder<TBitstream>::encodeBinsEP( unsigned int binValues, int numBins )
 {
   m_uiBinsCoded += numBins;
   
@@ -323,7 +398,8 @@ void CABAC_ArithmeticEncoder::encodeBinsEP( unsigned int binValues, int numBins
  *
  * \param binValue bin value
  */
-void CABAC_ArithmeticEncoder::encodeBinTrm( unsigned int binValue )
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder<TBitstream>::encodeBinTrm( unsigned int binValue )
 {
   DTRACE_CABAC_T("CABAC code Terminating Bin symbol=");
   DTRACE_CABAC_V( binValue );
@@ -366,7 +442,8 @@ void CABAC_ArithmeticEncoder::encodeBinTrm( unsigned int binValue )
   testAndWriteOut();
 }
 
-void CABAC_ArithmeticEncoder::testAndWriteOut()
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder<TBitstream>::testAndWriteOut()
 {
   if ( m_bitsLeft < 12 )
   {
@@ -377,7 +454,8 @@ void CABAC_ArithmeticEncoder::testAndWriteOut()
 /**
  * \brief Move bits from register into bitstream
  */
-void CABAC_ArithmeticEncoder::writeOut()
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder<TBitstream>::writeOut()
 {
   unsigned int leadByte = m_uiLow >> (24 - m_bitsLeft);
   m_bitsLeft += 8;
@@ -411,7 +489,8 @@ void CABAC_ArithmeticEncoder::writeOut()
   }    
 }
 
-const unsigned char CABAC_ArithmeticEncoder::sm_aucLPSTable[64][4] =
+template <class TBitstream>
+const unsigned char TCABAC_ArithmeticEncoder<TBitstream>::sm_aucLPSTable[64][4] =
 {
   { 128, 176, 208, 240},
   { 128, 167, 197, 227},
@@ -479,7 +558,8 @@ const unsigned char CABAC_ArithmeticEncoder::sm_aucLPSTable[64][4] =
   {   2,   2,   2,   2}
 };
 
-const unsigned char CABAC_ArithmeticEncoder::sm_aucRenormTable[32] =
+template <class TBitstream>
+const unsigned char TCABAC_ArithmeticEncoder<TBitstream>::sm_aucRenormTable[32] =
 {
   6,  5,  4,  4,
   3,  3,  3,  3,
@@ -492,7 +572,8 @@ const unsigned char CABAC_ArithmeticEncoder::sm_aucRenormTable[32] =
 };
 
 #if RWTH_CABAC_FIXED_PROBABILITY
-const unsigned char CABAC_ArithmeticEncoder::sm_aucLPSTProbTable[49][4] =
+template <class TBitstream>
+const unsigned char TCABAC_ArithmeticEncoder<TBitstream>::sm_aucLPSTProbTable[49][4] =
 {
   { 139, 171, 202, 234 },
   { 136, 167, 198, 229 },
@@ -544,4 +625,11 @@ const unsigned char CABAC_ArithmeticEncoder::sm_aucLPSTProbTable[49][4] =
   { 6, 7, 8, 10 },
   { 4, 4, 4, 5 }
 };
-#endif
\ No newline at end of file
+#endif
+
+// Instantiate the engine for the bitstreams of this package
+template class TCABAC_ArithmeticEncoder<CABAC_Bitstream>;
+template class TCABAC_ArithmeticEncoder<CABAC_BitstreamFile>;
+template class TCABAC_ArithmeticEncoder<CABAC_BitstreamMemory>;
+template class TCABAC_ArithmeticEncoder<CABAC_BitstreamNull>;
+template class TCABAC_ArithmeticEncoder<CABAC_BitstreamSink>;
@@ -34,32 +34,44 @@
 #pragma once
 
 #include "CABAC_BitstreamFile.h"
+#include "CABAC_BitstreamMemory.h"
+#include "CABAC_BitstreamNull.h"
 #include "ContextModel.h"
+#include "ContextModelDualRate.h"
 #include "CommonDef.h"
 #include "assert.h"
 #if RWTH_TRACE_CABAC_TO_FILE
 #include <cstdio>
 #endif
 
+// the streaming bitstream is only needed by the users of CABAC_ArithmeticEncoderSink
+class CABAC_BitstreamSink;
+
 /** The arithmetic coder engine class
   *
   * This class performes the arithmetic coding and writes the resulting bits into a bitstream.
+  * The bitstream type is a template parameter. With a concrete bitstream class (e.g. 
+  * CABAC_BitstreamMemory) the byte output is inlined into the coding functions, with 
+  * the CABAC_Bitstream interface any bitstream can be used at the cost of a virtual call.
+  * The engine is instantiated for the bitstreams of this package, see the typedefs below.
   */
-
-class CABAC_ArithmeticEncoder
+template <class TBitstream>
+class TCABAC_ArithmeticEncoder
 {
 public:
-  CABAC_ArithmeticEncoder( CABAC_BitstreamFile* ptCabacBitstream=NULL );
-  ~CABAC_ArithmeticEncoder();
-  void setBitstream(CABAC_BitstreamFile* ptCabacBitstream);
-  CABAC_BitstreamFile* getBitstream() { assert(m_ptBitstream); return m_ptBitstream; };
+  TCABAC_ArithmeticEncoder( TBitstream* ptCabacBitstream=NULL );
+  ~TCABAC_ArithmeticEncoder();
+  void setBitstream(TBitstream* ptCabacBitstream);
+  TBitstream* getBitstream() { assert(m_ptBitstream); return m_ptBitstream; };
 
   void  start            ();
   void  finish           ();
 
   void  encodeBin         ( unsigned int  binValue,  ContextModel *rcCtxModel );
+  void  encodeBin         ( unsigned int  binValue,  ContextModelDualRate *rcCtxModel );
   void  encodeBinEP       ( unsigned int  binValue                            );
   void  encodeBinsEP      ( unsigned int  binValues, int numBins              );
+  void  encodeBinTrm      ( unsigned int  binValue                            );
   
 #if RWTH_CABAC_FIXED_PROBABILITY
   // Encode a bit with a certain ficed probability. No context deeded/updated
@@ -68,10 +80,25 @@ public:
 
   unsigned int  getBinsCoded () { return m_uiBinsCoded; }
 
+  /// the engine registers, which together with the contexts and the written bytes define the coder state
+  struct State
+  {
+    unsigned int  uiLow;
+    unsigned int  uiRange;
+    unsigned int  bufferedByte;
+    int           numBufferedBytes;
+    int           bitsLeft;
+    unsigned int  uiBinsCoded;
+  };
+  /// save the registers, the bitstream position has to be saved separately (see CABAC_BitstreamMemory::getWritePosition)
+  void  checkpoint       ( State &rState ) const;
+  /// continue coding from a checkpoint, after the bitstream was set back to the position of the checkpoint
+  void  restore          ( const State &rState );
+
 protected:
-  void  encodeBinTrm     ( unsigned int  binValue                            );
+  template <class> friend class TCABAC_ArithmeticEncoder64;
 
-  CABAC_BitstreamFile *m_ptBitstream;
+  TBitstream *m_ptBitstream;
 
   unsigned int        m_uiLow;
   unsigned int        m_uiRange;
@@ -93,3 +120,10 @@ protected:
 #endif
 };
 
+/// Encoder writing to any CABAC_Bitstream
+typedef TCABAC_ArithmeticEncoder<CABAC_Bitstream>       CABAC_ArithmeticEncoder;
+/// Encoders for a specific bitstream class
+typedef TCABAC_ArithmeticEncoder<CABAC_BitstreamFile>   CABAC_ArithmeticEncoderFile;
+typedef TCABAC_ArithmeticEncoder<CABAC_BitstreamMemory> CABAC_ArithmeticEncoderMemory;
+typedef TCABAC_ArithmeticEncoder<CABAC_BitstreamNull>   CABAC_ArithmeticEncoderNull;
+typedef TCABAC_ArithmeticEncoder<CABAC_BitstreamSink>   CABAC_ArithmeticEncoderSink;
@@ -0,0 +1,419 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+ 
+#include "CABAC_ArithmeticEncoder64.h"
+#include "CABAC_BitstreamSink.h"
+#include <assert.h>
+
+template <class TBitstream>
+TCABAC_ArithmeticEncoder64<TBitstream>::TCABAC_ArithmeticEncoder64(TBitstream* ptCabacBitstream)
+{
+  m_ptBitstream = ptCabacBitstream;
+}
+
+template <class TBitstream>
+TCABAC_ArithmeticEncoder64<TBitstream>::~TCABAC_ArithmeticEncoder64()
+{
+}
+
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder64<TBitstream>::setBitstream( TBitstream* ptCabacBitstream )
+{
+  m_ptBitstream = ptCabacBitstream;
+}
+
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder64<TBitstream>::checkpoint( State &rState ) const
+{
+  rState.uiLow            = m_uiLow;
+  rState.uiRange          = m_uiRange;
+  rState.bufferedByte     = m_bufferedByte;
+  rState.numBufferedBytes = m_numBufferedBytes;
+  rState.bitsLeft         = m_bitsLeft;
+  rState.uiBinsCoded      = m_uiBinsCoded;
+}
+
+/**
+ * \brief Restore the registers of a checkpoint
+ *
+ * The bytes written before the checkpoint are final, a later carry only changes the buffered
+ * byte and the outstanding 0xff bytes, which are part of the registers. So after the bitstream
+ * is truncated to the position of the checkpoint, coding continues as if nothing was coded 
+ * after the checkpoint.
+ */
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder64<TBitstream>::restore( const State &rState )
+{
+  m_uiLow            = rState.uiLow;
+  m_uiRange          = rState.uiRange;
+  m_bufferedByte     = rState.bufferedByte;
+  m_numBufferedBytes = rState.numBufferedBytes;
+  m_bitsLeft         = rState.bitsLeft;
+  m_uiBinsCoded      = rState.uiBinsCoded;
+}
+
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder64<TBitstream>::start()
+{
+  m_uiLow            = 0;
+  m_uiRange          = 510;
+  m_bitsLeft         = 23 + 32;
+  m_numBufferedBytes = 0;
+  m_bufferedByte     = 0xff;
+  m_uiBinsCoded      = 0;
+}
+
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder64<TBitstream>::finish()
+{
+  // Encode the terminating bit
+  encodeBinTrm(1);
+
+  // Flush single bytes until the remaining bits fit the 32 bit register of TCABAC_ArithmeticEncoder
+  while ( m_bitsLeft < 12 + 32 )
+  {
+    unsigned int leadByte = (unsigned int)( m_uiLow >> ( 56 - m_bitsLeft ) );
+    m_bitsLeft += 8;
+    m_uiLow &= ~(uint64_t)0 >> m_bitsLeft;
+    writeOutByte( leadByte );
+  }
+
+  // From here on the same as TCABAC_ArithmeticEncoder::finish()
+  int bitsLeft = m_bitsLeft - 32;
+  unsigned int uiLow = (unsigned int)m_uiLow;
+  if ( uiLow >> ( 32 - bitsLeft ) )
+  {
+    m_ptBitstream->write( m_bufferedByte + 1, 8 );
+    while ( m_numBufferedBytes > 1 )
+    {
+      m_ptBitstream->write( 0x00, 8 );
+      m_numBufferedBytes--;
+    }
+    uiLow -= 1 << ( 32 - bitsLeft );
+  }
+  else
+  {
+    if ( m_numBufferedBytes > 0 )
+    {
+      m_ptBitstream->write( m_bufferedByte, 8 );
+    }
+    while ( m_numBufferedBytes > 1 )
+    {
+      m_ptBitstream->write( 0xff, 8 );
+      m_numBufferedBytes--;
+    }
+  }
+  m_ptBitstream->write( uiLow >> 8, 24 - bitsLeft );
+
+  // Terminate the bitstream
+  m_ptBitstream->write(1, 1);
+  m_ptBitstream->writeAlignZero();
+}
+
+/**
+ * \brief Encode bin
+ *
+ * \param binValue   bin value
+ * \param rcCtxModel context model
+ */
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder64<TBitstream>::encodeBin( unsigned int binValue, ContextModel *rcCtxModel )
+{
+  m_uiBinsCoded++;
+
+  unsigned int  uiLPS   = TEncoder32::sm_aucLPSTable[ rcCtxModel->getState() ][ ( m_uiRange >> 6 ) & 3 ];
+  m_uiRange    -= uiLPS;
+
+  if( binValue != rcCtxModel->getMps() )
+  {
+    // Coding a LPS
+    int numBits = TEncoder32::sm_aucRenormTable[ uiLPS >> 3 ];
+    m_uiLow     = ( m_uiLow + m_uiRange ) << numBits;
+    m_uiRange   = uiLPS << numBits;
+    rcCtxModel->updateLPS();
+
+    m_bitsLeft -= numBits;
+  }
+  else
+  {
+    // Coding a MPS
+    rcCtxModel->updateMPS();
+    if ( m_uiRange >= 256 )
+    {
+      // No renormalization required
+      return;
+    }
+
+    m_uiLow <<= 1;
+    m_uiRange <<= 1;
+    m_bitsLeft--;
+  }
+
+  testAndWriteOut();
+}
+
+/**
+ * \brief Encode bin with the dual-rate model
+ *
+ * Same renormalization as for ContextModel, the LPS range is computed by the model.
+ * \param binValue   bin value
+ * \param rcCtxModel context model
+ */
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder64<TBitstream>::encodeBin( unsigned int binValue, ContextModelDualRate *rcCtxModel )
+{
+  m_uiBinsCoded++;
+
+  unsigned int  uiLPS   = rcCtxModel->getLPS( m_uiRange );
+  m_uiRange    -= uiLPS;
+
+  if( binValue != rcCtxModel->getMps() )
+  {
+    // Coding a LPS, the LPS range is at least 4, so at most 6 bits are written
+    int numBits = TEncoder32::sm_aucRenormTable[ uiLPS >> 3 ];
+    m_uiLow     = ( m_uiLow + m_uiRange ) << numBits;
+    m_uiRange   = uiLPS << numBits;
+    m_bitsLeft -= numBits;
+  }
+  else if ( m_uiRange < 256 )
+  {
+    // Coding a MPS with 1 bit renormalization, the MPS range is always above 128
+    m_uiLow <<= 1;
+    m_uiRange <<= 1;
+    m_bitsLeft--;
+  }
+  rcCtxModel->update( binValue );
+
+  testAndWriteOut();
+}
+
+#if RWTH_CABAC_FIXED_PROBABILITY
+/**
+ * Encode a bit with a certain probability, see TCABAC_ArithmeticEncoder::encodeBinProb().
+ * \param binValue bin Vale
+ * \param uiProbability The probability of the bit to encode being one in percent. (1...99).
+ */
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder64<TBitstream>::encodeBinProb(unsigned int  binValue, unsigned int uiProbability)
+{
+  if (uiProbability == 50)
+  {
+    encodeBinEP(binValue);
+    return;
+  }
+  assert(uiProbability > 0 && uiProbability < 100);
+
+  m_uiBinsCoded++;
+  unsigned int uiMPS = (uiProbability > 50) ? 1 : 0;
+  unsigned int uiProbMPS = (uiProbability < 50) ? 50 - uiProbability : uiProbability - 50;
+
+  unsigned int  uiLPS = TEncoder32::sm_aucLPSTProbTable[uiProbMPS-1][(m_uiRange >> 6) & 3];
+  m_uiRange -= uiLPS;
+
+  if (binValue != uiMPS)
+  {
+    int numBits = TEncoder32::sm_aucRenormTable[uiLPS >> 3];
+    m_uiLow = (m_uiLow + m_uiRange) << numBits;
+    m_uiRange = uiLPS << numBits;
+
+    m_bitsLeft -= numBits;
+  }
+  else
+  {
+    if (m_uiRange >= 256)
+    {
+      return;
+    }
+    m_uiLow <<= 1;
+    m_uiRange <<= 1;
+    m_bitsLeft--;
+  }
+  testAndWriteOut();
+}
+#endif
+
+/**
+ * \brief Encode equiprobable bin
+ *
+ * \param binValue bin value
+ */
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder64<TBitstream>::encodeBinEP( unsigned int binValue )
+{
+  m_uiBinsCoded++;
+  m_uiLow <<= 1;
+  if( binValue )
+  {
+    m_uiLow += m_uiRange;
+  }
+  m_bitsLeft--;
+
+  testAndWriteOut();
+}
+
+/**
+ * \brief Encode up to 32 equiprobable bins
+ *
+ * Unlike TCABAC_ArithmeticEncoder::encodeBinsEP(), the bins are not split into groups of 8.
+ * If m_uiLow has room for all bins they are added at once, otherwise the leading bins fill
+ * up m_uiLow, 4 bytes are written out and the remaining bins are added.
+ *
+ * \param binValues bin values
+ * \param numBins number of bins (0...32)
+ */
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder64<TBitstream>::encodeBinsEP( unsigned int binValues, int numBins )
+{
+  assert( numBins >= 0 && numBins <= 32 );
+  m_uiBinsCoded += numBins;
+
+  if ( numBins >= m_bitsLeft )
+  {
+    int numLeadingBins = m_bitsLeft - 1;
+    numBins -= numLeadingBins;
+    unsigned int pattern = binValues >> numBins;
+    binValues -= pattern << numBins;
+    m_uiLow = ( m_uiLow << numLeadingBins ) + (uint64_t)m_uiRange * pattern;
+    m_bitsLeft = 1;
+    writeOut();
+  }
+
+  m_uiLow = ( m_uiLow << numBins ) + (uint64_t)m_uiRange * binValues;
+  m_bitsLeft -= numBins;
+
+  testAndWriteOut();
+}
+
+/**
+ * \brief Encode terminating bin
+ *
+ * \param binValue bin value
+ */
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder64<TBitstream>::encodeBinTrm( unsigned int binValue )
+{
+  m_uiBinsCoded += 1;
+  m_uiRange -= 2;
+  if( binValue )
+  {
+    // Terminating bit 1
+    m_uiLow  += m_uiRange;
+    m_uiLow <<= 7;
+    m_uiRange = 2 << 7;
+    m_bitsLeft -= 7;
+  }
+  else if ( m_uiRange >= 256 )
+  {
+    // Terminating bit 0, no normalization required
+    return;
+  }
+  else
+  {
+    // Terminating bit 0, normalization required
+    m_uiLow   <<= 1;
+    m_uiRange <<= 1;
+    m_bitsLeft--;
+  }
+  testAndWriteOut();
+}
+
+/**
+ * \brief Move 4 bytes from register into bitstream
+ */
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder64<TBitstream>::writeOut()
+{
+  // The carry bit and the 4 bytes above the remaining pending bits
+  uint64_t leadBytes = m_uiLow >> ( 32 - m_bitsLeft );
+  m_bitsLeft += 32;
+  m_uiLow &= ~(uint64_t)0 >> m_bitsLeft;
+
+  unsigned int carry = (unsigned int)( leadBytes >> 32 );
+  unsigned int bytes = (unsigned int)leadBytes;
+
+  // Without a carry, outstanding bytes or a new 0xff byte, the buffered byte and the first 
+  // three bytes are final and the last byte is buffered
+  unsigned int inverted = ~bytes;
+  if ( carry == 0 && m_numBufferedBytes == 1 && ( ( inverted - 0x01010101u ) & ~inverted & 0x80808080u ) == 0 )
+  {
+    m_ptBitstream->write( ( m_bufferedByte << 24 ) | ( bytes >> 8 ), 32 );
+    m_bufferedByte = bytes & 0xff;
+    return;
+  }
+
+  writeOutByte( ( carry << 8 ) | ( bytes >> 24 ) );
+  writeOutByte( ( bytes >> 16 ) & 0xff );
+  writeOutByte( ( bytes >> 8 ) & 0xff );
+  writeOutByte( bytes & 0xff );
+}
+
+/**
+ * \brief Resolve outstanding bytes for one new byte (with carry in bit 8), see TCABAC_ArithmeticEncoder::writeOut()
+ */
+template <class TBitstream>
+void TCABAC_ArithmeticEncoder64<TBitstream>::writeOutByte( unsigned int leadByte )
+{
+  if ( leadByte == 0xff )
+  {
+    m_numBufferedBytes++;
+  }
+  else
+  {
+    if ( m_numBufferedBytes > 0 )
+    {
+      unsigned int carry = leadByte >> 8;
+      unsigned int byte = m_bufferedByte + carry;
+      m_bufferedByte = leadByte & 0xff;
+      m_ptBitstream->write( byte, 8 );
+
+      byte = ( 0xff + carry ) & 0xff;
+      while ( m_numBufferedBytes > 1 )
+      {
+        m_ptBitstream->write( byte, 8 );
+        m_numBufferedBytes--;
+      }
+    }
+    else
+    {
+      m_numBufferedBytes = 1;
+      m_bufferedByte = leadByte;
+    }
+  }
+}
+
+// Instantiate the engine for the bitstreams of this package
+template class TCABAC_ArithmeticEncoder64<CABAC_Bitstream>;
+template class TCABAC_ArithmeticEncoder64<CABAC_BitstreamFile>;
+template class TCABAC_ArithmeticEncoder64<CABAC_BitstreamMemory>;
+template class TCABAC_ArithmeticEncoder64<CABAC_BitstreamNull>;
+template class TCABAC_ArithmeticEncoder64<CABAC_BitstreamSink>;
@@ -0,0 +1,110 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+ 
+#pragma once
+
+#include <stdint.h>
+#include "CABAC_ArithmeticEncoder.h"
+
+/** The arithmetic coder engine with a 64 bit low register
+  *
+  * Codes the same bins into the same bitstream as TCABAC_ArithmeticEncoder, but keeps up to
+  * 52 pending bits in m_uiLow. Instead of one byte every 8 bits, writeOut() flushes 4 bytes 
+  * at once. As long as the flushed bytes are no 0xff and carry free, they go to the bitstream
+  * with a single 32 bit write, otherwise the outstanding 0xff bytes and carries are resolved
+  * byte by byte exactly like in TCABAC_ArithmeticEncoder::writeOut().
+  */
+template <class TBitstream>
+class TCABAC_ArithmeticEncoder64
+{
+public:
+  TCABAC_ArithmeticEncoder64( TBitstream* ptCabacBitstream=NULL );
+  ~TCABAC_ArithmeticEncoder64();
+  void setBitstream(TBitstream* ptCabacBitstream);
+  TBitstream* getBitstream() { assert(m_ptBitstream); return m_ptBitstream; };
+
+  void  start            ();
+  void  finish           ();
+
+  void  encodeBin         ( unsigned int  binValue,  ContextModel *rcCtxModel );
+  void  encodeBin         ( unsigned int  binValue,  ContextModelDualRate *rcCtxModel );
+  void  encodeBinEP       ( unsigned int  binValue                            );
+  void  encodeBinsEP      ( unsigned int  binValues, int numBins              );
+  void  encodeBinTrm      ( unsigned int  binValue                            );
+
+#if RWTH_CABAC_FIXED_PROBABILITY
+  void  encodeBinProb     ( unsigned int  binValue, unsigned int uiProbability        );
+#endif
+
+  unsigned int  getBinsCoded () { return m_uiBinsCoded; }
+
+  /// the engine registers, which together with the contexts and the written bytes define the coder state
+  struct State
+  {
+    uint64_t      uiLow;
+    unsigned int  uiRange;
+    unsigned int  bufferedByte;
+    int           numBufferedBytes;
+    int           bitsLeft;
+    unsigned int  uiBinsCoded;
+  };
+  /// save the registers, the bitstream position has to be saved separately (see CABAC_BitstreamMemory::getWritePosition)
+  void  checkpoint       ( State &rState ) const;
+  /// continue coding from a checkpoint, after the bitstream was set back to the position of the checkpoint
+  void  restore          ( const State &rState );
+
+protected:
+  TBitstream *m_ptBitstream;
+
+  uint64_t            m_uiLow;
+  unsigned int        m_uiRange;
+  unsigned int        m_bufferedByte;
+  int                 m_numBufferedBytes;
+  int                 m_bitsLeft;
+  unsigned int        m_uiBinsCoded;
+
+  void testAndWriteOut() { if ( m_bitsLeft < 12 ) { writeOut(); } }
+  void writeOut();
+  void writeOutByte( unsigned int leadByte );
+
+  // The tables are shared with the 32 bit engine
+  typedef TCABAC_ArithmeticEncoder<TBitstream> TEncoder32;
+};
+
+/// Encoder writing to any CABAC_Bitstream
+typedef TCABAC_ArithmeticEncoder64<CABAC_Bitstream>       CABAC_ArithmeticEncoder64;
+/// Encoders for a specific bitstream class
+typedef TCABAC_ArithmeticEncoder64<CABAC_BitstreamFile>   CABAC_ArithmeticEncoder64File;
+typedef TCABAC_ArithmeticEncoder64<CABAC_BitstreamMemory> CABAC_ArithmeticEncoder64Memory;
+typedef TCABAC_ArithmeticEncoder64<CABAC_BitstreamNull>   CABAC_ArithmeticEncoder64Null;
+typedef TCABAC_ArithmeticEncoder64<CABAC_BitstreamSink>   CABAC_ArithmeticEncoder64Sink;
@@ -0,0 +1,258 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "CABAC_BinCapture.h"
+#include <string.h>
+
+static const char s_acCaptureMagic[4] = { 'C', 'B', 'I', 'N' };
+static const unsigned int s_uiCaptureVersion = 1;
+
+CABAC_BinCapture::CABAC_BinCapture()
+  : m_pFile(NULL)
+  , m_bWriteError(false)
+{
+}
+
+CABAC_BinCapture::~CABAC_BinCapture()
+{
+  close();
+}
+
+bool CABAC_BinCapture::open(const char *cFileName)
+{
+  close();
+  m_pFile = fopen(cFileName, "wb");
+  if (!m_pFile)
+  {
+    return false;
+  }
+  m_bWriteError = false;
+  m_buffer.assign(s_acCaptureMagic, s_acCaptureMagic + 4);
+  xWriteNumber(s_uiCaptureVersion);
+  return true;
+}
+
+bool CABAC_BinCapture::close()
+{
+  if (!m_pFile)
+  {
+    return true;
+  }
+  xFlush();
+  bool bOk = !m_bWriteError && fclose(m_pFile) == 0;
+  m_pFile = NULL;
+  m_buffer.clear();
+  return bOk;
+}
+
+void CABAC_BinCapture::xFlush()
+{
+  if (!m_buffer.empty() && fwrite(&m_buffer[0], 1, m_buffer.size(), m_pFile) != m_buffer.size())
+  {
+    m_bWriteError = true;
+  }
+  m_buffer.clear();
+}
+
+void CABAC_BinCapture::startStream(const std::vector<ContextModel> &models)
+{
+  xWriteNumber((EVENT_START << 2) | CABAC_CAPTURE_EVENT);
+  xWriteNumber(models.size());
+  for (size_t i = 0; i < models.size(); i++)
+  {
+    m_buffer.push_back(models[i].getStateIdx());
+  }
+}
+
+void CABAC_BinCapture::startStream(const std::vector<ContextModelDualRate> &models)
+{
+  xWriteNumber((EVENT_START_DUAL_RATE << 2) | CABAC_CAPTURE_EVENT);
+  xWriteNumber(models.size());
+  for (size_t i = 0; i < models.size(); i++)
+  {
+    xWriteNumber(models[i].getState(0));
+    xWriteNumber(models[i].getState(1));
+  }
+}
+
+void CABAC_BinCapture::finishStream(const unsigned char *pData, size_t uiNumBytes)
+{
+  xWriteNumber((EVENT_FINISH << 2) | CABAC_CAPTURE_EVENT);
+  xWriteNumber(pData ? 1 : 0);
+  if (pData)
+  {
+    xWriteNumber(uiNumBytes);
+    xWriteNumber(hash(pData, uiNumBytes));
+  }
+  xFlush();
+}
+
+uint32_t CABAC_BinCapture::hash(const unsigned char *pData, size_t uiNumBytes)
+{
+  uint32_t uiHash = 2166136261u;
+  for (size_t i = 0; i < uiNumBytes; i++)
+  {
+    uiHash = (uiHash ^ pData[i]) * 16777619u;
+  }
+  return uiHash;
+}
+
+// read a number written by xWriteNumber, returns false at the end of the data
+static bool xReadNumber(const unsigned char *&pData, const unsigned char *pEnd, uint64_t &ruiValue)
+{
+  ruiValue = 0;
+  for (int iShift = 0; pData < pEnd && iShift < 64; iShift += 7)
+  {
+    unsigned char ucByte = *pData++;
+    ruiValue |= (uint64_t)(ucByte & 0x7f) << iShift;
+    if (!(ucByte & 0x80))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool CABAC_BinCapture::read(const char *cFileName, std::vector<CABAC_CapturedStream> &streams)
+{
+  streams.clear();
+  FILE *pFile = fopen(cFileName, "rb");
+  if (!pFile)
+  {
+    return false;
+  }
+  std::vector<unsigned char> data;
+  unsigned char aucChunk[65536];
+  size_t uiRead;
+  while ((uiRead = fread(aucChunk, 1, sizeof(aucChunk), pFile)) > 0)
+  {
+    data.insert(data.end(), aucChunk, aucChunk + uiRead);
+  }
+  fclose(pFile);
+
+  uint64_t uiValue;
+  const unsigned char *pData = data.empty() ? NULL : &data[0];
+  const unsigned char *pEnd = pData + data.size();
+  if (data.size() < 4 || memcmp(pData, s_acCaptureMagic, 4))
+  {
+    return false;
+  }
+  pData += 4;
+  if (!xReadNumber(pData, pEnd, uiValue) || uiValue != s_uiCaptureVersion)
+  {
+    return false;
+  }
+
+  CABAC_CapturedStream *pStream = NULL;  // the stream which is not finished yet
+  while (pData < pEnd)
+  {
+    if (!xReadNumber(pData, pEnd, uiValue))
+    {
+      return false;
+    }
+    const unsigned int uiKind = (unsigned int)(uiValue & 3);
+    if (uiKind != CABAC_CAPTURE_EVENT)
+    {
+      if (!pStream)
+      {
+        return false;
+      }
+      CABAC_CapturedBin bin = { (uint8_t)uiKind, (uint8_t)((uiValue >> 2) & 1), (uint32_t)(uiValue >> 3) };
+      if ((bin.uiCtxIdx != 0 && uiKind != CABAC_CAPTURE_CTX) 
+          || (uiKind == CABAC_CAPTURE_CTX && bin.uiCtxIdx >= (pStream->bDualRate ? pStream->dualRateModels.size() : pStream->models.size())))
+      {
+        return false;
+      }
+      pStream->bins.push_back(bin);
+    }
+    else if ((uiValue >> 2) == EVENT_START || (uiValue >> 2) == EVENT_START_DUAL_RATE)
+    {
+      uint64_t uiNumContexts;
+      if (pStream || !xReadNumber(pData, pEnd, uiNumContexts) || uiNumContexts > (uint64_t)(pEnd - pData))
+      {
+        return false;
+      }
+      streams.push_back(CABAC_CapturedStream());
+      pStream = &streams.back();
+      pStream->bDualRate = (uiValue >> 2) == EVENT_START_DUAL_RATE;
+      pStream->bFinished = false;
+      pStream->bHasOutput = false;
+      pStream->uiNumBytes = 0;
+      pStream->uiHash = 0;
+      if (pStream->bDualRate)
+      {
+        pStream->dualRateModels.resize((size_t)uiNumContexts);
+        for (size_t i = 0; i < pStream->dualRateModels.size(); i++)
+        {
+          uint64_t uiFast, uiSlow;
+          if (!xReadNumber(pData, pEnd, uiFast) || !xReadNumber(pData, pEnd, uiSlow) || uiFast > 0x7fff || uiSlow > 0x7fff)
+          {
+            return false;
+          }
+          pStream->dualRateModels[i].setState((uint16_t)uiFast, (uint16_t)uiSlow);
+        }
+      }
+      else
+      {
+        pStream->models.resize((size_t)uiNumContexts);
+        for (size_t i = 0; i < pStream->models.size(); i++)
+        {
+          if (*pData >= 128)
+          {
+            return false;
+          }
+          pStream->models[i].updateStateIdx(*pData++);
+        }
+      }
+    }
+    else if ((uiValue >> 2) == EVENT_FINISH)
+    {
+      uint64_t uiHasOutput, uiNumBytes = 0, uiHash = 0;
+      if (!pStream || !xReadNumber(pData, pEnd, uiHasOutput) 
+          || (uiHasOutput && (!xReadNumber(pData, pEnd, uiNumBytes) || !xReadNumber(pData, pEnd, uiHash))))
+      {
+        return false;
+      }
+      pStream->bFinished = true;
+      pStream->bHasOutput = uiHasOutput != 0;
+      pStream->uiNumBytes = uiNumBytes;
+      pStream->uiHash = (uint32_t)uiHash;
+      pStream = NULL;
+    }
+    else
+    {
+      return false;
+    }
+  }
+  return true;
+}
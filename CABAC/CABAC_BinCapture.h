@@ -0,0 +1,232 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <assert.h>
+#include <vector>
+#include "CABAC_BitstreamMemory.h"
+#include "ContextModel.h"
+#include "ContextModelDualRate.h"
+
+/// the kind of a captured bin
+enum CABAC_CaptureKind
+{
+  CABAC_CAPTURE_CTX,    ///< context coded bin (encodeBin)
+  CABAC_CAPTURE_EP,     ///< bypass bin (encodeBinEP / encodeBinsEP)
+  CABAC_CAPTURE_TRM,    ///< terminating bin (encodeBinTrm)
+  CABAC_CAPTURE_EVENT   ///< start or finish of a stream, only used in the file
+};
+
+/// a captured bin, uiCtxIdx is 0 for bypass and terminating bins
+struct CABAC_CapturedBin
+{
+  uint8_t  ucKind;
+  uint8_t  ucBin;
+  uint32_t uiCtxIdx;
+};
+
+/// the bins of one encoding from start to finish, with the contexts at the start
+struct CABAC_CapturedStream
+{
+  bool bDualRate;                                      ///< coded with ContextModelDualRate
+  std::vector<ContextModel>         models;            ///< the contexts at the start (HEVC model)
+  std::vector<ContextModelDualRate> dualRateModels;    ///< the contexts at the start (dual-rate model)
+  std::vector<CABAC_CapturedBin>    bins;
+  bool     bFinished;   ///< false if the capture ended before the encoder was finished
+  bool     bHasOutput;  ///< the size and the hash of the coded bytes are known
+  uint64_t uiNumBytes;
+  uint32_t uiHash;      ///< CABAC_BinCapture::hash() of the coded bytes
+};
+
+/** Capture of the bins coded by an encoder into a compact binary file
+  *
+  * Records the exact sequence of (kind, bin, context index) of one or more encodings, together
+  * with the contexts at the start of every encoding and the size and hash of its coded bytes,
+  * so that real bin streams (e.g. of the matrices of ISS) can be replayed through other engine 
+  * variants with SimpleCABACReplay and checked for bit-exactness.
+  *
+  * The file starts with "CBIN" and a version, followed by variable length numbers (7 bits per 
+  * byte, LSB first). A bin is the number (ctxIdx << 3) | (bin << 2) | kind, i.e. one byte 
+  * for the first 16 contexts and two bytes for up to 2048 contexts. An event is 
+  * (event << 2) | CABAC_CAPTURE_EVENT: the start of an encoding followed by the number of 
+  * contexts and their states (one byte (state << 1) + MPS per context, or both 15 bit 
+  * estimates of the dual-rate model), the finish followed by a flag and the size and hash of 
+  * the coded bytes if the flag is set.
+  *
+  * TCABAC_CapturingEncoder captures the bins of a native encoder, the MEX interface captures
+  * the encoder of a session after 'setCapture'.
+  */
+class CABAC_BinCapture
+{
+public:
+  CABAC_BinCapture();
+  ~CABAC_BinCapture();
+
+  /// create the file (overwriting it), returns false if it can not be opened
+  bool open(const char *cFileName);
+  /// write the remaining bins and close the file, returns false if writing failed
+  bool close();
+  bool isOpen() const { return m_pFile != NULL; }
+
+  /// start an encoding, which codes its bins with the given contexts
+  void startStream(const std::vector<ContextModel> &models);
+  void startStream(const std::vector<ContextModelDualRate> &models);
+  /// finish the encoding, pData holds its coded bytes (NULL if they are not known)
+  void finishStream(const unsigned char *pData, size_t uiNumBytes);
+
+  inline void addBin(CABAC_CaptureKind eKind, unsigned int uiBin, unsigned int uiCtxIdx = 0)
+  {
+    xWriteNumber(((uint64_t)uiCtxIdx << 3) | (uiBin << 2) | eKind);
+    if (m_buffer.size() >= s_uiFlushSize)
+    {
+      xFlush();
+    }
+  }
+  /// add numBins context coded bins, bins[i] coded into context ctxIdx[i]
+  template <typename TBin, typename TCtx>
+  void addBins(const TBin *bins, const TCtx *ctxIdx, size_t numBins)
+  {
+    for (size_t i = 0; i < numBins; i++)
+    {
+      addBin(CABAC_CAPTURE_CTX, (unsigned int)bins[i], (unsigned int)ctxIdx[i]);
+    }
+  }
+
+  /// FNV-1a hash of the coded bytes, stored at the finish of an encoding
+  static uint32_t hash(const unsigned char *pData, size_t uiNumBytes);
+  /// read all encodings of a capture file, returns false if the file can not be read or is corrupt
+  static bool read(const char *cFileName, std::vector<CABAC_CapturedStream> &streams);
+
+protected:
+  enum Event
+  {
+    EVENT_START,            ///< followed by the number of contexts and one byte per context
+    EVENT_START_DUAL_RATE,  ///< followed by the number of contexts and two estimates per context
+    EVENT_FINISH            ///< followed by the output flag, the number of bytes and the hash
+  };
+  static const size_t s_uiFlushSize = 65536;
+
+  inline void xWriteNumber(uint64_t uiValue)
+  {
+    while (uiValue >= 0x80)
+    {
+      m_buffer.push_back((unsigned char)(uiValue | 0x80));
+      uiValue >>= 7;
+    }
+    m_buffer.push_back((unsigned char)uiValue);
+  }
+  void xFlush();
+
+  FILE *m_pFile;
+  bool  m_bWriteError;
+  std::vector<unsigned char> m_buffer;  ///< the data not yet written to the file
+};
+
+/** An encoder which captures all coded bins into a CABAC_BinCapture
+  *
+  * TEncoder is one of the arithmetic encoders, e.g. CABAC_ArithmeticEncoder64File. The 
+  * contexts given to start() have to be the vector which the context models passed to 
+  * encodeBin() belong to, the context index of a bin is the position of its model in it.
+  * The coded bytes are not known to the encoder, finish() records the encoding without them,
+  * finish(rOutput) with the bytes of the memory bitstream the encoder writes to.
+  */
+template <class TEncoder>
+class TCABAC_CapturingEncoder : public TEncoder
+{
+public:
+  TCABAC_CapturingEncoder(CABAC_BinCapture *pCapture) : m_pCapture(pCapture), m_pModels(NULL), m_pDualRateModels(NULL) {}
+  ~TCABAC_CapturingEncoder() {}
+
+  void start(const std::vector<ContextModel> &models)
+  {
+    m_pCapture->startStream(models);
+    m_pModels = models.empty() ? NULL : &models[0];
+    TEncoder::start();
+  }
+  void start(const std::vector<ContextModelDualRate> &models)
+  {
+    m_pCapture->startStream(models);
+    m_pDualRateModels = models.empty() ? NULL : &models[0];
+    TEncoder::start();
+  }
+  void finish()
+  {
+    TEncoder::finish();
+    m_pCapture->finishStream(NULL, 0);
+  }
+  /// finish and record the size and hash of the coded bytes, rOutput is the bitstream of the encoder
+  void finish(const CABAC_BitstreamMemory &rOutput)
+  {
+    TEncoder::finish();
+    m_pCapture->finishStream(rOutput.getData(), rOutput.getNumBytes());
+  }
+
+  void encodeBin(unsigned int binValue, ContextModel *rcCtxModel)
+  {
+    assert(m_pModels);
+    m_pCapture->addBin(CABAC_CAPTURE_CTX, binValue, (unsigned int)(rcCtxModel - m_pModels));
+    TEncoder::encodeBin(binValue, rcCtxModel);
+  }
+  void encodeBin(unsigned int binValue, ContextModelDualRate *rcCtxModel)
+  {
+    assert(m_pDualRateModels);
+    m_pCapture->addBin(CABAC_CAPTURE_CTX, binValue, (unsigned int)(rcCtxModel - m_pDualRateModels));
+    TEncoder::encodeBin(binValue, rcCtxModel);
+  }
+  void encodeBinEP(unsigned int binValue)
+  {
+    m_pCapture->addBin(CABAC_CAPTURE_EP, binValue);
+    TEncoder::encodeBinEP(binValue);
+  }
+  void encodeBinsEP(unsigned int binValues, int numBins)
+  {
+    for (int i = numBins - 1; i >= 0; i--)
+    {
+      m_pCapture->addBin(CABAC_CAPTURE_EP, (binValues >> i) & 1);
+    }
+    TEncoder::encodeBinsEP(binValues, numBins);
+  }
+  void encodeBinTrm(unsigned int binValue)
+  {
+    m_pCapture->addBin(CABAC_CAPTURE_TRM, binValue);
+    TEncoder::encodeBinTrm(binValue);
+  }
+
+protected:
+  CABAC_BinCapture *m_pCapture;
+  const ContextModel *m_pModels;
+  const ContextModelDualRate *m_pDualRateModels;
+};
@@ -0,0 +1,194 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "CABAC_Binarizer.h"
+#include <string.h>
+#include <assert.h>
+#include <algorithm>
+#include "CommonDef.h"
+
+CABAC_Binarizer::CABAC_Binarizer()
+  : m_eMethod(CABAC_BIN_NONE)
+  , m_uiNq(2)
+  , m_iRiceParam(0)
+  , m_uiMaxOnes(1)
+{
+}
+
+CABAC_Binarizer::~CABAC_Binarizer()
+{
+}
+
+bool CABAC_Binarizer::init(const char *cMethod, unsigned int uiNq)
+{
+  m_uiNq = uiNq;
+  m_iRiceParam = 0;
+  m_table.clear();
+  if (uiNq <= 2)
+  {
+    m_eMethod = CABAC_BIN_NONE;
+    m_uiNq = 2;
+  }
+  else if (!strcmp(cMethod, "DEC2TU"))
+  {
+    m_eMethod = CABAC_BIN_TU;
+  }
+  else if (!strcmp(cMethod, "DEC2FL32"))
+  {
+    m_eMethod = CABAC_BIN_FL;
+  }
+  else if ((!strncmp(cMethod, "DEC2TR", 6) || !strncmp(cMethod, "DEC2EG", 6)) 
+           && cMethod[6] >= '0' && cMethod[6] <= '2' && cMethod[7] == 0)
+  {
+    m_eMethod = (cMethod[4] == 'T') ? CABAC_BIN_TR : CABAC_BIN_EG;
+    m_iRiceParam = cMethod[6] - '0';
+  }
+  else
+  {
+    return false;
+  }
+
+  CABAC_Codeword maxCodeword = xGetCodeword(m_uiNq - 1);
+  m_uiMaxOnes = (m_eMethod == CABAC_BIN_TR || m_eMethod == CABAC_BIN_EG) ? maxCodeword.uiNumOnes + 1 
+              : (m_eMethod == CABAC_BIN_FL) ? 32 : std::max<unsigned int>(maxCodeword.uiNumOnes, 1);
+  if (m_uiNq <= RWTH_CABAC_BINARIZER_TABLE_SIZE)
+  {
+    m_table.resize(m_uiNq);
+    for (unsigned int v = 0; v < m_uiNq; v++)
+    {
+      m_table[v] = xGetCodeword(v);
+    }
+  }
+  return true;
+}
+
+CABAC_Codeword CABAC_Binarizer::xGetCodeword(unsigned int uiValue) const
+{
+  assert(isValid(uiValue));
+  const unsigned int uiMaxVal = m_uiNq - 1;
+  const int k = m_iRiceParam;
+  CABAC_Codeword cw = { 0, 0, 0, 1 };
+  switch (m_eMethod)
+  {
+  case CABAC_BIN_NONE:
+    cw.uiNumOnes = uiValue;
+    cw.ucZero = 1 - uiValue;
+    break;
+  case CABAC_BIN_TU:
+    // uiValue ones and a terminating zero, which is left out for the maximum value
+    cw.uiNumOnes = uiValue;
+    cw.ucZero = (uiValue != uiMaxVal);
+    break;
+  case CABAC_BIN_TR:
+    // unary prefix of uiValue >> k and k suffix bins, all ones for the maximum value
+    cw.uiNumOnes = uiValue >> k;
+    cw.ucNumSuffix = k;
+    cw.uiSuffix = (uiValue < uiMaxVal) ? uiValue & ((1u << k) - 1) : (1u << k) - 1;
+    break;
+  case CABAC_BIN_EG:
+    {
+      // x = uiValue + 2^k has numOnes + k + 1 bits, its lower numOnes + k bits are the suffix
+      uint64_t x = (uint64_t)uiValue + (1u << k);
+      int log2x = (x >> 32) ? 32 : 31 - (int)countLeadingZeros32((unsigned int)x);
+      cw.uiNumOnes = log2x - k;
+      cw.ucNumSuffix = log2x;
+      cw.uiSuffix = (unsigned int)(x - ((uint64_t)1 << log2x));
+    }
+    break;
+  case CABAC_BIN_FL:
+    // the leading ones of the 32 bits, the zero after them and the remaining bits
+    cw.uiNumOnes = (~uiValue) ? countLeadingZeros32(~uiValue) : 32;
+    cw.ucZero = (cw.uiNumOnes < 32);
+    cw.ucNumSuffix = cw.ucZero ? 31 - cw.uiNumOnes : 0;
+    cw.uiSuffix = cw.ucNumSuffix ? uiValue & ((1u << cw.ucNumSuffix) - 1) : 0;
+    break;
+  }
+  return cw;
+}
+
+void CABAC_Binarizer::binarize(const unsigned int *puiValues, size_t numValues, CABAC_Codeword *pCodewords) const
+{
+  if (!m_table.empty())
+  {
+    const CABAC_Codeword *table = &m_table[0];
+    for (size_t i = 0; i < numValues; i++)
+    {
+      pCodewords[i] = table[puiValues[i]];
+    }
+  }
+  else
+  {
+    for (size_t i = 0; i < numValues; i++)
+    {
+      pCodewords[i] = xGetCodeword(puiValues[i]);
+    }
+  }
+}
+
+void CABAC_Binarizer::binarize(unsigned int uiValue, std::vector<uint8_t> &rBins) const
+{
+  CABAC_Codeword cw = getCodeword(uiValue);
+  rBins.resize(cw.getNumBins());
+  for (int n = 0; n < (int)rBins.size(); n++)
+  {
+    rBins[n] = (uint8_t)cw.getBin(n);
+  }
+}
+
+unsigned int CABAC_Binarizer::getValue(const CABAC_Codeword &rCodeword) const
+{
+  const unsigned int uiMaxVal = m_uiNq - 1;
+  const int k = m_iRiceParam;
+  // the prefix may end without a zero in a corrupt bitstream, see isComplete()
+  const int iPrefixLength = rCodeword.ucZero ? rCodeword.uiNumOnes + 1 : m_uiMaxOnes;
+  uint64_t value = 0;
+  switch (m_eMethod)
+  {
+  case CABAC_BIN_NONE:
+    value = rCodeword.uiNumOnes;
+    break;
+  case CABAC_BIN_TU:
+    value = rCodeword.ucZero ? rCodeword.uiNumOnes : uiMaxVal;
+    break;
+  case CABAC_BIN_TR:
+    value = ((uint64_t)(iPrefixLength - 1) << k) + rCodeword.uiSuffix;
+    break;
+  case CABAC_BIN_EG:
+    value = ((((uint64_t)1 << (iPrefixLength - 1)) - 1) << k) + rCodeword.uiSuffix;
+    break;
+  case CABAC_BIN_FL:
+    value = rCodeword.ucZero ? ((((uint64_t)1 << rCodeword.uiNumOnes) - 1) << (32 - rCodeword.uiNumOnes)) | rCodeword.uiSuffix : 0xffffffffu;
+    break;
+  }
+  return (unsigned int)std::min<uint64_t>(value, uiMaxVal);
+}
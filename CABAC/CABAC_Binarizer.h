@@ -0,0 +1,137 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+/// binarization methods of cabacBinarizer.m
+enum CABAC_BinMethod
+{
+  CABAC_BIN_NONE,   ///< Nq <= 2, the value is the bin
+  CABAC_BIN_TU,     ///< DEC2TU, truncated unary
+  CABAC_BIN_TR,     ///< DEC2TR0...2, truncated rice
+  CABAC_BIN_EG,     ///< DEC2EG0...2, exp-golomb
+  CABAC_BIN_FL      ///< DEC2FL32, fixed length with 32 bits
+};
+
+/** A packed bin string
+  *
+  * Every bin string starts with a run of ones, which is either terminated by a zero bin 
+  * (the prefix of cabacContextSelection.m) or ends the bin string. The bins after the zero 
+  * are the suffix.
+  */
+struct CABAC_Codeword
+{
+  uint32_t uiNumOnes;    ///< leading one bins
+  uint32_t uiSuffix;     ///< bins after the first zero, MSB first
+  uint8_t  ucNumSuffix;  ///< number of bins in uiSuffix (up to 32)
+  uint8_t  ucZero;       ///< 1 if the ones are terminated by a zero bin
+
+  int getNumBins() const { return (int)(uiNumOnes + ucZero + ucNumSuffix); }
+  /// position of the first zero (1-based), 0 if there is none
+  int getPrefixLength() const { return ucZero ? (int)uiNumOnes + 1 : 0; }
+  /// bin n (0-based), n < getNumBins()
+  unsigned int getBin(int n) const 
+  { 
+    return (n < (int)uiNumOnes) ? 1 : (n == (int)uiNumOnes) ? 0 : (uiSuffix >> (ucNumSuffix - (n - uiNumOnes))) & 1;
+  }
+};
+
+/** Binarization of quantization indices
+  *
+  * Produces the same bin strings as cabacBinarizer.m for the values 0...Nq-1. As in 
+  * cabacEncode.m, the values are not binarized at all for Nq <= 2. The bin strings are 
+  * computed as CABAC_Codeword with clz for EG and FL, for up to RWTH_CABAC_BINARIZER_TABLE_SIZE 
+  * values they are taken from a table built by init().
+  *
+  * For decoding, isComplete() detects the end of a bin string for every method, and
+  * getValue() inverts getCodeword(). Unlike cabacDebinarizer.m, it maps the TR code of the
+  * maximum value (all ones suffix) back to Nq-1. The leading ones are limited to the prefix 
+  * of Nq-1, so that a corrupt bitstream can not produce endless bin strings.
+  */
+class CABAC_Binarizer
+{
+public:
+  CABAC_Binarizer();
+  ~CABAC_Binarizer();
+
+  /// set the method by its name in cabacBinarizer.m, returns false for an unknown method
+  bool init(const char *cMethod, unsigned int uiNq);
+
+  CABAC_BinMethod getMethod() const { return m_eMethod; }
+  unsigned int getNq() const { return m_uiNq; }
+  /// true if uiValue can be binarized, i.e. 0 <= uiValue < Nq
+  bool isValid(unsigned int uiValue) const { return uiValue < m_uiNq; }
+  /// the number of leading ones after which the prefix ends even without a zero bin
+  unsigned int getMaxOnes() const { return m_uiMaxOnes; }
+
+  /// the bin string of uiValue
+  CABAC_Codeword getCodeword(unsigned int uiValue) const { return m_table.empty() ? xGetCodeword(uiValue) : m_table[uiValue]; }
+  /// the bin strings of numValues values at once
+  void binarize(const unsigned int *puiValues, size_t numValues, CABAC_Codeword *pCodewords) const;
+  /// write the bin string of uiValue to rBins
+  void binarize(unsigned int uiValue, std::vector<uint8_t> &rBins) const;
+
+  /// true if the decoded bins form a complete bin string
+  inline bool isComplete(const CABAC_Codeword &rCodeword) const
+  {
+    int iPrefixLength = rCodeword.getPrefixLength();
+    if (iPrefixLength == 0 && rCodeword.uiNumOnes >= m_uiMaxOnes)
+    {
+      iPrefixLength = (int)m_uiMaxOnes;
+    }
+    switch (m_eMethod)
+    {
+    case CABAC_BIN_NONE: return rCodeword.getNumBins() == 1;
+    case CABAC_BIN_TU:   return iPrefixLength > 0;
+    case CABAC_BIN_TR:   return iPrefixLength > 0 && rCodeword.ucNumSuffix == m_iRiceParam;
+    case CABAC_BIN_EG:   return iPrefixLength > 0 && rCodeword.ucNumSuffix == iPrefixLength - 1 + m_iRiceParam;
+    default:             return rCodeword.getNumBins() == 32;
+    }
+  }
+
+  /// the value of a complete bin string, clipped to Nq-1
+  unsigned int getValue(const CABAC_Codeword &rCodeword) const;
+
+protected:
+  CABAC_Codeword xGetCodeword(unsigned int uiValue) const;
+
+  CABAC_BinMethod m_eMethod;
+  unsigned int    m_uiNq;
+  int             m_iRiceParam;  ///< k of TR and EG
+  unsigned int    m_uiMaxOnes;   ///< prefix length of Nq-1 (bin string length for TU and FL)
+  std::vector<CABAC_Codeword> m_table;  ///< the bin strings of 0...Nq-1 for small Nq
+};
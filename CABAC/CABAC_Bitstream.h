@@ -0,0 +1,60 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+/** The CABAC bitstream interface
+  *
+  * The arithmetic encoder writes its bits to and the arithmetic decoder reads its bytes from
+  * an implementation of this interface:
+  *  - CABAC_BitstreamFile   reads from / writes to a file
+  *  - CABAC_BitstreamMemory reads from a memory span / writes to a growable memory buffer
+  *  - CABAC_BitstreamSink   hands the written bytes to a CABAC_ByteSink while encoding
+  */
+class CABAC_Bitstream
+{
+public:
+  virtual ~CABAC_Bitstream() {}
+
+  // append uiNumberOfBits least significant bits of uiBits to the current bitstream
+  virtual void  write           ( unsigned int uiBits, unsigned int uiNumberOfBits ) = 0;
+  virtual void  writeAlignZero  () = 0;  ///< insert zero bits until the bitstream is byte-aligned
+
+  // read from the stream
+  virtual unsigned int readByte() = 0;
+  virtual unsigned int getNumBitsUntilByteAligned() = 0;
+
+  // Return the number of bits that have been written since the last resetWrittenBits()
+  virtual unsigned int getNumberOfWrittenBits() const = 0;
+  virtual unsigned int getLastByteRead() = 0;
+};
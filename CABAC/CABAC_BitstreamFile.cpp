@@ -123,7 +123,8 @@ void CABAC_BitstreamFile::write   ( unsigned int uiBits, unsigned int uiNumberOf
 
   /* topword serves to justify held_bits to align with the msb of uiBits */
   unsigned int topword = (uiNumberOfBits - next_num_held_bits) & ~((1 << 3) -1);
-  unsigned int write_bits = (m_held_bits << topword) | (uiBits >> next_num_held_bits);
+  // topword is 32 only for a byte aligned 32 bit write, where no bits are held
+  unsigned int write_bits = (topword < 32 ? (m_held_bits << topword) : 0) | (uiBits >> next_num_held_bits);
 
   switch (num_total_bits >> 3)
   {
@@ -149,10 +150,3 @@ void CABAC_BitstreamFile::writeAlignZero()
   m_num_held_bits = 0;
   m_num_bits_written += 8;
 }
-
-unsigned int CABAC_BitstreamFile::readByte()
-{
-  unsigned char cRead = bitstreamFile.get();
-  m_cLastCharRead = cRead;
-  return cRead;
-}
\ No newline at end of file
@@ -34,12 +34,14 @@
 #pragma once
 
 #include <fstream>
+#include "CABAC_Bitstream.h"
 using namespace std;
 
 /** The CABAC bitstream file class
   *
   * The arithmetic coder can use this class to write out ones and zeroes to a file.
-  * You can write a different data sink for the arithmetic coder. The required functions 
+  * You can write a different data sink for the arithmetic coder by implementing the
+  * CABAC_Bitstream interface (see CABAC_BitstreamMemory). The required functions 
   * for the arithmetic coder are:
   *  - write(bits, nrBits)
   *  - writeAlignZero()
@@ -47,7 +49,7 @@ using namespace std;
   * Usage: Create an instance and open the output file. Give the instance to the arithmetic 
   * coder instance and start coding.
   */
-class CABAC_BitstreamFile
+class CABAC_BitstreamFile final : public CABAC_Bitstream
 {
 public:
   CABAC_BitstreamFile();
@@ -63,7 +65,12 @@ public:
   void  writeByteAlignment();
   
   // read from the stream
-  unsigned int readByte();
+  unsigned int readByte()
+  {
+    unsigned char cRead = bitstreamFile.get();
+    m_cLastCharRead = cRead;
+    return cRead;
+  }
   unsigned int getNumBitsUntilByteAligned() { return m_num_held_bits & (0x7); }
   
   // Return the number of bits that have been written since the last resetWrittenBits()
@@ -0,0 +1,94 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "CABAC_BitstreamMemory.h"
+#include <assert.h>
+
+CABAC_BitstreamMemory::CABAC_BitstreamMemory()
+{
+  m_pReadData = NULL;
+  m_uiReadLength = 0;
+  m_uiReadPos = 0;
+  m_num_held_bits = 0;
+  m_held_bits = 0;
+  m_num_bits_written = 0;
+  m_ucLastByteRead = 0;
+}
+
+CABAC_BitstreamMemory::~CABAC_BitstreamMemory()
+{
+}
+
+void CABAC_BitstreamMemory::openOutput(size_t uiReserveBytes)
+{
+  close();
+  m_buffer.reserve(uiReserveBytes);
+}
+
+void CABAC_BitstreamMemory::openInput(const unsigned char *pData, size_t uiLength)
+{
+  close();
+  m_pReadData = pData;
+  m_uiReadLength = uiLength;
+}
+
+void CABAC_BitstreamMemory::close()
+{
+  // keep the capacity of the buffer, so that a reused instance does not reallocate
+  m_buffer.clear();
+  m_pReadData = NULL;
+  m_uiReadLength = 0;
+  m_uiReadPos = 0;
+  m_num_held_bits = 0;
+  m_held_bits = 0;
+  m_num_bits_written = 0;
+  m_ucLastByteRead = 0;
+}
+
+void CABAC_BitstreamMemory::writeByteAlignment()
+{
+  write( 1, 1);
+  writeAlignZero();
+}
+
+void CABAC_BitstreamMemory::writeAlignZero()
+{
+  if (0 == m_num_held_bits)
+  {
+    return;
+  }
+  m_buffer.push_back(m_held_bits);
+  m_held_bits = 0;
+  m_num_held_bits = 0;
+  m_num_bits_written += 8;
+}
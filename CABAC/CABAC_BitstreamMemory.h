@@ -0,0 +1,161 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <assert.h>
+#include "CABAC_Bitstream.h"
+
+/** The CABAC memory bitstream class
+  *
+  * Memory counterpart of CABAC_BitstreamFile. The encoder output is written into a contiguous
+  * buffer which grows as needed, the decoder input is read from a span (pointer and length) 
+  * which is not copied and has to stay valid while decoding.
+  *
+  * Usage: Create an instance and call openOutput() or openInput(data, length). Give the 
+  * instance to the arithmetic coder instance and start coding. After encoding, the bytes are
+  * available via getData() / getNumBytes().
+  */
+class CABAC_BitstreamMemory final : public CABAC_Bitstream
+{
+public:
+  CABAC_BitstreamMemory();
+  ~CABAC_BitstreamMemory();
+
+  void openOutput(size_t uiReserveBytes = 0);
+  void openInput(const unsigned char *pData, size_t uiLength);
+  void close();
+
+  // append uiNumberOfBits least significant bits of uiBits to the current bitstream
+  void  write           ( unsigned int uiBits, unsigned int uiNumberOfBits );
+  void  writeAlignZero  ();     ///< insert zero bits until the bitstream is byte-aligned
+  void  writeByteAlignment();
+
+  // read from the stream, reading past the end returns 0xff like CABAC_BitstreamFile at the end of file
+  unsigned int readByte() 
+  {
+    m_ucLastByteRead = (m_uiReadPos < m_uiReadLength) ? m_pReadData[m_uiReadPos] : 0xff;
+    m_uiReadPos++;
+    return m_ucLastByteRead;
+  }
+  unsigned int getNumBitsUntilByteAligned() { return m_num_held_bits & (0x7); }
+
+  // Return the number of bits that have been written since the last resetWrittenBits()
+  unsigned int getNumberOfWrittenBits() const { return m_num_bits_written + m_num_held_bits; }
+  // Reset the bit counter to 0
+  void resetWrittenBits() { m_num_bits_written = 0; }
+  unsigned int getLastByteRead() { return m_ucLastByteRead; }
+
+  // the bytes written so far
+  const unsigned char* getData() const { return m_buffer.empty() ? NULL : &m_buffer[0]; }
+  size_t getNumBytes() const { return m_buffer.size(); }
+  // number of bytes consumed by the decoder so far
+  size_t getNumBytesRead() const { return m_uiReadPos; }
+
+  // the output position, to which the output can be truncated later
+  struct Position
+  {
+    size_t        uiNumBytes;
+    unsigned int  uiNumHeldBits;
+    unsigned char ucHeldBits;
+    unsigned int  uiNumBitsWritten;
+  };
+  Position getWritePosition() const 
+  { 
+    Position pos = { m_buffer.size(), m_num_held_bits, m_held_bits, m_num_bits_written }; 
+    return pos; 
+  }
+  // drop everything written after the position was taken, the buffer keeps its capacity
+  void truncate(const Position &rPosition)
+  {
+    assert(rPosition.uiNumBytes <= m_buffer.size());
+    m_buffer.resize(rPosition.uiNumBytes);
+    m_num_held_bits = rPosition.uiNumHeldBits;
+    m_held_bits = rPosition.ucHeldBits;
+    m_num_bits_written = rPosition.uiNumBitsWritten;
+  }
+
+protected:
+  // The output buffer
+  std::vector<unsigned char> m_buffer;
+
+  // The input span
+  const unsigned char *m_pReadData;
+  size_t        m_uiReadLength;
+  size_t        m_uiReadPos;
+
+  unsigned int  m_num_held_bits; /// number of bits not flushed to bytestream.
+  unsigned char m_held_bits; /// the bits held and not flushed to bytestream.
+                             /// this value is always msb-aligned, bigendian.
+  unsigned int  m_num_bits_written;
+  unsigned char m_ucLastByteRead;
+};
+
+/** Same bit packing as CABAC_BitstreamFile::write(), the completed bytes are appended to the buffer
+  */
+inline void CABAC_BitstreamMemory::write   ( unsigned int uiBits, unsigned int uiNumberOfBits )
+{
+  assert( uiNumberOfBits <= 32 );
+  assert( uiNumberOfBits == 32 || (uiBits & (~0u << uiNumberOfBits)) == 0 );
+
+  unsigned int num_total_bits = uiNumberOfBits + m_num_held_bits;
+  unsigned int next_num_held_bits = num_total_bits % 8;
+  unsigned char next_held_bits = uiBits << (8 - next_num_held_bits);
+
+  if (!(num_total_bits >> 3))
+  {
+    m_held_bits |= next_held_bits;
+    m_num_held_bits = next_num_held_bits;
+    return;
+  }
+
+  unsigned int topword = (uiNumberOfBits - next_num_held_bits) & ~((1 << 3) -1);
+  // topword is 32 only for a byte aligned 32 bit write, where no bits are held
+  unsigned int write_bits = (topword < 32 ? (m_held_bits << topword) : 0) | (uiBits >> next_num_held_bits);
+
+  switch (num_total_bits >> 3)
+  {
+    case 4: m_buffer.push_back((unsigned char)(write_bits >> 24)); m_num_bits_written += 8;
+      // fall through
+    case 3: m_buffer.push_back((unsigned char)(write_bits >> 16)); m_num_bits_written += 8;
+      // fall through
+    case 2: m_buffer.push_back((unsigned char)(write_bits >> 8)); m_num_bits_written += 8;
+      // fall through
+    case 1: m_buffer.push_back((unsigned char)(write_bits)); m_num_bits_written += 8;
+  }
+
+  m_held_bits = next_held_bits;
+  m_num_held_bits = next_num_held_bits;
+}
@@ -0,0 +1,205 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "CABAC_BitstreamMmap.h"
+#include <assert.h>
+#include <string.h>
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+CABAC_BitstreamMmap::CABAC_BitstreamMmap()
+{
+  m_pucData = NULL;
+  m_pucRead = NULL;
+  m_pucLast = NULL;
+  m_uiNumBytes = 0;
+  m_ucLastByteRead = 0;
+  m_pMapping = NULL;
+  m_uiMappingSize = 0;
+}
+
+CABAC_BitstreamMmap::~CABAC_BitstreamMmap()
+{
+  closeFile();
+}
+
+void CABAC_BitstreamMmap::openInputBuffer(const unsigned char *pData, size_t uiLength)
+{
+  closeFile();
+  m_fallbackBuffer.assign(uiLength + RWTH_CABAC_MMAP_PADDING, 0xff);
+  if (uiLength > 0)
+  {
+    memcpy(&m_fallbackBuffer[0], pData, uiLength);
+  }
+  m_uiNumBytes = uiLength;
+  m_pucData = &m_fallbackBuffer[0];
+  m_pucRead = m_pucData;
+  m_pucLast = m_pucData + m_uiNumBytes + RWTH_CABAC_MMAP_PADDING - 1;
+}
+
+#ifdef _WIN32
+// Fallback: read the file into a padded buffer
+bool CABAC_BitstreamMmap::openInputFile(const char *cInputFileName)
+{
+  closeFile();
+  std::ifstream file(cInputFileName, std::ifstream::in | std::ifstream::binary | std::ifstream::ate);
+  if (!file)
+  {
+    return false;
+  }
+  m_uiNumBytes = (size_t)file.tellg();
+  file.seekg(0);
+  m_fallbackBuffer.assign(m_uiNumBytes + RWTH_CABAC_MMAP_PADDING, 0xff);
+  if (m_uiNumBytes > 0 && !file.read((char*)&m_fallbackBuffer[0], m_uiNumBytes))
+  {
+    m_fallbackBuffer.clear();
+    return false;
+  }
+  m_pucData = &m_fallbackBuffer[0];
+  m_pucRead = m_pucData;
+  m_pucLast = m_pucData + m_uiNumBytes + RWTH_CABAC_MMAP_PADDING - 1;
+  return true;
+}
+
+void CABAC_BitstreamMmap::closeFile()
+{
+  m_fallbackBuffer.clear();
+  m_pucData = NULL;
+  m_pucRead = NULL;
+  m_pucLast = NULL;
+  m_uiNumBytes = 0;
+}
+#else
+/** Map the file read-only. 
+  *
+  * All complete pages of the file are mapped directly. The remaining bytes of the last page 
+  * are copied into an anonymous page behind them, followed by the padding. This way, the 
+  * padding also works if the file size is a multiple of the page size, where a plain file 
+  * mapping would end exactly at the end of the file.
+  */
+bool CABAC_BitstreamMmap::openInputFile(const char *cInputFileName)
+{
+  closeFile();
+  int fd = open(cInputFileName, O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  const size_t pageSize  = (size_t)sysconf(_SC_PAGESIZE);
+  const size_t numBytes  = (size_t)fileStat.st_size;
+  const size_t fullPages = numBytes / pageSize * pageSize;
+  const size_t tailBytes = numBytes - fullPages;
+  const size_t tailPages = (tailBytes + RWTH_CABAC_MMAP_PADDING + pageSize - 1) / pageSize * pageSize;
+
+  // reserve the address range and fill the tail
+  unsigned char *pMapping = (unsigned char*)mmap(NULL, fullPages + tailPages, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (pMapping == MAP_FAILED)
+  {
+    close(fd);
+    return false;
+  }
+  unsigned char *pTail = pMapping + fullPages;
+  size_t numRead = 0;
+  while (numRead < tailBytes)
+  {
+    ssize_t ret = pread(fd, pTail + numRead, tailBytes - numRead, fullPages + numRead);
+    if (ret <= 0)
+    {
+      munmap(pMapping, fullPages + tailPages);
+      close(fd);
+      return false;
+    }
+    numRead += ret;
+  }
+  memset(pTail + tailBytes, 0xff, tailPages - tailBytes);
+  mprotect(pTail, tailPages, PROT_READ);
+
+  // map the complete pages of the file over the front of the reserved range
+  if (fullPages > 0 && mmap(pMapping, fullPages, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+  {
+    munmap(pMapping, fullPages + tailPages);
+    close(fd);
+    return false;
+  }
+  close(fd);
+#ifdef MADV_SEQUENTIAL
+  madvise(pMapping, fullPages + tailPages, MADV_SEQUENTIAL);
+#endif
+
+  m_pMapping = pMapping;
+  m_uiMappingSize = fullPages + tailPages;
+  m_uiNumBytes = numBytes;
+  m_pucData = pMapping;
+  m_pucRead = m_pucData;
+  m_pucLast = m_pucData + numBytes + RWTH_CABAC_MMAP_PADDING - 1;
+  return true;
+}
+
+void CABAC_BitstreamMmap::closeFile()
+{
+  if (m_pMapping)
+  {
+    munmap(m_pMapping, m_uiMappingSize);
+  }
+  m_fallbackBuffer.clear();
+  m_pMapping = NULL;
+  m_uiMappingSize = 0;
+  m_pucData = NULL;
+  m_pucRead = NULL;
+  m_pucLast = NULL;
+  m_uiNumBytes = 0;
+}
+#endif
+
+void CABAC_BitstreamMmap::write( unsigned int /*uiBits*/, unsigned int /*uiNumberOfBits*/ )
+{
+  assert(!"CABAC_BitstreamMmap is an input bitstream");
+}
+
+void CABAC_BitstreamMmap::writeAlignZero()
+{
+  assert(!"CABAC_BitstreamMmap is an input bitstream");
+}
@@ -0,0 +1,96 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "CABAC_Bitstream.h"
+
+// Number of padding bytes behind the mapped bitstream. They read as 0xff, which is what
+// CABAC_BitstreamFile returns at the end of the file.
+#define RWTH_CABAC_MMAP_PADDING 8
+
+/** The CABAC memory mapped bitstream class (input only)
+  *
+  * Maps the bitstream file read-only into memory. The mapping is followed by 
+  * RWTH_CABAC_MMAP_PADDING bytes of 0xff, so readByte() does not need a bounds check. 
+  * Reading beyond the padding keeps returning the last padding byte. A bitstream which is 
+  * already in memory can be read with the same padding via openInputBuffer().
+  *
+  * Usage: Create an instance and open the input file. Give the instance to the arithmetic 
+  * decoder instance and start decoding.
+  */
+class CABAC_BitstreamMmap final : public CABAC_Bitstream
+{
+public:
+  CABAC_BitstreamMmap();
+  ~CABAC_BitstreamMmap();
+
+  bool openInputFile(const char *cInputFileName);
+  // read from a copy of a bitstream which is already in memory
+  void openInputBuffer(const unsigned char *pData, size_t uiLength);
+  void closeFile();
+
+  // this is an input bitstream, writing is not supported
+  void  write           ( unsigned int uiBits, unsigned int uiNumberOfBits );
+  void  writeAlignZero  ();
+
+  // read from the stream
+  unsigned int readByte()
+  {
+    m_ucLastByteRead = *m_pucRead;
+    m_pucRead += (m_pucRead < m_pucLast);
+    return m_ucLastByteRead;
+  }
+  unsigned int getNumBitsUntilByteAligned() { return 0; }
+
+  unsigned int getNumberOfWrittenBits() const { return 0; }
+  unsigned int getLastByteRead() { return m_ucLastByteRead; }
+
+  // the mapped bitstream
+  const unsigned char* getData() const { return m_pucData; }
+  size_t getNumBytes() const { return m_uiNumBytes; }
+
+protected:
+  const unsigned char *m_pucData;   ///< start of the bitstream
+  const unsigned char *m_pucRead;   ///< next byte to read
+  const unsigned char *m_pucLast;   ///< last padding byte
+  size_t        m_uiNumBytes;       ///< size of the bitstream file
+  unsigned char m_ucLastByteRead;
+
+  // the mapping (POSIX) or the copy of the file (Windows, openInputBuffer)
+  void         *m_pMapping;
+  size_t        m_uiMappingSize;
+  std::vector<unsigned char> m_fallbackBuffer;
+};
@@ -0,0 +1,62 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+#include "CABAC_Bitstream.h"
+
+/** The CABAC null bitstream class (output only)
+  *
+  * Discards all bits and only counts them. Use it with the arithmetic encoder to determine
+  * the size of a bitstream without storing it.
+  */
+class CABAC_BitstreamNull final : public CABAC_Bitstream
+{
+public:
+  CABAC_BitstreamNull() : m_uiNumBitsWritten(0) {}
+  ~CABAC_BitstreamNull() {}
+
+  void  write           ( unsigned int /*uiBits*/, unsigned int uiNumberOfBits ) { m_uiNumBitsWritten += uiNumberOfBits; }
+  void  writeAlignZero  () { m_uiNumBitsWritten = (m_uiNumBitsWritten + 7) & ~7u; }
+
+  // this is an output bitstream, there is nothing to read
+  unsigned int readByte() { return 0xff; }
+  unsigned int getNumBitsUntilByteAligned() { return m_uiNumBitsWritten & (0x7); }
+
+  unsigned int getNumberOfWrittenBits() const { return m_uiNumBitsWritten; }
+  void resetWrittenBits() { m_uiNumBitsWritten = 0; }
+  unsigned int getLastByteRead() { return 0xff; }
+
+protected:
+  unsigned int m_uiNumBitsWritten;
+};
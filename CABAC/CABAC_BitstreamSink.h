@@ -0,0 +1,157 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+#include <stddef.h>
+#include <assert.h>
+#include <functional>
+#include "CABAC_Bitstream.h"
+
+/** Receiver of the output of a CABAC_BitstreamSink
+  */
+class CABAC_ByteSink
+{
+public:
+  virtual ~CABAC_ByteSink() {}
+
+  /// the bytes completed by one write of the encoder, they are final
+  virtual void putBytes(const unsigned char *pData, size_t uiNumBytes) = 0;
+};
+
+/** A CABAC_ByteSink which calls a function with the completed bytes
+  */
+class CABAC_CallbackSink final : public CABAC_ByteSink
+{
+public:
+  typedef std::function<void(const unsigned char *pData, size_t uiNumBytes)> Callback;
+
+  explicit CABAC_CallbackSink(const Callback &callback) : m_callback(callback) {}
+  ~CABAC_CallbackSink() {}
+
+  void putBytes(const unsigned char *pData, size_t uiNumBytes) { m_callback(pData, uiNumBytes); }
+
+protected:
+  Callback m_callback;
+};
+
+/** The CABAC streaming bitstream class (output only)
+  *
+  * Hands every completed byte to a CABAC_ByteSink (e.g. CABAC_CallbackSink or 
+  * CABAC_ByteRingBuffer) right away instead of storing it. The arithmetic encoders only 
+  * write a byte after its carry is resolved (the outstanding bytes of writeOut()), so every
+  * byte reaching the sink is final and can be sent while the encoding continues. The 32 bit
+  * encoder writes single bytes as soon as they are resolved, the 64 bit encoder writes up to 
+  * 4 bytes at once when its low register is flushed. After finish() of the encoder, all 
+  * bytes have been handed to the sink.
+  */
+class CABAC_BitstreamSink final : public CABAC_Bitstream
+{
+public:
+  CABAC_BitstreamSink(CABAC_ByteSink *pSink = NULL) : m_pSink(pSink), m_num_held_bits(0), m_held_bits(0), m_num_bits_written(0) {}
+  ~CABAC_BitstreamSink() {}
+
+  /// start a new output into pSink
+  void openOutput(CABAC_ByteSink *pSink)
+  {
+    m_pSink = pSink;
+    m_num_held_bits = 0;
+    m_held_bits = 0;
+    m_num_bits_written = 0;
+  }
+
+  // append uiNumberOfBits least significant bits of uiBits to the current bitstream
+  void  write           ( unsigned int uiBits, unsigned int uiNumberOfBits );
+  void  writeAlignZero  ()     ///< insert zero bits until the bitstream is byte-aligned
+  {
+    if (m_num_held_bits)
+    {
+      m_pSink->putBytes(&m_held_bits, 1);
+      m_held_bits = 0;
+      m_num_held_bits = 0;
+      m_num_bits_written += 8;
+    }
+  }
+
+  // this is an output bitstream, there is nothing to read
+  unsigned int readByte() { return 0xff; }
+  unsigned int getNumBitsUntilByteAligned() { return m_num_held_bits & (0x7); }
+
+  // Return the number of bits that have been written since the last resetWrittenBits()
+  unsigned int getNumberOfWrittenBits() const { return m_num_bits_written + m_num_held_bits; }
+  void resetWrittenBits() { m_num_bits_written = 0; }
+  unsigned int getLastByteRead() { return 0xff; }
+
+protected:
+  CABAC_ByteSink *m_pSink;
+
+  unsigned int  m_num_held_bits;  ///< number of bits not handed to the sink
+  unsigned char m_held_bits;      ///< the held bits, msb-aligned
+  unsigned int  m_num_bits_written;
+};
+
+/** Same bit packing as CABAC_BitstreamMemory::write(), the completed bytes go to the sink
+  */
+inline void CABAC_BitstreamSink::write   ( unsigned int uiBits, unsigned int uiNumberOfBits )
+{
+  assert( m_pSink );
+  assert( uiNumberOfBits <= 32 );
+  assert( uiNumberOfBits == 32 || (uiBits & (~0u << uiNumberOfBits)) == 0 );
+
+  unsigned int num_total_bits = uiNumberOfBits + m_num_held_bits;
+  unsigned int next_num_held_bits = num_total_bits % 8;
+  unsigned char next_held_bits = uiBits << (8 - next_num_held_bits);
+
+  if (!(num_total_bits >> 3))
+  {
+    m_held_bits |= next_held_bits;
+    m_num_held_bits = next_num_held_bits;
+    return;
+  }
+
+  unsigned int topword = (uiNumberOfBits - next_num_held_bits) & ~((1 << 3) -1);
+  // topword is 32 only for a byte aligned 32 bit write, where no bits are held
+  unsigned int write_bits = (topword < 32 ? (m_held_bits << topword) : 0) | (uiBits >> next_num_held_bits);
+
+  const unsigned int numBytes = num_total_bits >> 3;
+  unsigned char aucBytes[4];
+  for (unsigned int i = 0; i < numBytes; i++)
+  {
+    aucBytes[i] = (unsigned char)(write_bits >> (8 * (numBytes - 1 - i)));
+  }
+  m_pSink->putBytes(aucBytes, numBytes);
+  m_num_bits_written += 8 * numBytes;
+
+  m_held_bits = next_held_bits;
+  m_num_held_bits = next_num_held_bits;
+}
@@ -0,0 +1,132 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include "CABAC_BitstreamSink.h"
+
+/** Lock-free single producer / single consumer ring buffer of bytes
+  *
+  * A CABAC_ByteSink to stream the output of an encoder to another thread: the encoding thread
+  * writes the bytes with putBytes() (through a CABAC_BitstreamSink), waiting while the buffer 
+  * is full, and calls close() after finish(). The consumer thread takes the available bytes 
+  * with getBytes() and has received all bytes once isFinished() returns true. The positions 
+  * only grow, one atomic per side, so neither side ever takes a lock.
+  */
+class CABAC_ByteRingBuffer final : public CABAC_ByteSink
+{
+public:
+  /// the capacity is rounded up to a power of two
+  explicit CABAC_ByteRingBuffer(size_t uiCapacity = 65536)
+    : m_uiReadPos(0)
+    , m_uiWritePos(0)
+    , m_bClosed(false)
+  {
+    size_t uiSize = 1;
+    while (uiSize < uiCapacity)
+    {
+      uiSize <<= 1;
+    }
+    m_buffer.resize(uiSize);
+    m_uiMask = uiSize - 1;
+  }
+  ~CABAC_ByteRingBuffer() {}
+
+  /// empty the buffer for the next stream, neither thread may use it meanwhile
+  void reset()
+  {
+    m_uiReadPos.store(0);
+    m_uiWritePos.store(0);
+    m_bClosed.store(false);
+  }
+
+  /// producer: append the bytes, waits while the buffer is full
+  void putBytes(const unsigned char *pData, size_t uiNumBytes)
+  {
+    size_t uiWritePos = m_uiWritePos.load(std::memory_order_relaxed);
+    while (uiNumBytes > 0)
+    {
+      const size_t uiFree = m_buffer.size() - (uiWritePos - m_uiReadPos.load(std::memory_order_acquire));
+      if (uiFree == 0)
+      {
+        std::this_thread::yield();
+        continue;
+      }
+      const size_t n = std::min(uiFree, uiNumBytes);
+      for (size_t i = 0; i < n; i++)
+      {
+        m_buffer[(uiWritePos + i) & m_uiMask] = pData[i];
+      }
+      pData += n;
+      uiNumBytes -= n;
+      uiWritePos += n;
+      m_uiWritePos.store(uiWritePos, std::memory_order_release);
+    }
+  }
+  /// producer: no more bytes will follow
+  void close() { m_bClosed.store(true, std::memory_order_release); }
+
+  /// consumer: take up to uiMaxBytes bytes, returns the number of bytes taken (0 if none are available)
+  size_t getBytes(unsigned char *pData, size_t uiMaxBytes)
+  {
+    const size_t uiReadPos = m_uiReadPos.load(std::memory_order_relaxed);
+    const size_t n = std::min(m_uiWritePos.load(std::memory_order_acquire) - uiReadPos, uiMaxBytes);
+    for (size_t i = 0; i < n; i++)
+    {
+      pData[i] = m_buffer[(uiReadPos + i) & m_uiMask];
+    }
+    m_uiReadPos.store(uiReadPos + n, std::memory_order_release);
+    return n;
+  }
+  /// consumer: the producer has closed the buffer and all bytes were taken
+  bool isFinished() const
+  {
+    return m_bClosed.load(std::memory_order_acquire) 
+        && m_uiReadPos.load(std::memory_order_relaxed) == m_uiWritePos.load(std::memory_order_acquire);
+  }
+
+  size_t getCapacity() const { return m_buffer.size(); }
+
+protected:
+  std::vector<unsigned char> m_buffer;
+  size_t m_uiMask;
+  // the number of bytes taken / appended so far, on separate cache lines
+  alignas(64) std::atomic<size_t> m_uiReadPos;
+  alignas(64) std::atomic<size_t> m_uiWritePos;
+  std::atomic<bool> m_bClosed;
+};
@@ -0,0 +1,251 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "CABAC_ConfigSearch.h"
+#include "CABAC_ContextModelsInit.h"
+#include "CABAC_ArithmeticEncoder64.h"
+#include "CABAC_BitstreamNull.h"
+#include <algorithm>
+#include <math.h>
+
+bool CABAC_ConfigSearch::initCoder(CABAC_MatrixCoder &rCoder, const CABAC_SearchConfig &config, unsigned int uiNq)
+{
+  if (!rCoder.init(config.binMethod.c_str(), uiNq, config.iNlbp))
+  {
+    return false;
+  }
+  for (size_t i = 0; i < config.cmTypes.size(); i++)
+  {
+    if (!rCoder.addContextModelType(config.cmTypes[i].c_str()))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// sum(mask) / length(mask), or 0 for an empty mask
+static double xRatio(double count, double length)
+{
+  return length > 0 ? count / length : 0;
+}
+
+// the conditional probability joint / norm of cabacInitContextModel.m, norm is 1 if the condition never occurs
+static double xConditional(double joint, double cond, double length)
+{
+  return xRatio(joint, length) / (cond > 0 ? cond / length : 1);
+}
+
+// the counts are kept like the masks of cabacInitContextModel.m, so that the divisions are the same
+void CABAC_ConfigSearch::getInitProbabilities(const CABAC_MatrixCoder &rCoder, const CABAC_Codeword *pCodewords,
+                                              size_t numRows, size_t numCols, std::vector<double> &p0)
+{
+  const int N = rCoder.getNlbp();
+  const unsigned int uiTypes = rCoder.getContextModelTypes();
+  // index n - 1 for bin n (1-based)
+  std::vector<double> preSel(N), preZero(N), upSel(N), up0(N), up1(N), joint0(N), joint1(N);
+  std::vector<double> lftSel(N), lftOne(N), lftJoint(N), sufSel(N), sufZero(N);
+  std::vector<double> sufUpSel(N), sufUp0(N), sufUp1(N), sufJoint0(N), sufJoint1(N);
+  double restPreBins = 0, restPreZeros = 0, restSufBins = 0, restSufZeros = 0;
+
+  for (size_t k = 0; k < numCols; k++)
+  {
+    for (size_t d = 0; d < numRows; d++)
+    {
+      const CABAC_Codeword &cur = pCodewords[k * numRows + d];
+      const int L = cur.getNumBins();
+      const int np = cur.getPrefixLength() ? cur.getPrefixLength() : L;
+      // the upper neighbor of the first row is a single NaN, which is neither 0 nor 1
+      const bool bUp = d > 0;
+      const CABAC_Codeword &up = bUp ? pCodewords[k * numRows + d - 1] : cur;
+      const int Lup = bUp ? up.getNumBins() : 1;
+      const int npUp = bUp ? (up.getPrefixLength() ? up.getPrefixLength() : Lup) : 0;
+
+      for (int n = 1; n <= N; n++)
+      {
+        const int i = n - 1;
+        // prefix
+        if (n <= np)
+        {
+          preSel[i]++;
+          const bool bZero = cur.getBin(n - 1) == 0;
+          preZero[i] += bZero;
+          if (n <= npUp)
+          {
+            const unsigned int uiUp = up.getBin(n - 1);
+            upSel[i]++;
+            up0[i] += uiUp == 0;
+            up1[i] += uiUp == 1;
+            joint0[i] += bZero && uiUp == 0;
+            joint1[i] += bZero && uiUp == 1;
+          }
+        }
+        if (n + 1 <= np && npUp < n + 1)
+        {
+          const bool bOne = cur.getBin(n - 1) == 1;
+          lftSel[i]++;
+          lftOne[i] += bOne;
+          lftJoint[i] += bOne && cur.getBin(n) == 0;
+        }
+        // suffix
+        if (n + np <= L)
+        {
+          const bool bZero = cur.getBin(n + np - 1) == 0;
+          sufSel[i]++;
+          sufZero[i] += bZero;
+          if (n + npUp <= Lup)
+          {
+            sufUpSel[i]++;
+            if (bUp)
+            {
+              // the joint probability looks at the suffix bin of the upper neighbor, 
+              // the normalization at its bin n as in cabacInitContextModel.m
+              const unsigned int uiUp = up.getBin(n + npUp - 1);
+              sufJoint0[i] += bZero && uiUp == 0;
+              sufJoint1[i] += bZero && uiUp == 1;
+              sufUp0[i] += up.getBin(n - 1) == 0;
+              sufUp1[i] += up.getBin(n - 1) == 1;
+            }
+          }
+        }
+      }
+
+      // the rest: the prefix bins N+1...np and the bins N+1...L after a shorter prefix
+      const int n = N + 1;
+      if (n <= np)
+      {
+        restPreBins += np - n + 1;
+        restPreZeros += cur.getBin(np - 1) == 0;
+      }
+      else if (n <= L)
+      {
+        restSufBins += L - n + 1;
+        for (int j = n; j <= L; j++)
+        {
+          restSufZeros += cur.getBin(j - 1) == 0;
+        }
+      }
+    }
+  }
+
+  p0.assign(7 * N + 2, 0);
+  for (int i = 0; i < N; i++)
+  {
+    p0[i] = xRatio(preZero[i], preSel[i]);
+    if (uiTypes & CABAC_MatrixCoder::CM_COND0)      { p0[N + i] = xConditional(joint0[i], up0[i], upSel[i]); }
+    if (uiTypes & CABAC_MatrixCoder::CM_COND1)      { p0[2 * N + i] = xConditional(joint1[i], up1[i], upSel[i]); }
+    if (uiTypes & CABAC_MatrixCoder::CM_CONDBINLFT) { p0[3 * N + i] = xConditional(lftJoint[i], lftOne[i], lftSel[i]); }
+    p0[4 * N + i] = xRatio(sufZero[i], sufSel[i]);
+    if (uiTypes & CABAC_MatrixCoder::CM_CONDS0)     { p0[5 * N + i] = xConditional(sufJoint0[i], sufUp0[i], sufUpSel[i]); }
+    if (uiTypes & CABAC_MatrixCoder::CM_CONDS1)     { p0[6 * N + i] = xConditional(sufJoint1[i], sufUp1[i], sufUpSel[i]); }
+  }
+  p0[7 * N] = xRatio(restPreZeros, restPreBins);
+  p0[7 * N + 1] = xRatio(restSufZeros, restSufBins);
+}
+
+void CABAC_ConfigSearch::quantizeProbabilities(std::vector<double> &p0)
+{
+  for (size_t i = 0; i < p0.size(); i++)
+  {
+    // uint8() rounds half away from zero and saturates, the conditional probabilities 
+    // of the suffix can exceed 1 as their normalization looks at a different bin
+    p0[i] = std::min(floor(p0[i] * 255 + 0.5), 255.0) / 255;
+  }
+}
+
+double CABAC_ConfigSearch::countBits(CABAC_MatrixCoder &rCoder, const CABAC_Codeword *pCodewords, size_t numRows, size_t numCols,
+                                     std::vector<ContextModel> initModels)
+{
+  CABAC_BitstreamNull nullStream;
+  CABAC_ArithmeticEncoder64Null nullEncoder(&nullStream);
+  nullEncoder.start();
+  for (size_t k = 0; k < numCols; k++)
+  {
+    rCoder.startColumn();
+    for (size_t d = 0; d < numRows; d++)
+    {
+      int numBins = rCoder.setValue(pCodewords[k * numRows + d]);
+      const uint8_t *bins = rCoder.getBins();
+      const int32_t *ctxIdx = rCoder.getContexts();
+      for (int n = 0; n < numBins; n++)
+      {
+        nullEncoder.encodeBin(bins[n], &initModels[ctxIdx[n]]);
+      }
+    }
+  }
+  nullEncoder.finish();
+  return nullStream.getNumberOfWrittenBits();
+}
+
+void CABAC_ConfigSearch::search(CABAC_ThreadPool &pool, const std::vector<unsigned int> &values, size_t numRows, unsigned int uiNq,
+                                const std::vector<std::string> &binMethods, const std::vector<std::vector<std::string> > &cmTypes,
+                                const std::vector<int> &Nlbps, std::vector<CABAC_SearchResult> &rRanking)
+{
+  const size_t numCols = numRows ? values.size() / numRows : 0;
+  const int numConfigs = (int)(binMethods.size() * cmTypes.size() * Nlbps.size());
+  rRanking.resize(numConfigs);
+  pool.run(numConfigs, [&](int i)
+  {
+    CABAC_SearchResult &result = rRanking[i];
+    result.iNlbp = i % (int)Nlbps.size();
+    result.iTypes = (i / (int)Nlbps.size()) % (int)cmTypes.size();
+    result.iMethod = i / (int)(Nlbps.size() * cmTypes.size());
+    CABAC_SearchConfig config = { binMethods[result.iMethod], cmTypes[result.iTypes], Nlbps[result.iNlbp] };
+    CABAC_MatrixCoder coder;
+    bool bValid = initCoder(coder, config, uiNq);
+    assert(bValid);
+    (void)bValid;
+
+    std::vector<CABAC_Codeword> codewords(values.size());
+    if (!values.empty())
+    {
+      coder.getBinarizer().binarize(&values[0], values.size(), &codewords[0]);
+    }
+    std::vector<double> p0;
+    getInitProbabilities(coder, codewords.empty() ? NULL : &codewords[0], numRows, numCols, p0);
+    quantizeProbabilities(p0);
+    std::vector<ContextModel> initModels(p0.size());
+    for (size_t j = 0; j < p0.size(); j++)
+    {
+      int mps, state;
+      CABAC_ContextModels::mapProbabilityToState(p0[j], mps, state);
+      initModels[j].init(mps, state);
+    }
+    result.dCodedBits = countBits(coder, codewords.empty() ? NULL : &codewords[0], numRows, numCols, initModels);
+    result.dInitBits = 8.0 * p0.size();
+  });
+  std::stable_sort(rRanking.begin(), rRanking.end(), [](const CABAC_SearchResult &a, const CABAC_SearchResult &b)
+  {
+    return a.getTotalBits() < b.getTotalBits();
+  });
+}
@@ -0,0 +1,92 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "ContextModel.h"
+#include "CABAC_Binarizer.h"
+#include "CABAC_MatrixCoder.h"
+#include "CABAC_ThreadPool.h"
+
+/// one binarization / context configuration of CABAC_ConfigSearch
+struct CABAC_SearchConfig
+{
+  std::string              binMethod;
+  std::vector<std::string> cmTypes;
+  int                      iNlbp;
+};
+
+/// the cost of a configuration, the indices refer to the candidate lists of CABAC_ConfigSearch::search
+struct CABAC_SearchResult
+{
+  int    iMethod;
+  int    iTypes;
+  int    iNlbp;
+  double dCodedBits;  ///< size of the coded matrix
+  double dInitBits;   ///< side information of the context initialization
+
+  double getTotalBits() const { return dCodedBits + dInitBits; }
+};
+
+/** Search for the binarization and context configuration of a matrix
+  *
+  * Does for every configuration what cabacEncode.m does: the initial probability of a 0 bin
+  * is measured for every context like in cabacInitContextModel.m, quantized to 8 bits like 
+  * ctxInit0 and the matrix is coded column by column with these initial contexts. Only the 
+  * number of bits is kept. The 8 bits per context of ctxInit0 are counted as side information.
+  */
+class CABAC_ConfigSearch
+{
+public:
+  /// the probabilities of cabacInitContextModel.m for the 7*Nlbp+2 contexts of rCoder, 
+  /// the values are the bin strings of a numRows x numCols matrix in column-major order
+  static void getInitProbabilities(const CABAC_MatrixCoder &rCoder, const CABAC_Codeword *pCodewords, 
+                                   size_t numRows, size_t numCols, std::vector<double> &p0);
+  /// ctxInit0 = uint8(p0 * 255) and back, as transmitted to the decoder
+  static void quantizeProbabilities(std::vector<double> &p0);
+  /// the size of the coded matrix with the initial contexts initModels
+  static double countBits(CABAC_MatrixCoder &rCoder, const CABAC_Codeword *pCodewords, size_t numRows, size_t numCols,
+                          std::vector<ContextModel> initModels);
+
+  /// the cost of every combination of the candidates, sorted by the total bits. The candidates 
+  /// must be valid for CABAC_MatrixCoder, the values must be within 0...Nq-1.
+  static void search(CABAC_ThreadPool &pool, const std::vector<unsigned int> &values, size_t numRows, unsigned int uiNq,
+                     const std::vector<std::string> &binMethods, const std::vector<std::vector<std::string> > &cmTypes,
+                     const std::vector<int> &Nlbps, std::vector<CABAC_SearchResult> &rRanking);
+
+  /// set up a matrix coder with a configuration, returns false if it is invalid
+  static bool initCoder(CABAC_MatrixCoder &rCoder, const CABAC_SearchConfig &config, unsigned int uiNq);
+};
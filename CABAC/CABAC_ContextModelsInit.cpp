@@ -41,6 +41,8 @@ template <typename T> T clip(const T& n, const T& lower, const T& upper)
 }
 
 CABAC_ContextModels::CABAC_ContextModels()
+  : m_maxNumContextModels(0)
+  , m_eProbabilityModel(CABAC_PROB_HEVC)
 {
 }
 
@@ -50,8 +52,7 @@ CABAC_ContextModels::~CABAC_ContextModels()
 
 void CABAC_ContextModels::initContextModelsByMpsState(int maxNumContextModels, const mxArray * ptr)
 {
-  assert(maxNumContextModels < RWTH_MAX_NUM_CONTEXTS);
-  m_maxNumContextModels = maxNumContextModels;
+  xAllocate(maxNumContextModels);
 
   if (!mxIsDouble(ptr))
     assert(mxIsDouble(ptr));
@@ -72,6 +73,7 @@ void CABAC_ContextModels::initContextModelsByMpsState(int maxNumContextModels, c
     double * mpsdata = data + (ctxIdx * 3 + 1);
     double * statedata = data + (ctxIdx * 3 + 2);
     m_contextModels[ctxIdx].init(static_cast<unsigned int>(*(mpsdata)), static_cast<unsigned int>(*(statedata)));
+    m_aucInitStateIdx[ctxIdx] = m_contextModels[ctxIdx].getStateIdx();
 #if RWTH_CABAC_DEBUG_OUTPUT
     mexPrintf("Status: context: %i, mps: %i, state: %i\n", ctxIdx, static_cast<unsigned int>(*(mpsdata)), static_cast<unsigned int>(*(statedata)));
 #endif
@@ -79,10 +81,10 @@ void CABAC_ContextModels::initContextModelsByMpsState(int maxNumContextModels, c
 
 }
 
-void CABAC_ContextModels::initContextModelsByP0Prob(int maxNumContextModels, const mxArray * ptr)
+void CABAC_ContextModels::initContextModelsByP0Prob(int maxNumContextModels, const mxArray * ptr, CABAC_ProbabilityModel eModel)
 {
-  assert(maxNumContextModels < RWTH_MAX_NUM_CONTEXTS);
-  m_maxNumContextModels = maxNumContextModels;
+  xAllocate(maxNumContextModels);
+  m_eProbabilityModel = eModel;
 
   if (!mxIsDouble(ptr))
     assert(mxIsDouble(ptr));
@@ -103,25 +105,54 @@ void CABAC_ContextModels::initContextModelsByP0Prob(int maxNumContextModels, con
   for (int ctxIdx = 0; ctxIdx < m_maxNumContextModels; ctxIdx++)
   {
     double * p0probs = data + ctxIdx;
-    xMapProbabilityToState(*(p0probs), mps, state);
+    mapProbabilityToState(*(p0probs), mps, state);
     m_contextModels[ctxIdx].init(mps, state);
+    m_aucInitStateIdx[ctxIdx] = m_contextModels[ctxIdx].getStateIdx();
 #if RWTH_CABAC_DEBUG_OUTPUT
     mexPrintf("Status: context: %i, p0: %.2f, mps: %i, state: %i\n", ctxIdx, *(p0probs), mps, state);
 #endif
   }
+  if (m_eProbabilityModel == CABAC_PROB_DUAL_RATE)
+  {
+    m_dualRateInitModels.resize(m_maxNumContextModels);
+    for (int ctxIdx = 0; ctxIdx < m_maxNumContextModels; ctxIdx++)
+    {
+      m_dualRateInitModels[ctxIdx].init(data[ctxIdx]);
+    }
+    m_dualRateModels = m_dualRateInitModels;
+  }
 }
 
-#if RWTH_TRACE_CABAC_STATES && RWTH_TRACE_CABAC_TO_FILE
-void CABAC_ContextModels::writeCompleteTraces(FILE * TraceCabacStatFile)
+void CABAC_ContextModels::resetContextModels()
 {
-  for (int k = 0; k < m_maxNumContextModels; k++)
+  for (int ctxIdx = 0; ctxIdx < m_maxNumContextModels; ctxIdx++)
   {
-    m_contextModels[k].traceStatesToFile(TraceCabacStatFile);
+    m_contextModels[ctxIdx].updateStateIdx(m_aucInitStateIdx[ctxIdx]);
   }
+  m_dualRateModels = m_dualRateInitModels;
+}
+
+void CABAC_ContextModels::getInitContextModels(std::vector<ContextModel> &models) const
+{
+  models.resize(m_maxNumContextModels);
+  for (int ctxIdx = 0; ctxIdx < m_maxNumContextModels; ctxIdx++)
+  {
+    models[ctxIdx].updateStateIdx(m_aucInitStateIdx[ctxIdx]);
+  }
+}
+
+void CABAC_ContextModels::xAllocate(int maxNumContextModels)
+{
+  assert(maxNumContextModels >= 0);
+  m_maxNumContextModels = maxNumContextModels;
+  m_contextModels.assign(maxNumContextModels, ContextModel());
+  m_aucInitStateIdx.assign(maxNumContextModels, 0);
+  m_eProbabilityModel = CABAC_PROB_HEVC;
+  m_dualRateModels.clear();
+  m_dualRateInitModels.clear();
 }
-#endif
 
-void CABAC_ContextModels::xMapProbabilityToState(double p0, int& mps, int& state)
+void CABAC_ContextModels::mapProbabilityToState(double p0, int& mps, int& state)
 {
   if (p0 > 1.0 || p0 < 0.0)
     assert(p0 <= 1.0 && p0 >= 0.0);
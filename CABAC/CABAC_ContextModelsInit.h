@@ -34,15 +34,27 @@
 #pragma once
 #include "CommonDef.h"
 #include "ContextModel.h"
+#include "ContextModelDualRate.h"
 #include "assert.h"
+#include <vector>
 #include "mex.h"
 #include "matrix.h"
-#if RWTH_TRACE_CABAC_STATES
-#include <cstdio>
 
-#endif
+/// the probability estimation of the contexts
+enum CABAC_ProbabilityModel
+{
+  CABAC_PROB_HEVC,       ///< ContextModel, the 64 state machine of HEVC
+  CABAC_PROB_DUAL_RATE   ///< ContextModelDualRate, two 15 bit estimates with different window sizes
+};
 
 // this class containts all our context models for the encoder and decoder
+// the models are allocated by the initialization functions, so their number is only limited by the memory.
+// As a ContextModel is only its combined state byte, the states of all contexts are contiguous. 
+// The initial states are kept in a separate array, which is only read by resetContextModels.
+// The number of bins coded per context is counted by CABAC_Trace if enabled.
+// Initialized by probability, the contexts can use ContextModelDualRate instead. The coders 
+// then use getDualRateModel() (see getModel()), the functions for copying the contexts are 
+// only available for ContextModel, except for getDualRateModels.
 class CABAC_ContextModels {
 
 public:
@@ -52,25 +64,45 @@ public:
   // this method initializes all contexts, given a matlab array in the form of A=[ctxIdx0,mps0,state0,ctxIdx1,mps1,state1,...]
   // 
   void initContextModelsByMpsState(int maxNumContextModels, const mxArray* ptr);
-  void initContextModelsByP0Prob(int maxNumContextModels, const mxArray* ptr);
+  void initContextModelsByP0Prob(int maxNumContextModels, const mxArray* ptr, CABAC_ProbabilityModel eModel = CABAC_PROB_HEVC);
 
-  // TODO: write a context model initialization function which maps a propability estimate to the respective state
+  // map the probability p0 of a 0 bin to the closest MPS and state, as done by initContextModelsByP0Prob
+  static void mapProbabilityToState(double p0, int& mps, int& state);
   // TODO: error handling
-  // TODO: dynamic allocation of context models
+
+  // set all contexts back to the state of the last initialization
+  void resetContextModels();
+  // copies of all contexts in the state of the last initialization, e.g. for coding substreams
+  void getInitContextModels(std::vector<ContextModel> &models) const;
+  // copy the current contexts out of / back into the models
+  void getContextModels(std::vector<ContextModel> &models) const { models = m_contextModels; };
+  void setContextModels(const std::vector<ContextModel> &models) { assert((int)models.size() == m_maxNumContextModels); m_contextModels = models; };
+  void getDualRateModels(std::vector<ContextModelDualRate> &models) const { models = m_dualRateModels; };
   
   // getter function for a context model used by encoder and decoder
   ContextModel* getContextModel(int ctxIdx) { return &m_contextModels[ctxIdx]; };
-#if RWTH_TRACE_CABAC_STATES && RWTH_TRACE_CABAC_TO_FILE
-  void writeCompleteTraces(FILE* TraceCabacStatFile);
-#endif
+  ContextModelDualRate* getDualRateModel(int ctxIdx) { return &m_dualRateModels[ctxIdx]; };
+  // getContextModel or getDualRateModel, selected by the model class
+  template <class TModel> TModel* getModel(int ctxIdx);
+  CABAC_ProbabilityModel getProbabilityModel() const { return m_eProbabilityModel; };
+  // number of context models set up by the last initialization
+  int getNumContextModels() { return m_maxNumContextModels; };
 
 private:
   // total number of contexts we use
-  // TODO: use this for dynamic allocation of m_contextModels
   int m_maxNumContextModels;
 
-  // ContextModel container
-  ContextModel m_contextModels[RWTH_MAX_NUM_CONTEXTS];
-  void xMapProbabilityToState(double p0, int& mps, int& state);
+  // ContextModel container, one state byte per context
+  std::vector<ContextModel> m_contextModels;
+  // the initial combined states (state << 1) + MPS
+  std::vector<unsigned char> m_aucInitStateIdx;
+  // the contexts and their initialization for CABAC_PROB_DUAL_RATE
+  CABAC_ProbabilityModel m_eProbabilityModel;
+  std::vector<ContextModelDualRate> m_dualRateModels;
+  std::vector<ContextModelDualRate> m_dualRateInitModels;
+  void xAllocate(int maxNumContextModels);
+
+};
 
-};
\ No newline at end of file
+template <> inline ContextModel* CABAC_ContextModels::getModel<ContextModel>(int ctxIdx) { return getContextModel(ctxIdx); }
+template <> inline ContextModelDualRate* CABAC_ContextModels::getModel<ContextModelDualRate>(int ctxIdx) { return getDualRateModel(ctxIdx); }
\ No newline at end of file
@@ -0,0 +1,120 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+#include <vector>
+#include <string.h>
+#include "CABAC_BitstreamMemory.h"
+#include "CABAC_ContextModelsInit.h"
+
+/** Snapshot of an encoder writing into a CABAC_BitstreamMemory
+  *
+  * Holds the engine registers, the states of all contexts and the output position, so that 
+  * alternatives (e.g. two binarizations of a column) can be coded one after the other from the
+  * same state: save() before the first trial, restore() before the next one, and restore() the
+  * snapshot of the chosen one to continue with it. Saving copies one byte per context, restoring
+  * truncates the output, the bytes before the position are kept.
+  *
+  * A snapshot stays valid as long as the output is not truncated in front of its position, i.e. 
+  * restoring a snapshot invalidates all snapshots taken later. The snapshot can be serialized 
+  * into a byte array with write() / read().
+  */
+template <class TEncoder>
+class TCABAC_EncoderCheckpoint
+{
+public:
+  TCABAC_EncoderCheckpoint() {}
+  ~TCABAC_EncoderCheckpoint() {}
+
+  void save(const TEncoder &rEncoder, const CABAC_BitstreamMemory &rBitstream, const CABAC_ContextModels &rModels)
+  {
+    rEncoder.checkpoint(m_engine);
+    m_position = rBitstream.getWritePosition();
+    rModels.getContextModels(m_contexts);
+  }
+
+  /// returns false (and changes nothing) if the snapshot does not fit the bitstream and the contexts
+  bool restore(TEncoder &rEncoder, CABAC_BitstreamMemory &rBitstream, CABAC_ContextModels &rModels) const
+  {
+    if (m_position.uiNumBytes > rBitstream.getNumBytes() || (int)m_contexts.size() != rModels.getNumContextModels())
+    {
+      return false;
+    }
+    rBitstream.truncate(m_position);
+    rEncoder.restore(m_engine);
+    rModels.setContextModels(m_contexts);
+    return true;
+  }
+
+  size_t getNumContextModels() const { return m_contexts.size(); }
+
+  /// size of the serialized snapshot
+  size_t getNumBytes() const { return sizeof(m_engine) + sizeof(m_position) + m_contexts.size(); }
+  void write(unsigned char *pData) const
+  {
+    memcpy(pData, &m_engine, sizeof(m_engine));
+    memcpy(pData + sizeof(m_engine), &m_position, sizeof(m_position));
+    pData += sizeof(m_engine) + sizeof(m_position);
+    for (size_t i = 0; i < m_contexts.size(); i++)
+    {
+      pData[i] = m_contexts[i].getStateIdx();
+    }
+  }
+  /// read a snapshot written by write(), returns false if the size does not match
+  bool read(const unsigned char *pData, size_t uiNumBytes)
+  {
+    const size_t uiHeaderBytes = sizeof(m_engine) + sizeof(m_position);
+    if (uiNumBytes < uiHeaderBytes)
+    {
+      return false;
+    }
+    memcpy(&m_engine, pData, sizeof(m_engine));
+    memcpy(&m_position, pData + sizeof(m_engine), sizeof(m_position));
+    m_contexts.resize(uiNumBytes - uiHeaderBytes);
+    for (size_t i = 0; i < m_contexts.size(); i++)
+    {
+      if (pData[uiHeaderBytes + i] >= 128)
+      {
+        return false;
+      }
+      m_contexts[i].updateStateIdx(pData[uiHeaderBytes + i]);
+    }
+    return true;
+  }
+
+protected:
+  typename TEncoder::State        m_engine;
+  CABAC_BitstreamMemory::Position m_position;
+  std::vector<ContextModel>       m_contexts;
+};
@@ -0,0 +1,122 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "CABAC_MatrixCoder.h"
+#include <string.h>
+
+CABAC_MatrixCoder::CABAC_MatrixCoder()
+  : m_iNlbp(0)
+  , m_uiTypes(0)
+  , m_bColumnStart(true)
+  , m_iUpNumBins(0)
+  , m_iUpPrefixLength(0)
+{
+  startColumn();
+}
+
+CABAC_MatrixCoder::~CABAC_MatrixCoder()
+{
+}
+
+bool CABAC_MatrixCoder::init(const char *cMethod, unsigned int uiNq, int iNlbp)
+{
+  m_iNlbp = iNlbp;
+  m_uiTypes = 0;
+  startColumn();
+  return iNlbp >= 0 && m_binarizer.init(cMethod, uiNq);
+}
+
+bool CABAC_MatrixCoder::addContextModelType(const char *cType)
+{
+  static const char *s_names[] = { "cond0", "cond1", "condbinlft", "conds0", "conds1" };
+  for (int i = 0; i < 5; i++)
+  {
+    if (!strcmp(cType, s_names[i]))
+    {
+      m_uiTypes |= 1u << i;
+      return true;
+    }
+  }
+  return false;
+}
+
+void CABAC_MatrixCoder::startColumn()
+{
+  static const CABAC_Codeword s_empty = { 0, 0, 0, 0 };
+  m_bColumnStart = true;
+  m_cur = s_empty;
+  m_up = s_empty;
+  m_iUpNumBins = 0;
+  m_iUpPrefixLength = 0;
+}
+
+void CABAC_MatrixCoder::startValue()
+{
+  static const CABAC_Codeword s_empty = { 0, 0, 0, 0 };
+  if (!m_bColumnStart)
+  {
+    m_up = m_cur;
+    m_iUpNumBins = m_up.getNumBins();
+    m_iUpPrefixLength = m_up.getPrefixLength();
+  }
+  m_bColumnStart = false;
+  m_cur = s_empty;
+}
+
+int CABAC_MatrixCoder::setValue(const CABAC_Codeword &rCodeword)
+{
+  startValue();
+  m_cur = rCodeword;
+  const int numBins = rCodeword.getNumBins();
+  const int numOnes = (int)rCodeword.uiNumOnes;
+  const int iPrefixLength = rCodeword.getPrefixLength();
+  m_bins.resize(numBins);
+  m_ctxIdx.resize(numBins);
+  // the leading ones and the zero are coded in the prefix contexts
+  for (int n = 0; n < numOnes; n++)
+  {
+    m_bins[n] = 1;
+    m_ctxIdx[n] = getContext(n, 0);
+  }
+  if (rCodeword.ucZero)
+  {
+    m_bins[numOnes] = 0;
+    m_ctxIdx[numOnes] = getContext(numOnes, 0);
+  }
+  for (int n = numOnes + rCodeword.ucZero; n < numBins; n++)
+  {
+    m_bins[n] = (uint8_t)((rCodeword.uiSuffix >> (numBins - 1 - n)) & 1);
+    m_ctxIdx[n] = getContext(n, iPrefixLength);
+  }
+  return numBins;
+}
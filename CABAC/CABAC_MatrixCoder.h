@@ -0,0 +1,196 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+#include "CABAC_Binarizer.h"
+
+/** Binarization and context selection of a matrix of quantization indices
+  *
+  * Reproduces the per-bin logic of cabacEncode.m: every column k is coded from top to bottom,
+  * every value is binarized by CABAC_Binarizer and the context of each bin is selected like 
+  * in cabacContextSelection.m from the bins before it and the bin string of the value above 
+  * (upper neighbor). The context indices are 0-based, i.e. the MATLAB ID minus 1:
+  *
+  *   prefix:  ctx_n 0...N-1, ctx_n,up0 N...2N-1, ctx_n,up1 2N...3N-1, ctx_n,le1 3N...4N-1, ctx_rst 7N
+  *   suffix:  ctx_n 4N...5N-1, ctx_n,up0 5N...6N-1, ctx_n,up1 6N...7N-1, ctx_rst 7N+1
+  *
+  * with N = Nlbp. The conditional contexts are only used if their type was added.
+  *
+  * The encoder calls setValue() with the bin string of every value. The decoder calls 
+  * startValue() and then decodes one bin after another with the context getNextContext()
+  * until addBin() reports the bin string as complete, decodeValues() does this for a range of
+  * values. A column only depends on the values above it, so copies of a coder can decode 
+  * different columns in parallel.
+  */
+class CABAC_MatrixCoder
+{
+public:
+  /// the context model types of cmTypes
+  enum
+  {
+    CM_COND0      = 1,   ///< 'cond0', prefix bin with upper bin 0
+    CM_COND1      = 2,   ///< 'cond1', prefix bin with upper bin 1
+    CM_CONDBINLFT = 4,   ///< 'condbinlft', prefix bin after a one, if the upper bin is not in the prefix
+    CM_CONDS0     = 8,   ///< 'conds0', suffix bin with upper bin 0
+    CM_CONDS1     = 16   ///< 'conds1', suffix bin with upper bin 1
+  };
+
+  CABAC_MatrixCoder();
+  ~CABAC_MatrixCoder();
+
+  /// set the binarization and the number of bins with their own contexts, no types are set
+  bool init(const char *cMethod, unsigned int uiNq, int iNlbp);
+  /// add a type of cmTypes by its name, returns false for an unknown type
+  bool addContextModelType(const char *cType);
+
+  const CABAC_Binarizer& getBinarizer() const { return m_binarizer; }
+  int getNlbp() const { return m_iNlbp; }
+  /// the CM_* flags of the added types
+  unsigned int getContextModelTypes() const { return m_uiTypes; }
+  int getNumContextModels() const { return 7 * m_iNlbp + 2; }
+
+  /// start a new column, the next value has no upper neighbor
+  void startColumn();
+  /// set the bin string of the next value of the current column and select the contexts of 
+  /// its bins, the last value becomes the upper neighbor. Returns the number of bins.
+  int setValue(const CABAC_Codeword &rCodeword);
+  /// setValue() with the bin string of uiValue
+  int binarize(unsigned int uiValue) { return setValue(m_binarizer.getCodeword(uiValue)); }
+  const uint8_t* getBins() const { return m_bins.empty() ? NULL : &m_bins[0]; }
+  const int32_t* getContexts() const { return m_ctxIdx.empty() ? NULL : &m_ctxIdx[0]; }
+
+  /// start decoding the next value of the current column, the last value becomes the upper neighbor
+  void startValue();
+  /// context of the next bin of the current value
+  int getNextContext() const { return getContext(m_cur.getNumBins(), m_cur.getPrefixLength()); }
+  /// append a decoded bin, returns true if the bin string of the current value is complete
+  inline bool addBin(unsigned int uiBin)
+  {
+    if (!m_cur.ucZero && m_cur.uiNumOnes < m_binarizer.getMaxOnes())
+    {
+      m_cur.uiNumOnes += uiBin;
+      m_cur.ucZero = 1 - uiBin;
+    }
+    else
+    {
+      m_cur.uiSuffix = (m_cur.uiSuffix << 1) | uiBin;
+      m_cur.ucNumSuffix++;
+    }
+    return m_binarizer.isComplete(m_cur);
+  }
+  /// the value of the complete bin string of the current value
+  unsigned int getValue() const { return m_binarizer.getValue(m_cur); }
+  /// decode the next numValues values of the current column with rDecoder, the bins are
+  /// decoded with the contexts models (indexed like getContext())
+  template <class TDecoder, class TModel>
+  void decodeValues(TDecoder &rDecoder, TModel *models, size_t numValues, unsigned int *values)
+  {
+    for (size_t d = 0; d < numValues; d++)
+    {
+      unsigned int uiBin = 0;
+      startValue();
+      do
+      {
+        rDecoder.decodeBin(uiBin, &models[getNextContext()]);
+      } while (!addBin(uiBin));
+      values[d] = getValue();
+    }
+  }
+
+  /// context of bin n (0-based) of the current value, iPrefixLength is the position of the
+  /// first zero (1-based) among the bins before n or 0 if they are all ones
+  inline int getContext(int n, int iPrefixLength) const
+  {
+    const int N = n + 1;  // position as in cabacContextSelection.m
+    const int L = m_iNlbp;
+    const bool bUp = N <= m_iUpNumBins;
+    const bool bUpPrefix = m_iUpPrefixLength == 0 || N <= m_iUpPrefixLength;
+    if (iPrefixLength == 0)
+    {
+      if (N > L)
+      {
+        return 7 * L;
+      }
+      if (bUp && bUpPrefix)
+      {
+        if (m_up.getBin(n) == 0)
+        {
+          if (m_uiTypes & CM_COND0) { return L + n; }
+        }
+        else if (m_uiTypes & CM_COND1)
+        {
+          return 2 * L + n;
+        }
+      }
+      else if (N > 1 && (m_uiTypes & CM_CONDBINLFT))
+      {
+        // all bins before n are ones in the prefix
+        return 3 * L + n - 1;
+      }
+      return n;
+    }
+    const int s = N - iPrefixLength;
+    if (s > L)
+    {
+      return 7 * L + 1;
+    }
+    if (bUp && !bUpPrefix)
+    {
+      if (m_up.getBin(n) == 0)
+      {
+        if (m_uiTypes & CM_CONDS0) { return 5 * L + s - 1; }
+      }
+      else if (m_uiTypes & CM_CONDS1)
+      {
+        return 6 * L + s - 1;
+      }
+    }
+    return 4 * L + s - 1;
+  }
+
+protected:
+  CABAC_Binarizer      m_binarizer;
+  int                  m_iNlbp;
+  unsigned int         m_uiTypes;          ///< CM_* flags
+  bool                 m_bColumnStart;     ///< no value coded in the current column yet
+  CABAC_Codeword       m_cur;              ///< bin string of the current value
+  CABAC_Codeword       m_up;               ///< bin string of the upper neighbor
+  int                  m_iUpNumBins;       ///< bins of m_up, 0 at the start of a column
+  int                  m_iUpPrefixLength;  ///< position of the first zero in m_up, 0 if none
+  std::vector<uint8_t> m_bins;             ///< bins of m_cur for the encoder
+  std::vector<int32_t> m_ctxIdx;           ///< contexts of m_bins
+};
@@ -0,0 +1,108 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+#include <stdint.h>
+#include "ContextModel.h"
+
+/** Estimates the size of a bitstream without arithmetic coding
+  *
+  * Has the encoding interface of TCABAC_ArithmeticEncoder64, but instead of coding a bin 
+  * it adds its entropy from ContextModel::getEntropyBits() to a counter in 1/32768 bits and 
+  * updates the context state like the encoder. Nothing is written. The estimate differs
+  * from the coded size only by the rounding of the range and the termination of the
+  * bitstream, which finish() adds as a constant.
+  */
+class CABAC_RateEstimator
+{
+public:
+  CABAC_RateEstimator() : m_uiFracBits(0), m_uiBinsCoded(0), m_pTransitions(xGetTransitions()) {}
+  ~CABAC_RateEstimator() {}
+
+  void  start           () { m_uiFracBits = 0; m_uiBinsCoded = 0; }
+  /// the terminating bin, the flush of the low register and the alignment
+  void  finish          () { m_uiFracBits += (uint64_t)sm_iTerminationBits << 15; }
+
+  inline void encodeBin ( unsigned int binValue, ContextModel *rcCtxModel )
+  {
+    m_uiBinsCoded++;
+    const Transition &t = m_pTransitions[ ( rcCtxModel->getStateIdx() << 1 ) | binValue ];
+    m_uiFracBits += t.uiFracBits;
+    rcCtxModel->updateStateIdx( t.ucNextStateIdx );
+  }
+  void  encodeBinEP     ( unsigned int /*binValue*/ )               { m_uiBinsCoded++; m_uiFracBits += 1 << 15; }
+  void  encodeBinsEP    ( unsigned int /*binValues*/, int numBins ) { m_uiBinsCoded += numBins; m_uiFracBits += (uint64_t)numBins << 15; }
+
+  unsigned int getBinsCoded() const { return m_uiBinsCoded; }
+  /// the estimated size in 1/32768 bits
+  uint64_t getFracBits() const { return m_uiFracBits; }
+  /// the estimated size in bits
+  double getNumBits() const { return m_uiFracBits / 32768.0; }
+
+protected:
+  static const int sm_iTerminationBits = 12;  ///< the mean difference to the coded size of short streams
+
+  /// the cost and the next state of coding a bin, so that encodeBin() does not branch on the MPS
+  struct Transition
+  {
+    uint32_t      uiFracBits;
+    unsigned char ucNextStateIdx;
+  };
+  /// the transitions indexed by ( ( state << 1 ) + MPS ) << 1 | bin
+  static const Transition* xGetTransitions()
+  {
+    static struct Table
+    {
+      Transition a[256];
+      Table()
+      {
+        ContextModel ctx;
+        for ( int i = 0; i < 256; i++ )
+        {
+          unsigned char ucStateIdx = (unsigned char)( i >> 1 );
+          unsigned int  uiBin = i & 1;
+          ctx.updateStateIdx( ucStateIdx );
+          a[i].uiFracBits = ctx.getEntropyBits( (short)uiBin );
+          a[i].ucNextStateIdx = ( uiBin == (unsigned int)( ucStateIdx & 1 ) ) ? ContextModel::getNextStateIdxMPS( ucStateIdx ) 
+                                                                             : ContextModel::getNextStateIdxLPS( ucStateIdx );
+        }
+      }
+    } s_table;
+    return s_table.a;
+  }
+
+  uint64_t          m_uiFracBits;
+  unsigned int      m_uiBinsCoded;
+  const Transition *m_pTransitions;
+};
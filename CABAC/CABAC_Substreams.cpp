@@ -0,0 +1,190 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "CABAC_Substreams.h"
+#include "CABAC_ArithmeticEncoder64.h"
+#include "CABAC_ArithmeticDecoder.h"
+#include "CABAC_BitstreamMemory.h"
+#include <string.h>
+
+static uint32_t xReadUInt32(const unsigned char *p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void xWriteUInt32(unsigned char *p, uint32_t value)
+{
+  p[0] = (unsigned char)(value >> 24);
+  p[1] = (unsigned char)(value >> 16);
+  p[2] = (unsigned char)(value >> 8);
+  p[3] = (unsigned char)value;
+}
+
+CABAC_Substreams::CABAC_Substreams()
+  : m_pPayload(NULL)
+{
+}
+
+CABAC_Substreams::~CABAC_Substreams()
+{
+}
+
+bool CABAC_Substreams::parse(const unsigned char *pData, size_t uiLength)
+{
+  m_pPayload = NULL;
+  m_auiOffset.clear();
+  if (uiLength < 4)
+  {
+    return false;
+  }
+  uint32_t numSubstreams = xReadUInt32(pData);
+  if (numSubstreams == 0 || numSubstreams > uiLength / 4 || getTableSize(numSubstreams) > uiLength)
+  {
+    return false;
+  }
+  m_pPayload = pData + getTableSize(numSubstreams);
+  size_t uiPayloadLength = uiLength - getTableSize(numSubstreams);
+  m_auiOffset.push_back(0);
+  for (uint32_t i = 1; i < numSubstreams; i++)
+  {
+    size_t uiOffset = xReadUInt32(pData + 4 * i);
+    if (uiOffset < m_auiOffset.back() || uiOffset > uiPayloadLength)
+    {
+      m_auiOffset.clear();
+      return false;
+    }
+    m_auiOffset.push_back(uiOffset);
+  }
+  m_auiOffset.push_back(uiPayloadLength);
+  return true;
+}
+
+void CABAC_Substreams::decode(CABAC_ThreadPool &pool, const std::vector<ContextModel> &initModels, 
+                              const int32_t *ctxIdx, const std::vector<size_t> &firstBin, uint8_t *bins) const
+{
+  assert((int)firstBin.size() == getNumSubstreams() + 1);
+  pool.run(getNumSubstreams(), [&](int i)
+  {
+    CABAC_BitstreamMemory stream;
+    stream.openInput(getSubstreamData(i), getSubstreamLength(i));
+    CABAC_ArithmeticDecoderMemory decoder(&stream);
+    std::vector<ContextModel> models(initModels);
+    decoder.start();
+    for (size_t j = firstBin[i]; j < firstBin[i + 1]; j++)
+    {
+      unsigned int uiBin = 0;
+      decoder.decodeBin(uiBin, &models[ctxIdx[j]]);
+      bins[j] = (uint8_t)uiBin;
+    }
+    decoder.finish();
+  });
+}
+
+void CABAC_Substreams::decodeMatrix(CABAC_ThreadPool &pool, const std::vector<ContextModel> &initModels, 
+                                    const CABAC_MatrixCoder &coder, size_t numRows, 
+                                    const std::vector<size_t> &firstCol, unsigned int *values) const
+{
+  assert((int)firstCol.size() == getNumSubstreams() + 1 && !initModels.empty());
+  pool.run(getNumSubstreams(), [&](int i)
+  {
+    CABAC_BitstreamMemory stream;
+    stream.openInput(getSubstreamData(i), getSubstreamLength(i));
+    CABAC_ArithmeticDecoderMemory decoder(&stream);
+    CABAC_MatrixCoder columnCoder(coder);
+    std::vector<ContextModel> models(initModels);
+    decoder.start();
+    for (size_t k = firstCol[i]; k < firstCol[i + 1]; k++)
+    {
+      columnCoder.startColumn();
+      columnCoder.decodeValues(decoder, &models[0], numRows, values + k * numRows);
+    }
+    decoder.finish();
+  });
+}
+
+void CABAC_Substreams::encode(CABAC_ThreadPool &pool, const std::vector<ContextModel> &initModels, 
+                              const uint8_t *bins, const int32_t *ctxIdx, const std::vector<size_t> &firstBin,
+                              std::vector<unsigned char> &rOut, std::vector<size_t> *pSubstreamBytes)
+{
+  assert(firstBin.size() >= 2);
+  int numSubstreams = (int)firstBin.size() - 1;
+  std::vector<CABAC_BitstreamMemory> streams(numSubstreams);
+  pool.run(numSubstreams, [&](int i)
+  {
+    CABAC_ArithmeticEncoder64Memory encoder(&streams[i]);
+    std::vector<ContextModel> models(initModels);
+    streams[i].openOutput((firstBin[i + 1] - firstBin[i]) / 8);
+    encoder.start();
+    for (size_t j = firstBin[i]; j < firstBin[i + 1]; j++)
+    {
+      encoder.encodeBin(bins[j], &models[ctxIdx[j]]);
+    }
+    encoder.finish();
+  });
+  pack(streams, rOut, pSubstreamBytes);
+}
+
+void CABAC_Substreams::pack(const std::vector<CABAC_BitstreamMemory> &streams, 
+                            std::vector<unsigned char> &rOut, std::vector<size_t> *pSubstreamBytes)
+{
+  int numSubstreams = (int)streams.size();
+  // entry point table, then the substreams
+  size_t uiTotal = getTableSize(numSubstreams);
+  for (int i = 0; i < numSubstreams; i++)
+  {
+    uiTotal += streams[i].getNumBytes();
+  }
+  rOut.resize(uiTotal);
+  xWriteUInt32(&rOut[0], (uint32_t)numSubstreams);
+  size_t uiPos = getTableSize(numSubstreams);
+  for (int i = 0; i < numSubstreams; i++)
+  {
+    if (i > 0)
+    {
+      xWriteUInt32(&rOut[4 * i], (uint32_t)(uiPos - getTableSize(numSubstreams)));
+    }
+    if (streams[i].getNumBytes() > 0)
+    {
+      memcpy(&rOut[uiPos], streams[i].getData(), streams[i].getNumBytes());
+    }
+    uiPos += streams[i].getNumBytes();
+  }
+  if (pSubstreamBytes)
+  {
+    pSubstreamBytes->resize(numSubstreams);
+    for (int i = 0; i < numSubstreams; i++)
+    {
+      (*pSubstreamBytes)[i] = streams[i].getNumBytes();
+    }
+  }
+}
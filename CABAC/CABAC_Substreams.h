@@ -0,0 +1,98 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+#include "ContextModel.h"
+#include "CABAC_BitstreamMemory.h"
+#include "CABAC_ThreadPool.h"
+#include "CABAC_MatrixCoder.h"
+
+/** Independent substreams with an entry point table
+  *
+  * The bins are split into N substreams. Each substream is coded by its own arithmetic coder 
+  * with its own copy of the initial context states and is finished on its own, so the 
+  * substreams can be encoded and decoded in parallel. The coded substreams are stored one 
+  * after another behind an entry point table:
+  *
+  *   number of substreams N                       4 bytes
+  *   byte offset of the substreams 1...N-1        4 bytes each, relative to the first substream
+  *   substreams 0...N-1
+  *
+  * All values are big endian. firstBin holds the index of the first bin of every substream 
+  * followed by the total number of bins (N + 1 entries), substream i codes the bins 
+  * firstBin[i] ... firstBin[i + 1] - 1.
+  */
+class CABAC_Substreams
+{
+public:
+  CABAC_Substreams();
+  ~CABAC_Substreams();
+
+  /// read the entry point table of a coded buffer, the buffer has to stay valid while decoding
+  bool parse(const unsigned char *pData, size_t uiLength);
+
+  int getNumSubstreams() const { return (int)m_auiOffset.size() - 1; }
+  const unsigned char* getSubstreamData(int i) const { return m_pPayload + m_auiOffset[i]; }
+  size_t getSubstreamLength(int i) const { return m_auiOffset[i + 1] - m_auiOffset[i]; }
+
+  /// decode the substreams of the last parse() in parallel, bin j is decoded from context ctxIdx[j]
+  void decode(CABAC_ThreadPool &pool, const std::vector<ContextModel> &initModels, 
+              const int32_t *ctxIdx, const std::vector<size_t> &firstBin, uint8_t *bins) const;
+  /// decode the substreams of the last parse() in parallel into the columns of a matrix with
+  /// numRows rows (column by column), substream i holds the columns firstCol[i] ... firstCol[i + 1] - 1
+  /// and is decoded by a copy of coder
+  void decodeMatrix(CABAC_ThreadPool &pool, const std::vector<ContextModel> &initModels, 
+                    const CABAC_MatrixCoder &coder, size_t numRows, 
+                    const std::vector<size_t> &firstCol, unsigned int *values) const;
+
+  /// encode the substreams in parallel and write them with the entry point table to rOut,
+  /// the size of every coded substream is returned in pSubstreamBytes if given
+  static void encode(CABAC_ThreadPool &pool, const std::vector<ContextModel> &initModels, 
+                     const uint8_t *bins, const int32_t *ctxIdx, const std::vector<size_t> &firstBin,
+                     std::vector<unsigned char> &rOut, std::vector<size_t> *pSubstreamBytes = NULL);
+
+  /// write the entry point table and the coded substreams to rOut, see encode()
+  static void pack(const std::vector<CABAC_BitstreamMemory> &streams, 
+                   std::vector<unsigned char> &rOut, std::vector<size_t> *pSubstreamBytes = NULL);
+
+  /// size of the entry point table in bytes
+  static size_t getTableSize(int numSubstreams) { return 4 * (size_t)numSubstreams; }
+
+protected:
+  const unsigned char *m_pPayload;
+  std::vector<size_t>  m_auiOffset;  ///< start of every substream in m_pPayload and the end of the last one
+};
@@ -0,0 +1,139 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "CABAC_ThreadPool.h"
+
+CABAC_ThreadPool::CABAC_ThreadPool()
+  : m_pTask(NULL)
+  , m_numTasks(0)
+  , m_nextTask(0)
+  , m_numBusy(0)
+  , m_uiRun(0)
+  , m_bStop(false)
+{
+}
+
+CABAC_ThreadPool::~CABAC_ThreadPool()
+{
+  xStop();
+}
+
+void CABAC_ThreadPool::init(int numThreads)
+{
+  if (numThreads <= 0)
+  {
+    numThreads = (int)std::thread::hardware_concurrency();
+  }
+  numThreads = (numThreads > 0) ? numThreads : 1;
+  if (numThreads == getNumThreads())
+  {
+    return;
+  }
+  xStop();
+  m_bStop = false;
+  for (int i = 1; i < numThreads; i++)
+  {
+    m_workers.push_back(std::thread(&CABAC_ThreadPool::xWorker, this, m_uiRun));
+  }
+}
+
+void CABAC_ThreadPool::run(int numTasks, const std::function<void(int)> &task)
+{
+  if (m_workers.empty() || numTasks <= 1)
+  {
+    for (int i = 0; i < numTasks; i++)
+    {
+      task(i);
+    }
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pTask = &task;
+    m_numTasks = numTasks;
+    m_nextTask = 0;
+    m_numBusy = (int)m_workers.size();
+    m_uiRun++;
+  }
+  m_start.notify_all();
+  xRunTasks();
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_done.wait(lock, [this] { return m_numBusy == 0; });
+  m_pTask = NULL;
+}
+
+void CABAC_ThreadPool::xStop()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bStop = true;
+  }
+  m_start.notify_all();
+  for (size_t i = 0; i < m_workers.size(); i++)
+  {
+    m_workers[i].join();
+  }
+  m_workers.clear();
+}
+
+/// uiLastRun is the run counter when the worker was created, so it only takes part in later runs
+void CABAC_ThreadPool::xWorker(unsigned int uiLastRun)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true)
+  {
+    m_start.wait(lock, [&] { return m_bStop || m_uiRun != uiLastRun; });
+    if (m_bStop)
+    {
+      return;
+    }
+    uiLastRun = m_uiRun;
+    lock.unlock();
+    xRunTasks();
+    lock.lock();
+    if (--m_numBusy == 0)
+    {
+      m_done.notify_one();
+    }
+  }
+}
+
+/// take tasks until all are started
+void CABAC_ThreadPool::xRunTasks()
+{
+  int i;
+  while ((i = m_nextTask++) < m_numTasks)
+  {
+    (*m_pTask)(i);
+  }
+}
@@ -0,0 +1,77 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/** A fixed pool of worker threads for coding independent substreams
+  *
+  * run() hands the tasks 0...numTasks-1 to the workers and the calling thread and returns 
+  * when all of them are done. The workers are created by init() and wait for the next run() 
+  * in between, so repeated calls do not create threads. Tasks must not throw and must not 
+  * call the MEX API, as they may run on a worker thread.
+  */
+class CABAC_ThreadPool
+{
+public:
+  CABAC_ThreadPool();
+  ~CABAC_ThreadPool();
+
+  /// start numThreads - 1 workers (the calling thread is the last one), 0 uses all cores
+  void init(int numThreads);
+  int getNumThreads() const { return (int)m_workers.size() + 1; }
+
+  void run(int numTasks, const std::function<void(int)> &task);
+
+protected:
+  void xStop();
+  void xWorker(unsigned int uiLastRun);
+  void xRunTasks();
+
+  std::vector<std::thread>  m_workers;
+  std::mutex                m_mutex;
+  std::condition_variable   m_start;
+  std::condition_variable   m_done;
+  const std::function<void(int)> *m_pTask;
+  int                       m_numTasks;
+  std::atomic<int>          m_nextTask;
+  int                       m_numBusy;     ///< workers still working on the current run
+  unsigned int              m_uiRun;       ///< incremented for every run, wakes the workers
+  bool                      m_bStop;
+};
@@ -0,0 +1,129 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "CABAC_Trace.h"
+#include <string.h>
+
+CABAC_Trace::CABAC_Trace()
+  : m_mode(CABAC_TRACE_OFF)
+  , m_uiRingSize(0)
+  , m_uiSampleInterval(1)
+{
+}
+
+CABAC_Trace::~CABAC_Trace()
+{
+}
+
+void CABAC_Trace::init(int numContexts, CABAC_TraceMode mode, size_t uiRingSize, unsigned int uiSampleInterval)
+{
+  assert(numContexts >= 0 && uiSampleInterval > 0);
+  m_mode = mode;
+  m_uiRingSize = uiRingSize;
+  m_uiSampleInterval = uiSampleInterval;
+  m_contexts.clear();
+  if (m_mode != CABAC_TRACE_OFF)
+  {
+    m_contexts.resize(numContexts);
+  }
+  reset();
+}
+
+void CABAC_Trace::reset()
+{
+  for (size_t k = 0; k < m_contexts.size(); k++)
+  {
+    ContextTrace &t = m_contexts[k];
+    memset(t.transitionCount, 0, sizeof(t.transitionCount));
+    t.ring.clear();
+    t.ringPos = 0;
+    t.numSteps = 0;
+  }
+}
+
+void CABAC_Trace::xAddToRing(ContextTrace &t, const CABACStep &step)
+{
+  if (m_uiRingSize == 0)
+  {
+    return;
+  }
+  if (t.ring.size() < m_uiRingSize)
+  {
+    t.ring.push_back(step);
+  }
+  else
+  {
+    t.ring[t.ringPos] = step;
+    t.ringPos = (t.ringPos + 1) % m_uiRingSize;
+  }
+}
+
+void CABAC_Trace::getSteps(int ctxIdx, std::vector<CABACStep> &steps) const
+{
+  const ContextTrace &t = m_contexts[ctxIdx];
+  // once the ring is full, ringPos points to the oldest step
+  steps.assign(t.ring.begin() + t.ringPos, t.ring.end());
+  steps.insert(steps.end(), t.ring.begin(), t.ring.begin() + t.ringPos);
+}
+
+void CABAC_Trace::getTransitions(int ctxIdx, unsigned int *puiMatrix) const
+{
+  const ContextTrace &t = m_contexts[ctxIdx];
+  memset(puiMatrix, 0, RWTH_TRACE_CABAC_STATES_NUM_STATES * RWTH_TRACE_CABAC_STATES_NUM_STATES * sizeof(unsigned int));
+  for (unsigned int uiState = 0; uiState < RWTH_TRACE_CABAC_STATES_NUM_STATES; uiState++)
+  {
+    unsigned char ucStateIdx = getStateIdx((uint8_t)uiState);
+    unsigned int *puiRow = puiMatrix + uiState * RWTH_TRACE_CABAC_STATES_NUM_STATES;
+    puiRow[getTraceState(ContextModel::getNextStateIdxMPS(ucStateIdx))] += (unsigned int)t.transitionCount[uiState][0];
+    puiRow[getTraceState(ContextModel::getNextStateIdxLPS(ucStateIdx))] += (unsigned int)t.transitionCount[uiState][1];
+  }
+}
+
+void CABAC_Trace::writeStateCounts(FILE *pOutFile) const
+{
+  for (size_t k = 0; k < m_contexts.size(); k++)
+  {
+    const ContextTrace &t = m_contexts[k];
+    // don't trace empty contexts
+    if (t.numSteps == 0)
+    {
+      continue;
+    }
+    fprintf(pOutFile, "ctxIdInternal, %i", (int)k);
+    for (unsigned int uiState = 0; uiState < RWTH_TRACE_CABAC_STATES_NUM_STATES; uiState++)
+    {
+      fprintf(pOutFile, ", %llu", (unsigned long long)(t.transitionCount[uiState][0] + t.transitionCount[uiState][1]));
+    }
+    fprintf(pOutFile, "\n");
+  }
+}
@@ -0,0 +1,144 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <stdint.h>
+#include <assert.h>
+#include "CommonDef.h"
+#include "ContextModel.h"
+
+/// One traced coding step: the coded bin and the trace states (see CABAC_Trace::getTraceState) before and after
+struct _CABACStep
+{
+  uint8_t codedBin;
+  uint8_t state_p;
+  uint8_t mps_p;
+  uint8_t state_a;
+  uint8_t mps_a;
+  _CABACStep() : codedBin(0), state_p(0), mps_p(0), state_a(0), mps_a(0) { }
+  _CABACStep(uint8_t c, uint8_t sp, uint8_t mp, uint8_t sa, uint8_t ma) :
+    codedBin(c), state_p(sp), mps_p(mp), state_a(sa), mps_a(ma)
+  { }
+};
+typedef struct _CABACStep CABACStep;
+
+/// What is recorded for the bins of a session
+enum CABAC_TraceMode
+{
+  CABAC_TRACE_OFF = 0,    ///< nothing, the coding loops do not touch the trace at all
+  CABAC_TRACE_COUNTERS,   ///< per context transition counters
+  CABAC_TRACE_STEPS       ///< counters plus the last (sampled) coding steps of each context in a ring buffer
+};
+
+/** The CABAC trace class
+  *
+  * Collects the state statistics of the context models of one encoder or decoder. The mode
+  * is chosen at runtime with init(). The coding loops are expected to branch on getMode() once 
+  * per call and not per bin (see SimpleCABACMex.cpp), so with CABAC_TRACE_OFF tracing costs 
+  * nothing. In CABAC_TRACE_STEPS mode, every uiSampleInterval-th step of a context is stored 
+  * in a ring buffer of uiRingSize steps, so the memory does not grow with the number of bins.
+  * As the state machine allows only two successors per state, the transitions are counted as
+  * one MPS and one LPS counter per state, the 128 x 128 transition matrix and the state
+  * histogram are derived from these counters on export.
+  */
+class CABAC_Trace
+{
+public:
+  CABAC_Trace();
+  ~CABAC_Trace();
+
+  void init(int numContexts, CABAC_TraceMode mode, size_t uiRingSize = 65536, unsigned int uiSampleInterval = 1);
+  void reset();   ///< clear the collected data, keep the mode
+
+  CABAC_TraceMode getMode() const { return m_mode; }
+  int getNumContexts() const { return (int)m_contexts.size(); }
+
+  /// record one coding step, ucStateIdxBefore/After are ContextModel::getStateIdx() before and after coding
+  void addStep(int ctxIdx, unsigned int uiBin, unsigned char ucStateIdxBefore, unsigned char ucStateIdxAfter)
+  {
+    assert(m_mode != CABAC_TRACE_OFF && ctxIdx >= 0 && ctxIdx < (int)m_contexts.size());
+    ContextTrace &t = m_contexts[ctxIdx];
+    uint8_t state_p = getTraceState(ucStateIdxBefore);
+    t.transitionCount[state_p][uiBin != (ucStateIdxBefore & 1u)]++;
+    if (m_mode == CABAC_TRACE_STEPS && (t.numSteps % m_uiSampleInterval) == 0)
+    {
+      xAddToRing(t, CABACStep((uint8_t)uiBin, state_p, ucStateIdxBefore & 1, getTraceState(ucStateIdxAfter), ucStateIdxAfter & 1));
+    }
+    t.numSteps++;
+  }
+
+  /// the recorded steps of a context, oldest first
+  void getSteps(int ctxIdx, std::vector<CABACStep> &steps) const;
+  /// the 128 x 128 transition counts of a context, puiMatrix[state_p * 128 + state_a] counts the transitions from trace state state_p to state_a
+  void getTransitions(int ctxIdx, unsigned int *puiMatrix) const;
+  /// how many bins were coded in a trace state
+  uint64_t getStateCount(int ctxIdx, int state) const 
+  { 
+    return m_contexts[ctxIdx].transitionCount[state][0] + m_contexts[ctxIdx].transitionCount[state][1]; 
+  }
+
+  /// write the state histograms of all used contexts, one line per context
+  void writeStateCounts(FILE *pOutFile) const;
+
+  /// Map (state << 1) + MPS to the trace state 0...127: 63-state for MPS 0, state+64 for MPS 1
+  static uint8_t getTraceState(unsigned char ucStateIdx)
+  {
+    unsigned int uiState = ucStateIdx >> 1;
+    return (uint8_t)((ucStateIdx & 1) ? uiState + 64 : 63 - uiState);
+  }
+  /// Inverse of getTraceState
+  static unsigned char getStateIdx(uint8_t uiTraceState)
+  {
+    return (unsigned char)((uiTraceState >= 64) ? ((uiTraceState - 64) << 1) + 1 : (63 - uiTraceState) << 1);
+  }
+
+protected:
+  struct ContextTrace
+  {
+    uint64_t transitionCount[RWTH_TRACE_CABAC_STATES_NUM_STATES][2]; ///< per trace state before coding: [0] MPS, [1] LPS coded
+    std::vector<CABACStep> ring;            ///< grows up to m_uiRingSize, then wraps around at ringPos
+    size_t   ringPos;
+    uint64_t numSteps;                      ///< number of traced bins
+  };
+
+  void xAddToRing(ContextTrace &t, const CABACStep &step);
+
+  CABAC_TraceMode m_mode;
+  size_t          m_uiRingSize;
+  unsigned int    m_uiSampleInterval;
+  std::vector<ContextTrace> m_contexts;
+};
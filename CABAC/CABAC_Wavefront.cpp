@@ -0,0 +1,173 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#include "CABAC_Wavefront.h"
+#include "CABAC_ArithmeticEncoder64.h"
+#include "CABAC_ArithmeticDecoder.h"
+#include "CABAC_BitstreamMemory.h"
+#include <algorithm>
+
+CABAC_Wavefront::CABAC_Wavefront(const std::vector<ContextModel> &initModels, int numColumns)
+  : m_initModels(initModels)
+  , m_abStored(numColumns, false)
+  , m_aContexts(numColumns)
+{
+}
+
+CABAC_Wavefront::~CABAC_Wavefront()
+{
+}
+
+void CABAC_Wavefront::getStartContexts(int k, std::vector<ContextModel> &models)
+{
+  if (k == 0)
+  {
+    models = m_initModels;
+    return;
+  }
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_changed.wait(lock, [&] { return m_abStored[k - 1]; });
+  models = m_aContexts[k - 1];
+}
+
+void CABAC_Wavefront::sync(int k, const std::vector<ContextModel> &models)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  xStoreContexts(k, models);
+  m_changed.notify_all();
+}
+
+void CABAC_Wavefront::finish(int k, const std::vector<ContextModel> &models)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // a column with less than syncRow rows passes its final contexts on
+  xStoreContexts(k, models);
+  m_changed.notify_all();
+}
+
+void CABAC_Wavefront::xStoreContexts(int k, const std::vector<ContextModel> &models)
+{
+  if (!m_abStored[k])
+  {
+    m_aContexts[k] = models;
+    m_abStored[k] = true;
+  }
+}
+
+void CABAC_Wavefront::encode(CABAC_ThreadPool &pool, const std::vector<ContextModel> &initModels, 
+                             const uint8_t *bins, const int32_t *ctxIdx, 
+                             const std::vector<size_t> &firstBin, const std::vector<size_t> &syncBin,
+                             std::vector<unsigned char> &rOut, std::vector<size_t> *pSubstreamBytes)
+{
+  assert(firstBin.size() >= 2 && syncBin.size() == firstBin.size() - 1);
+  int numColumns = (int)syncBin.size();
+  std::vector<CABAC_BitstreamMemory> streams(numColumns);
+  CABAC_Wavefront wavefront(initModels, numColumns);
+  pool.run(numColumns, [&](int k)
+  {
+    CABAC_ArithmeticEncoder64Memory encoder(&streams[k]);
+    std::vector<ContextModel> models;
+    wavefront.getStartContexts(k, models);
+    streams[k].openOutput((firstBin[k + 1] - firstBin[k]) / 8);
+    encoder.start();
+    for (size_t j = firstBin[k]; j < firstBin[k + 1]; j++)
+    {
+      if (j == syncBin[k])
+      {
+        wavefront.sync(k, models);
+      }
+      encoder.encodeBin(bins[j], &models[ctxIdx[j]]);
+    }
+    wavefront.finish(k, models);
+    encoder.finish();
+  });
+  CABAC_Substreams::pack(streams, rOut, pSubstreamBytes);
+}
+
+void CABAC_Wavefront::decode(CABAC_ThreadPool &pool, const std::vector<ContextModel> &initModels, 
+                             const CABAC_Substreams &substreams, const int32_t *ctxIdx, 
+                             const std::vector<size_t> &firstBin, const std::vector<size_t> &syncBin, uint8_t *bins)
+{
+  assert((int)syncBin.size() == substreams.getNumSubstreams() && firstBin.size() == syncBin.size() + 1);
+  int numColumns = (int)syncBin.size();
+  CABAC_Wavefront wavefront(initModels, numColumns);
+  pool.run(numColumns, [&](int k)
+  {
+    CABAC_BitstreamMemory stream;
+    stream.openInput(substreams.getSubstreamData(k), substreams.getSubstreamLength(k));
+    CABAC_ArithmeticDecoderMemory decoder(&stream);
+    std::vector<ContextModel> models;
+    wavefront.getStartContexts(k, models);
+    decoder.start();
+    for (size_t j = firstBin[k]; j < firstBin[k + 1]; j++)
+    {
+      if (j == syncBin[k])
+      {
+        wavefront.sync(k, models);
+      }
+      unsigned int uiBin = 0;
+      decoder.decodeBin(uiBin, &models[ctxIdx[j]]);
+      bins[j] = (uint8_t)uiBin;
+    }
+    wavefront.finish(k, models);
+    decoder.finish();
+  });
+}
+
+void CABAC_Wavefront::decodeMatrix(CABAC_ThreadPool &pool, const std::vector<ContextModel> &initModels, 
+                                   const CABAC_Substreams &substreams, const CABAC_MatrixCoder &coder, 
+                                   size_t numRows, size_t uiSyncRow, unsigned int *values)
+{
+  assert(!initModels.empty());
+  int numColumns = substreams.getNumSubstreams();
+  // a column with less than syncRow rows syncs at its end
+  const size_t uiSyncRows = std::min(uiSyncRow, numRows);
+  CABAC_Wavefront wavefront(initModels, numColumns);
+  pool.run(numColumns, [&](int k)
+  {
+    CABAC_BitstreamMemory stream;
+    stream.openInput(substreams.getSubstreamData(k), substreams.getSubstreamLength(k));
+    CABAC_ArithmeticDecoderMemory decoder(&stream);
+    CABAC_MatrixCoder columnCoder(coder);
+    std::vector<ContextModel> models;
+    unsigned int *column = values + k * numRows;
+    wavefront.getStartContexts(k, models);
+    decoder.start();
+    columnCoder.startColumn();
+    columnCoder.decodeValues(decoder, &models[0], uiSyncRows, column);
+    wavefront.sync(k, models);
+    columnCoder.decodeValues(decoder, &models[0], numRows - uiSyncRows, column + uiSyncRows);
+    wavefront.finish(k, models);
+    decoder.finish();
+  });
+}
@@ -0,0 +1,98 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+#include <mutex>
+#include <condition_variable>
+#include "ContextModel.h"
+#include "CABAC_Substreams.h"
+#include "CABAC_MatrixCoder.h"
+#include "CABAC_ThreadPool.h"
+
+/** Wavefront parallel coding of the columns of a matrix
+  *
+  * Every column is coded into its own substream behind the entry point table of 
+  * CABAC_Substreams. Like in the wavefront parallel processing of HEVC, column k + 1 does not 
+  * start with the initial contexts but with the contexts of column k after its first syncRow 
+  * rows. So column k + 1 can start as soon as column k has coded syncRow rows, and the 
+  * contexts still adapt across the columns.
+  *
+  * A column gets its start contexts with getStartContexts(), which waits for the column to 
+  * the left, and passes its contexts on with sync() when it reaches the sync row. The columns 
+  * have to be run in increasing order, e.g. by CABAC_ThreadPool::run(), so that every waiting
+  * column waits for a running one.
+  *
+  * encode() and decode() code bins with known context indices. firstBin holds the first bin 
+  * of every column followed by the total number of bins, syncBin[k] is the first bin of column
+  * k after the sync row (firstBin[k + 1] if the column has no more rows). decodeMatrix() 
+  * selects the contexts while decoding the values of a matrix like CABAC_MatrixCoder.
+  */
+class CABAC_Wavefront
+{
+public:
+  CABAC_Wavefront(const std::vector<ContextModel> &initModels, int numColumns);
+  ~CABAC_Wavefront();
+
+  /// the contexts column k starts with, waits until column k - 1 has reached the sync row
+  void getStartContexts(int k, std::vector<ContextModel> &models);
+  /// column k has reached the sync row, models are its current contexts
+  void sync(int k, const std::vector<ContextModel> &models);
+  /// column k is done, models are its final contexts
+  void finish(int k, const std::vector<ContextModel> &models);
+
+  static void encode(CABAC_ThreadPool &pool, const std::vector<ContextModel> &initModels, 
+                     const uint8_t *bins, const int32_t *ctxIdx, 
+                     const std::vector<size_t> &firstBin, const std::vector<size_t> &syncBin,
+                     std::vector<unsigned char> &rOut, std::vector<size_t> *pSubstreamBytes = NULL);
+  static void decode(CABAC_ThreadPool &pool, const std::vector<ContextModel> &initModels, 
+                     const CABAC_Substreams &substreams, const int32_t *ctxIdx, 
+                     const std::vector<size_t> &firstBin, const std::vector<size_t> &syncBin, uint8_t *bins);
+  /// decode the columns of a matrix with numRows rows (column by column) in parallel, column k 
+  /// is decoded by a copy of coder from substream k and syncs after uiSyncRow rows
+  static void decodeMatrix(CABAC_ThreadPool &pool, const std::vector<ContextModel> &initModels, 
+                           const CABAC_Substreams &substreams, const CABAC_MatrixCoder &coder, 
+                           size_t numRows, size_t uiSyncRow, unsigned int *values);
+
+protected:
+  void xStoreContexts(int k, const std::vector<ContextModel> &models);
+
+  const std::vector<ContextModel> &m_initModels;
+  std::vector<bool>               m_abStored;     ///< contexts of the column are stored for the next one
+  std::vector<std::vector<ContextModel> > m_aContexts;
+  std::mutex                      m_mutex;
+  std::condition_variable         m_changed;
+};
@@ -35,29 +35,43 @@
 #ifndef __COMMONDEF__
 #define __COMMONDEF__
 
-// Trace the cabac states (how often is which context coded?)
-#ifdef _WIN32
-#define RWTH_TRACE_CABAC_STATES 1
-#else
-#define RWTH_TRACE_CABAC_STATES 0
-#endif
+// Print the engine state for every coded bin (DTRACE_CABAC_*), optionally into a file.
+// The context state statistics are chosen at runtime, see CABAC_Trace.
 #define RWTH_TRACE_CABAC 0
 #define RWTH_TRACE_CABAC_TO_FILE 0
-#define RWTH_TRACE_CABAC_STATES_NUM_STATES 128 /// The number of states
+// The number of context states in the state statistics (see CABAC_Trace)
+#define RWTH_TRACE_CABAC_STATES_NUM_STATES 128
+// Sum up the estimated bits of the decoded bins (see CABAC_RateEstimator) in the decoder
+#define TRACE_STATISTICS_BITRATE 0
 
 
 // Enables coding of bins with a fixed probability
 #define RWTH_CABAC_FIXED_PROBABILITY 0
 
+// Decode context coded bins in the MEX interface with the branch-free decodeBinPacked
+// (faster for near-equiprobable bins, slower for strongly skewed ones, see SimpleCABACBench)
+#define RWTH_CABAC_PACKED_DECODER 0
+
 // Enable Debug Output for MEX
 #define RWTH_CABAC_DEBUG_OUTPUT 0
 
-// Maximum Number of Contexts
-#define RWTH_MAX_NUM_CONTEXTS 1000
+// Number of destroyed MEX sessions kept for reuse by the next init
+#define RWTH_CABAC_MAX_POOLED_SESSIONS 8
+
+// Largest Nq for which CABAC_Binarizer stores the bin strings of all values in a table
+#define RWTH_CABAC_BINARIZER_TABLE_SIZE 4096
 
 /** clip a, such that minVal <= a <= maxVal */
 template <typename T> inline T Clip3( T minVal, T maxVal, T a) { return std::min<T> (std::max<T> (minVal, a) , maxVal); }  ///< general min/max clip
 
+/** count the leading zero bits of a (non-zero) 32 bit value */
+#ifdef _MSC_VER
+#include <intrin.h>
+inline unsigned int countLeadingZeros32( unsigned int x ) { unsigned long idx; _BitScanReverse( &idx, x ); return 31 - idx; }
+#else
+inline unsigned int countLeadingZeros32( unsigned int x ) { return __builtin_clz( x ); }
+#endif
+
 // RWTH_TRACE_CABAC
 #define RWTH_TRACE_CABAC 0
 #if RWTH_TRACE_CABAC
@@ -42,8 +42,6 @@
 
 using namespace std;
 
-unsigned int ContextModel::m_uiInstanceCounter = 0;
-
 // ====================================================================================================================
 // Public member functions
 // ====================================================================================================================
@@ -52,9 +50,6 @@ ContextModel::ContextModel()
 {
   // By default the context is initialized with equal probability
   init(1, 0);
-
-  m_uiCtxIdx = m_uiInstanceCounter; // Which instance of this class is this?
-  m_uiInstanceCounter++;
 }
 
 ContextModel::~ContextModel()
@@ -70,69 +65,18 @@ ContextModel::~ContextModel()
 void ContextModel::init( unsigned int uiMps, unsigned int uiState )
 {
   m_ucState = ( uiState << 1 ) + uiMps;
-  m_ucInitState = m_ucState;
-  m_binsCoded = 0;
-
-#if RWTH_TRACE_CABAC_STATES
-  for (unsigned int iState = 0; iState < RWTH_TRACE_CABAC_STATES_NUM_STATES; iState++)
-  {
-    m_uiTraceCabacState[iState] = 0;
-  }
-  m_uiTraceCabacTransitions.resize(RWTH_TRACE_CABAC_STATES_NUM_STATES);
-  for (int i = 0; i < RWTH_TRACE_CABAC_STATES_NUM_STATES; i++)
-  {
-    //Grow Columns by n
-    m_uiTraceCabacTransitions[i].resize(RWTH_TRACE_CABAC_STATES_NUM_STATES);
-  }
-  for (int i = 0; i < RWTH_TRACE_CABAC_STATES_NUM_STATES; i++)
-  {
-    for (int j = 0; j < RWTH_TRACE_CABAC_STATES_NUM_STATES; j++)
-    {
-      m_uiTraceCabacTransitions[i][j] = 0;
-    }
-  }
-#endif
-}
-
-#if RWTH_TRACE_CABAC_STATES
-void ContextModel::updateTraceState()
-{
-  unsigned int uiMps = m_ucState & 1;
-  unsigned int uiState = m_ucState >> 1;
-  int uiTraceState = (uiMps == 0) ? 63-uiState : uiState + 64;
-  m_uiTraceCabacState[uiTraceState]++;
 }
-#endif
 
 void ContextModel::updateLPS()
 {
-#if RWTH_TRACE_CABAC_STATES
-  updateTraceState();
-#endif
   m_ucState = m_aucNextStateLPS[ m_ucState ];
-  m_binsCoded++;
 }
 
 void ContextModel::updateMPS ()
 {
-#if RWTH_TRACE_CABAC_STATES
-  updateTraceState();
-#endif
   m_ucState = m_aucNextStateMPS[ m_ucState ];
-  m_binsCoded++;
 }
 
-#if RWTH_TRACE_CABAC_STATES
-void ContextModel::addCabacStep(uint8_t cbin, uint8_t state_p, uint8_t mps_p, uint8_t state_a, uint8_t mps_a)
-{
-  uint8_t uiTraceStatePrev = (mps_p == 0) ? 63 - state_p : state_p + 64;
-  uint8_t uiTraceStateAct  =  (mps_a == 0) ? 63 - state_a : state_a + 64;
-
-  CABACStep tmp(cbin, uiTraceStatePrev, mps_p, uiTraceStateAct, mps_a);
-  m_uiTraceCabacTransitions[uiTraceStatePrev][uiTraceStateAct]++;
-  m_CABACSteps.push_back(tmp);
-}
-#endif
 const unsigned char ContextModel::m_aucNextStateMPS[ 128 ] =
 {
   2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17,
@@ -170,27 +114,3 @@ const int ContextModel::m_entropyBits[128] =
 };
 //! \}
 
-#if RWTH_TRACE_CABAC_STATES && RWTH_TRACE_CABAC_TO_FILE
-void ContextModel::traceStatesToFile(FILE *poutFile)
-{
-  // don't trace empty contexts
-    bool bCtxEmpty = true;
-    for (unsigned int uiState = 0; uiState < RWTH_TRACE_CABAC_STATES_NUM_STATES; uiState++)
-    {
-      if (m_uiTraceCabacState[uiState] != 0)
-      {
-        bCtxEmpty = false;
-        break;
-      }
-    }
-    if (!bCtxEmpty)
-    {
-      fprintf(poutFile, "ctxIdInternal, %i", m_uiCtxIdx);
-      for (unsigned int uiState = 0; uiState < RWTH_TRACE_CABAC_STATES_NUM_STATES; uiState++)  
-      {
-        fprintf(poutFile, ", %llu", m_uiTraceCabacState[uiState]);
-      }
-      fprintf(poutFile, "\n");
-    }
-}
-#endif
@@ -44,31 +44,11 @@
 
 #include "CommonDef.h"
 
-#if RWTH_TRACE_CABAC_STATES
-#include <cstdio>
-#include <vector>
-#include <stdint.h>
-
-using namespace std;
-struct _CABACStep
-{
-  uint8_t codedBin;
-  uint8_t state_p;
-  uint8_t mps_p;
-  uint8_t state_a;
-  uint8_t mps_a;
-  _CABACStep(uint8_t c, uint8_t sp, uint8_t mp, uint8_t sa, uint8_t ma) :
-    codedBin(c), state_p(sp), mps_p(mp), state_a(sa), mps_a(ma)
-  { }
-};
-typedef struct _CABACStep CABACStep;
-#endif
-
 // ====================================================================================================================
 // Class definition
 // ====================================================================================================================
 
-/// context model class
+/// context model class, only the combined state, so that arrays of models keep the states contiguous
 class ContextModel
 {
 public:
@@ -78,46 +58,24 @@ public:
   unsigned char getState  ()                { return ( m_ucState >> 1 ); }                    ///< get current state
   unsigned char getMps    ()                { return ( m_ucState  & 1 ); }                    ///< get curret MPS
   void  setStateAndMps( unsigned char ucState, unsigned char ucMPS) { m_ucState = (ucState << 1) + ucMPS; } ///< set state and MPS
+  unsigned char getStateIdx() const        { return m_ucState; }                              ///< get combined (state << 1) + MPS
   
   void init ( unsigned int uiMps, unsigned int uiState );   ///< initialize state with initial probability
-  unsigned char getInitState() { return ( m_ucInitState >> 1); }
-  unsigned char getInitMps  () { return ( m_ucInitState  & 1); }
-  int  m_ucInitState;
   
   void updateLPS ();
   void updateMPS ();
+  void updateStateIdx( unsigned char ucStateIdx ) { m_ucState = ucStateIdx; } ///< set the next combined state
   
   int getEntropyBits(short val) { return m_entropyBits[m_ucState ^ val]; }
   
-  unsigned int getBinsCoded()           { return m_binsCoded;   }
-
-#if RWTH_TRACE_CABAC_STATES
-  void addCabacStep(uint8_t cbin, uint8_t state_p, uint8_t mps_p, uint8_t state_a, uint8_t mps_a);
-  std::vector<CABACStep>* getCabacSteps() { return &m_CABACSteps; };
-  vector<vector<unsigned int>>* getCabactTransitions() { return &m_uiTraceCabacTransitions; };
-#endif
+  static unsigned char getNextStateIdxMPS( unsigned char ucStateIdx ) { return m_aucNextStateMPS[ucStateIdx]; } ///< combined state after coding a MPS
+  static unsigned char getNextStateIdxLPS( unsigned char ucStateIdx ) { return m_aucNextStateLPS[ucStateIdx]; } ///< combined state after coding a LPS
   
 private:
   unsigned char m_ucState; ///< internal state variable
   static const unsigned char m_aucNextStateMPS[ 128 ];
   static const unsigned char m_aucNextStateLPS[ 128 ];
   static const int m_entropyBits[ 128 ];
-  unsigned int m_binsCoded;
-
-  static unsigned int m_uiInstanceCounter;
-  unsigned int m_uiCtxIdx;
-
-#if RWTH_TRACE_CABAC_STATES
-  // Save which how many bins were coded in each state
-  uint64_t m_uiTraceCabacState[RWTH_TRACE_CABAC_STATES_NUM_STATES];
-  void updateTraceState();
-  vector<CABACStep> m_CABACSteps;
-  vector<vector<unsigned int>> m_uiTraceCabacTransitions;
-public:
-#if RWTH_TRACE_CABAC_TO_FILE
-  void traceStatesToFile(FILE *pOutFile);
-#endif
-#endif
 };
 
 //! \}
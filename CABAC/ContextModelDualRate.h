@@ -0,0 +1,109 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+#pragma once
+
+#include <stdint.h>
+
+/** Context model with two adaptive probability estimates (dual-rate model)
+  *
+  * Alternative to the 64 state model of ContextModel, following the probability estimation of 
+  * VVC: two 15 bit estimates of the probability of a 1 bin adapt with the window sizes 
+  * 2^RATE_FAST and 2^RATE_SLOW, the coder uses their mean. The LPS range is computed by a 
+  * multiplication of the 7 bit LPS probability with the upper bits of the range instead of
+  * the table lookup, the smallest LPS range is 4 (HEVC: 6). So strongly skewed bins cost 
+  * less, and the estimate follows changing statistics fast without losing precision.
+  *
+  * The arithmetic coders have an overload of encodeBin / decodeBin for this model, the 
+  * model is chosen at compile time and the code for ContextModel is not changed by it.
+  */
+class ContextModelDualRate
+{
+public:
+  static const int RATE_FAST = 4;  ///< log2 of the window size of the fast estimate
+  static const int RATE_SLOW = 7;  ///< log2 of the window size of the slow estimate
+
+  ContextModelDualRate() { init(0.5); }
+
+  /// initialize both estimates with the probability p0 of a 0 bin
+  void init(double p0)
+  {
+    double p1 = (1.0 - p0) * 32768.0 + 0.5;
+    uint16_t usState = (uint16_t)(p1 < 0.0 ? 0 : p1 > 32767.0 ? 32767 : (int)p1);
+    m_ausState[0] = usState;
+    m_ausState[1] = usState;
+  }
+
+  /// the probability of a 1 bin with 8 bits
+  unsigned int getProb8() const { return (unsigned int)(m_ausState[0] + m_ausState[1]) >> 8; }
+  unsigned int getMps() const { return getProb8() >> 7; }
+
+  /// the LPS part of the range (256...510), between 4 and 236
+  unsigned int getLPS(unsigned int uiRange) const
+  {
+    unsigned int q = getProb8();
+    if (q & 0x80)
+    {
+      q ^= 0xff;
+    }
+    return ((q >> 2) * (uiRange >> 5) >> 1) + 4;
+  }
+
+  /// move both estimates towards the coded bin
+  void update(unsigned int uiBin)
+  {
+    m_ausState[0] -= m_ausState[0] >> RATE_FAST;
+    m_ausState[1] -= m_ausState[1] >> RATE_SLOW;
+    if (uiBin)
+    {
+      m_ausState[0] += 0x7fff >> RATE_FAST;
+      m_ausState[1] += 0x7fff >> RATE_SLOW;
+    }
+  }
+
+  /// the LPS probability quantized to the combined (state << 1) + MPS of ContextModel (state 0: p = 0.5), lets the coding loops of ContextModel compile for this model (CABAC_Trace only traces ContextModel)
+  unsigned char getStateIdx() const
+  {
+    unsigned int q = getProb8();
+    unsigned int mps = q >> 7;
+    unsigned int qLPS = mps ? q ^ 0xff : q;
+    return (unsigned char)((((127 - qLPS) >> 1) << 1) + mps);
+  }
+
+  /// the fast (0) or the slow (1) estimate, e.g. to store the context
+  uint16_t getState(int i) const { return m_ausState[i]; }
+  void setState(uint16_t usFast, uint16_t usSlow) { m_ausState[0] = usFast & 0x7fff; m_ausState[1] = usSlow & 0x7fff; }
+
+private:
+  uint16_t m_ausState[2];  ///< the fast and the slow estimate of the probability of a 1 bin, 15 bits
+};
@@ -34,12 +34,21 @@
 #include <iostream>
 #include <fstream>
 #include <list>
+#include <algorithm>
 #include <math.h>
+#include <string.h>
 #include <assert.h>
 
 #include "CABAC_ArithmeticEncoder.h"
 #include "CABAC_ArithmeticDecoder.h"
 #include "CABAC_BitstreamFile.h"
+#include "CABAC_BitstreamMemory.h"
+#include "CABAC_BinCapture.h"
+#include "CABAC_Binarizer.h"
+#include "CABAC_MatrixCoder.h"
+#include "CABAC_Substreams.h"
+#include "CABAC_ThreadPool.h"
+#include "CABAC_Wavefront.h"
 #include "ContextModel.h"
 #include "CommonDef.h"
 
@@ -79,6 +88,9 @@ void codeToFile()
   // Encode the same 5 bits (10010) using the encodeBinsEP function
   arithmeticEncoder.encodeBinsEP(18, 5);
 
+  // Encode 32 EP bits at once
+  arithmeticEncoder.encodeBinsEP(0xdeadbeef, 32);
+
   // Create another context and code 110111 to it
   ContextModel ctx1;
   arithmeticEncoder.encodeBin( 1, &ctx1 );
@@ -88,6 +100,16 @@ void codeToFile()
   arithmeticEncoder.encodeBin( 1, &ctx1 );
   arithmeticEncoder.encodeBin( 1, &ctx1 );
 
+  // Code 100110 to a third context, which is decoded with the packed table decoder
+  ContextModel ctx2;
+  ctx2.init(1,40);
+  arithmeticEncoder.encodeBin( 1, &ctx2 );
+  arithmeticEncoder.encodeBin( 0, &ctx2 );
+  arithmeticEncoder.encodeBin( 0, &ctx2 );
+  arithmeticEncoder.encodeBin( 1, &ctx2 );
+  arithmeticEncoder.encodeBin( 1, &ctx2 );
+  arithmeticEncoder.encodeBin( 0, &ctx2 );
+
 #if RWTH_CABAC_FIXED_PROBABILITY
   // Encode some bits with a fixed probabilty
   arithmeticEncoder.encodeBinProb(1, 10);
@@ -102,17 +124,6 @@ void codeToFile()
   // Finish coding
   arithmeticEncoder.finish();
   outStream.closeFile();
-    
-#if RWTH_TRACE_CABAC_STATES && RWTH_TRACE_CABAC_TO_FILE
-  // Coding is complete. Write CABAC stats to file
-  // Open the output file to write the CABAC state counters to
-  FILE *m_cTraceCabacStatFile = fopen("CabacStats.log", "w");
-  // Trace all ctx to the file
-  ctx0.traceStatesToFile(m_cTraceCabacStatFile);
-  ctx1.traceStatesToFile(m_cTraceCabacStatFile);
-  // Close the CABAC stat file
-  fclose(m_cTraceCabacStatFile);
-#endif
 }
 
 void decodeFromFile()
@@ -152,6 +163,10 @@ void decodeFromFile()
   arithmeticDecoder.decodeBinsEP(uiVal, 5);
   assert(uiVal==18);
 
+  // Decode the 32 EP bits
+  arithmeticDecoder.decodeBinsEP(uiVal, 32);
+  assert(uiVal==0xdeadbeef);
+
   // Create another context and decode six bits (should be 110111)
   ContextModel ctx1;
   arithmeticDecoder.decodeBin(uiBit, &ctx1); assert(uiBit == 1);
@@ -161,6 +176,16 @@ void decodeFromFile()
   arithmeticDecoder.decodeBin(uiBit, &ctx1); assert(uiBit == 1);
   arithmeticDecoder.decodeBin(uiBit, &ctx1); assert(uiBit == 1);
 
+  // Decode six bits (should be 100110) from a third context using the packed table decoder
+  ContextModel ctx2;
+  ctx2.init(1,40);
+  arithmeticDecoder.decodeBinPacked(uiBit, &ctx2); assert(uiBit == 1);
+  arithmeticDecoder.decodeBinPacked(uiBit, &ctx2); assert(uiBit == 0);
+  arithmeticDecoder.decodeBinPacked(uiBit, &ctx2); assert(uiBit == 0);
+  arithmeticDecoder.decodeBinPacked(uiBit, &ctx2); assert(uiBit == 1);
+  arithmeticDecoder.decodeBinPacked(uiBit, &ctx2); assert(uiBit == 1);
+  arithmeticDecoder.decodeBinPacked(uiBit, &ctx2); assert(uiBit == 0);
+
 #if RWTH_CABAC_FIXED_PROBABILITY
   // Encode some bits with a fixed probabilty
   arithmeticDecoder.decodeBinProb(uiBit, 10); assert(uiBit==1);
@@ -176,6 +201,264 @@ void decodeFromFile()
   inStream.closeFile();
 }
 
+void captureToFile()
+{
+  // Create the capture file, e.g. to replay the bins with cabac_replay
+  CABAC_BinCapture capture;
+  if (!capture.open("str.cbin"))
+  {
+    fprintf(stderr, "\nfailed to open capture file `str.cbin' for writing\n");
+    return;
+  }
+  printf("Opened 'str.cbin' for capturing.\n");
+
+  // The capturing encoder records every bin before coding it into memory
+  CABAC_BitstreamMemory outStream;
+  outStream.openOutput();
+  TCABAC_CapturingEncoder<CABAC_ArithmeticEncoderMemory> arithmeticEncoder(&capture);
+  arithmeticEncoder.setBitstream(&outStream);
+
+  // The contexts have to be one vector, the captured context index is the position in it
+  std::vector<ContextModel> ctx(16);
+  ctx[1].init(0,20);
+  arithmeticEncoder.start(ctx);
+  unsigned int uiSeed = 1;
+  for (int i = 0; i < 10000; i++)
+  {
+    uiSeed = uiSeed * 1664525u + 1013904223u;
+    // skewed bins, every 8th symbol is followed by a bypass word and a terminating 0 bin
+    arithmeticEncoder.encodeBin((uiSeed >> 24) < 32, &ctx[(uiSeed >> 8) & 15]);
+    if ((i & 7) == 7)
+    {
+      arithmeticEncoder.encodeBinsEP(uiSeed >> 27, 5);
+      arithmeticEncoder.encodeBinTrm(0);
+    }
+  }
+  arithmeticEncoder.encodeBinTrm(1);
+  arithmeticEncoder.finish(outStream);
+  bool bClosed = capture.close();
+  assert(bClosed);
+
+  // Read the capture again
+  std::vector<CABAC_CapturedStream> streams;
+  bool bRead = CABAC_BinCapture::read("str.cbin", streams);
+  assert(bRead && streams.size() == 1);
+  assert(streams[0].models.size() == 16 && streams[0].bins.size() == 10000 + 1250 * 6 + 1);
+  assert(streams[0].bFinished && streams[0].bHasOutput);
+  assert(streams[0].uiNumBytes == outStream.getNumBytes());
+  assert(streams[0].uiHash == CABAC_BinCapture::hash(outStream.getData(), outStream.getNumBytes()));
+  (void)bClosed; (void)bRead;
+}
+
+// a value and its bin string as produced by cabacBinarizer.m
+struct BinarizerTest
+{
+  const char  *cMethod;
+  unsigned int uiNq;
+  unsigned int uiValue;
+  const char  *cBins;
+};
+
+static const BinarizerTest g_binarizerTests[] =
+{
+  // Nq <= 2 is not binarized, the value is the bin
+  { "DEC2TU",   2,     0,     "0" },
+  { "DEC2EG0",  2,     1,     "1" },
+  // TU, the maximum value has no terminating zero
+  { "DEC2TU",   5,     0,     "0" },
+  { "DEC2TU",   5,     2,     "110" },
+  { "DEC2TU",   5,     3,     "1110" },
+  { "DEC2TU",   5,     4,     "1111" },
+  // TR, the maximum value has an all ones suffix
+  { "DEC2TR0",  5,     0,     "0" },
+  { "DEC2TR0",  5,     3,     "1110" },
+  { "DEC2TR0",  5,     4,     "11110" },
+  { "DEC2TR1",  7,     0,     "00" },
+  { "DEC2TR1",  7,     5,     "1101" },
+  { "DEC2TR1",  7,     6,     "11101" },
+  { "DEC2TR2",  10,    3,     "011" },
+  { "DEC2TR2",  10,    6,     "1010" },
+  { "DEC2TR2",  10,    9,     "11011" },
+  // EG, with and without the table of the binarizer
+  { "DEC2EG0",  20,    0,     "0" },
+  { "DEC2EG0",  20,    1,     "100" },
+  { "DEC2EG0",  20,    4,     "11001" },
+  { "DEC2EG0",  20,    19,    "111100100" },
+  { "DEC2EG0",  70000, 69999, "11111111111111110" "0001000101110000" },
+  { "DEC2EG1",  6,     0,     "00" },
+  { "DEC2EG1",  6,     5,     "1011" },
+  { "DEC2EG2",  11,    3,     "011" },
+  { "DEC2EG2",  11,    10,    "10110" },
+  // FL with 32 bits
+  { "DEC2FL32", 6,     5,     "00000000000000000000000000000101" },
+  { "DEC2FL32", 70000, 69999, "00000000000000010001000101101111" },
+};
+
+void testBinarizer()
+{
+  for (size_t t = 0; t < sizeof(g_binarizerTests) / sizeof(g_binarizerTests[0]); t++)
+  {
+    const BinarizerTest &rTest = g_binarizerTests[t];
+    CABAC_Binarizer binarizer;
+    bool bInit = binarizer.init(rTest.cMethod, rTest.uiNq);
+    assert(bInit);
+    std::vector<uint8_t> bins;
+    binarizer.binarize(rTest.uiValue, bins);
+    assert(bins.size() == strlen(rTest.cBins));
+    for (size_t n = 0; n < bins.size(); n++)
+    {
+      assert(bins[n] == rTest.cBins[n] - '0');
+    }
+    // the decoder maps the bin string back to the value
+    assert(binarizer.getValue(binarizer.getCodeword(rTest.uiValue)) == rTest.uiValue);
+    (void)bInit;
+  }
+  printf("Checked %d bin strings.\n", (int)(sizeof(g_binarizerTests) / sizeof(g_binarizerTests[0])));
+}
+
+// encode a matrix column by column with the contexts of CABAC_MatrixCoder and decode it again
+static void xCodeMatrix(const char *cMethod, unsigned int uiNq, const std::vector<unsigned int> &values, size_t numRows)
+{
+  CABAC_MatrixCoder coder;
+  bool bInit = coder.init(cMethod, uiNq, 3);
+  bInit = bInit && coder.addContextModelType("cond0") && coder.addContextModelType("cond1");
+  bInit = bInit && coder.addContextModelType("condbinlft") && coder.addContextModelType("conds1");
+  assert(bInit);
+  const size_t numCols = values.size() / numRows;
+
+  CABAC_BitstreamMemory outStream;
+  outStream.openOutput();
+  CABAC_ArithmeticEncoderMemory arithmeticEncoder(&outStream);
+  std::vector<ContextModel> ctx(coder.getNumContextModels());
+  arithmeticEncoder.start();
+  for (size_t k = 0; k < numCols; k++)
+  {
+    coder.startColumn();
+    for (size_t d = 0; d < numRows; d++)
+    {
+      int numBins = coder.binarize(values[k * numRows + d]);
+      for (int n = 0; n < numBins; n++)
+      {
+        arithmeticEncoder.encodeBin(coder.getBins()[n], &ctx[coder.getContexts()[n]]);
+      }
+    }
+  }
+  arithmeticEncoder.finish();
+
+  CABAC_BitstreamMemory inStream;
+  inStream.openInput(outStream.getData(), outStream.getNumBytes());
+  CABAC_ArithmeticDecoderMemory arithmeticDecoder(&inStream);
+  std::vector<ContextModel> decoderCtx(coder.getNumContextModels());
+  std::vector<unsigned int> decoded(values.size());
+  arithmeticDecoder.start();
+  for (size_t k = 0; k < numCols; k++)
+  {
+    coder.startColumn();
+    coder.decodeValues(arithmeticDecoder, &decoderCtx[0], numRows, &decoded[k * numRows]);
+  }
+  arithmeticDecoder.finish();
+  assert(decoded == values);
+  (void)bInit;
+}
+
+void codeMatrix()
+{
+  const char *cMethods[] = { "DEC2TU", "DEC2TR0", "DEC2TR1", "DEC2TR2", "DEC2EG0", "DEC2EG1", "DEC2EG2", "DEC2FL32" };
+  const unsigned int auiNq[] = { 2, 16, 300, 70000 };
+  for (int m = 0; m < 8; m++)
+  {
+    for (int q = 0; q < 4; q++)
+    {
+      // 12 x 10 small values, the upper neighbors select the conditional contexts
+      std::vector<unsigned int> values(120);
+      unsigned int uiSeed = 7 * m + q;
+      for (size_t i = 0; i < values.size(); i++)
+      {
+        uiSeed = uiSeed * 1664525u + 1013904223u;
+        values[i] = ((uiSeed >> 24) & 15) % auiNq[q];
+        values[i] = (values[i] > 5) ? values[i] >> 2 : values[i];
+      }
+      xCodeMatrix(cMethods[m], auiNq[q], values, 12);
+    }
+    // columns with the maximum value, whose bin string ends without a terminating zero (TU) or
+    // with the cap of the leading ones, above and below every other value
+    const unsigned int auiMaxNq[] = { 2, 3, 5, 16, 300, 4097 };
+    for (int q = 0; q < 6; q++)
+    {
+      const unsigned int uiMax = auiMaxNq[q] - 1;
+      const unsigned int auiColumns[] = { uiMax, uiMax, 0, uiMax, uiMax / 2, uiMax, 
+                                          0, uiMax, uiMax, uiMax - 1, uiMax, uiMax };
+      std::vector<unsigned int> values(auiColumns, auiColumns + 12);
+      xCodeMatrix(cMethods[m], auiMaxNq[q], values, 4);
+    }
+  }
+  printf("Coded matrices with all binarizations.\n");
+}
+
+void codeWavefront()
+{
+  CABAC_MatrixCoder coder;
+  bool bInit = coder.init("DEC2EG0", 64, 3) && coder.addContextModelType("cond0") && coder.addContextModelType("conds1");
+  assert(bInit);
+  const size_t numRows = 40;
+  const size_t numCols = 24;
+  std::vector<ContextModel> initModels(coder.getNumContextModels());
+  initModels[0].init(0,20);
+
+  // binarize the matrix and select the contexts, the bins of every column are one substream
+  std::vector<unsigned int> values(numRows * numCols);
+  std::vector<uint8_t> bins;
+  std::vector<int32_t> ctxIdx;
+  std::vector<size_t> firstBin, rowBin(numCols * (numRows + 1));
+  unsigned int uiSeed = 3;
+  for (size_t k = 0; k < numCols; k++)
+  {
+    firstBin.push_back(bins.size());
+    coder.startColumn();
+    for (size_t d = 0; d < numRows; d++)
+    {
+      uiSeed = uiSeed * 1664525u + 1013904223u;
+      values[k * numRows + d] = (uiSeed >> 28) * (uiSeed >> 28) / 4;
+      rowBin[k * (numRows + 1) + d] = bins.size();
+      int numBins = coder.binarize(values[k * numRows + d]);
+      bins.insert(bins.end(), coder.getBins(), coder.getBins() + numBins);
+      ctxIdx.insert(ctxIdx.end(), coder.getContexts(), coder.getContexts() + numBins);
+    }
+    rowBin[k * (numRows + 1) + numRows] = bins.size();
+  }
+  firstBin.push_back(bins.size());
+
+  // sync before the first row, in the middle and after the last row, with several threads
+  const size_t auiSyncRow[] = { 0, 1, numRows / 2, numRows, numRows + 5 };
+  CABAC_ThreadPool pool;
+  for (int t = 0; t < 5; t++)
+  {
+    pool.init(1 + t % 4);
+    std::vector<size_t> syncBin(numCols);
+    for (size_t k = 0; k < numCols; k++)
+    {
+      syncBin[k] = rowBin[k * (numRows + 1) + std::min(auiSyncRow[t], numRows)];
+    }
+    std::vector<unsigned char> coded;
+    CABAC_Wavefront::encode(pool, initModels, &bins[0], &ctxIdx[0], firstBin, syncBin, coded);
+
+    CABAC_Substreams substreams;
+    bool bParsed = substreams.parse(&coded[0], coded.size());
+    assert(bParsed && substreams.getNumSubstreams() == (int)numCols);
+    std::vector<unsigned int> decoded(values.size());
+    CABAC_Wavefront::decodeMatrix(pool, initModels, substreams, coder, numRows, auiSyncRow[t], &decoded[0]);
+    assert(decoded == values);
+
+    // the bins decoded with the context indices agree as well
+    std::vector<uint8_t> decodedBins(bins.size());
+    CABAC_Wavefront::decode(pool, initModels, substreams, &ctxIdx[0], firstBin, syncBin, &decodedBins[0]);
+    assert(decodedBins == bins);
+    (void)bParsed;
+  }
+  printf("Coded a wavefront with 1 to 4 threads.\n");
+  (void)bInit;
+}
+
 int main(int argc, char* argv[])
 {
   printf("CABAC test environement.\n");
@@ -186,5 +469,15 @@ int main(int argc, char* argv[])
   // decode it again
   decodeFromFile();
 
+  // capture the bins of an encoding
+  captureToFile();
+
+  // binarize like cabacBinarizer.m and code a matrix like cabacEncode.m
+  testBinarizer();
+  codeMatrix();
+
+  // code the columns of a matrix in parallel
+  codeWavefront();
+
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,610 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+// Throughput benchmark for the arithmetic coder.
+// Codes synthetic bin streams into memory and decodes them again. Every scenario mixes
+// context coded bins (with a given probability of a 1 bin and number of contexts), bypass
+// bins and terminating bins in given ratios. The streams are coded with the 32 bit and the
+// 64 bit encoder and decoded with decodeBin and decodeBinPacked, and with the dual-rate model
+// (ContextModelDualRate). Bypass words of 1 to 32 bins are coded with encodeBinsEP and
+// decoded with decodeBinEP (bin by bin) and decodeBinsEP.
+// The adversarial scenarios are generated against the HEVC contexts to find the worst case
+// of every variant: an LPS in every bin, each in its own context initialized to the most 
+// probable state 62, so that almost every bin renormalizes by 5 or 6 bits (an adapting 
+// context falls to state 38 after one LPS and needs 24 MPS bins to get back, so LPS bins 
+// into a few contexts mostly cost 1 to 3 bits), an LPS whenever a context reaches the most 
+// probable state (shifts of 6 after every LPS) and a run of bypass 1 bins, which keeps all 
+// coded bytes outstanding as 0xff until the end.
+// The 64 bit encoder also streams its output through CABAC_BitstreamSink, to a 
+// CABAC_CallbackSink and to a CABAC_ByteRingBuffer drained by a consumer thread, and both
+// outputs are compared with the bytes of CABAC_BitstreamMemory.
+// Every measurement (the fastest of 3 runs) reports bins/s, ns/bin and bytes/s, as a table
+// or with --json as JSON array, e.g. to track the throughput of the engine over time. The 
+// worst bins/s and bytes/s of every variant over all scenarios follow at the end, with the 
+// ratio of the worst to the median bins/s to show a cliff of an optimized path. The worst 
+// bytes/s only counts the scenarios with at least half the output of "equiprobable", a 
+// stream of almost no bytes (e.g. "terminate") says nothing about the byte output. The exit 
+// code is 1 if a decoded stream does not match.
+// Usage: SimpleCABACBench [numBins] [--json]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <thread>
+
+#include "CABAC_ArithmeticEncoder.h"
+#include "CABAC_ArithmeticEncoder64.h"
+#include "CABAC_ArithmeticDecoder.h"
+#include "CABAC_BitstreamMemory.h"
+#include "CABAC_BitstreamSink.h"
+#include "CABAC_ByteRingBuffer.h"
+#include "ContextModel.h"
+#include "ContextModelDualRate.h"
+#include "CommonDef.h"
+
+using namespace std;
+
+/// how the bins of a scenario are generated
+enum BenchGenerator
+{
+  BENCH_GEN_RANDOM,     ///< random bins with the probabilities and ratios of the scenario
+  BENCH_GEN_LPS,        ///< every context coded bin is the LPS of its context
+  BENCH_GEN_LPS_SHIFT6, ///< MPS until the context reaches state 62, then a LPS
+  BENCH_GEN_FF_RUN      ///< bypass 1 bins, a single 0 bin at the end
+};
+
+struct BenchScenario
+{
+  const char *name;
+  BenchGenerator eGenerator;
+  double      p1;           ///< probability of a 1 bin in the context coded bins
+  int         numContexts;  ///< context coded bins are spread uniformly over the contexts, 0: a context per bin
+  int         initState;    ///< initial state of the contexts (MPS 1), 0 is p = 0.5
+  double      epRatio;      ///< fraction of bypass bins
+  double      trmRatio;     ///< fraction of terminating bins (always 0, the 1 ends the stream)
+};
+
+enum BenchBinType
+{
+  BENCH_BIN_CTX,
+  BENCH_BIN_EP,
+  BENCH_BIN_TRM
+};
+
+struct BenchBin
+{
+  uint8_t  type;    ///< BenchBinType
+  uint8_t  bin;
+  uint32_t ctxIdx;
+};
+
+/// one measurement, printed by xReport
+struct BenchResult
+{
+  const char *scenario;
+  const char *operation;  ///< encode or decode
+  const char *engine;     ///< the coding function / engine
+  const char *model;      ///< probability model of the context coded bins
+  size_t      numBins;
+  size_t      numBytes;   ///< size of the coded stream
+  double      seconds;
+  bool        ok;         ///< encoders: same bytes as the reference, decoders: bins decoded correctly
+};
+
+// every measurement is repeated, the fastest run counts
+static const int s_iRepetitions = 3;
+
+static void xMinTime(double &rSeconds, double seconds, int iRepetition)
+{
+  rSeconds = (iRepetition == 0 || seconds < rSeconds) ? seconds : rSeconds;
+}
+
+static unsigned int xRandom(unsigned int &ruiSeed)
+{
+  ruiSeed = ruiSeed * 1664525u + 1013904223u;
+  return ruiSeed >> 8;
+}
+
+// allocate and initialize the contexts of a scenario
+static void xInitContexts(const BenchScenario &s, size_t numBins, vector<ContextModel> &ctx)
+{
+  ctx.assign(s.numContexts ? s.numContexts : numBins, ContextModel());
+  for (size_t i = 0; i < ctx.size() && s.initState; i++)
+  {
+    ctx[i].init(1, s.initState);
+  }
+}
+
+// the dual-rate contexts start with the LPS probability of the HEVC state
+static void xInitContexts(const BenchScenario &s, size_t numBins, vector<ContextModelDualRate> &ctx)
+{
+  ctx.assign(s.numContexts ? s.numContexts : numBins, ContextModelDualRate());
+  for (size_t i = 0; i < ctx.size() && s.initState; i++)
+  {
+    ctx[i].init(0.5 * pow(0.01875 / 0.5, s.initState / 62.0));
+  }
+}
+
+static uint32_t xContextIndex(const BenchScenario &s, unsigned int &ruiSeed, size_t i)
+{
+  return s.numContexts ? (uint32_t)(xRandom(ruiSeed) % s.numContexts) : (uint32_t)i;
+}
+
+// the adversarial bins, the contexts follow the bins with the HEVC model
+static void xGenerateAdversarialBins(const BenchScenario &s, vector<BenchBin> &bins)
+{
+  unsigned int uiSeed = 1;
+  vector<ContextModel> ctx;
+  xInitContexts(s, bins.size(), ctx);
+  for (size_t i = 0; i < bins.size(); i++)
+  {
+    bins[i].type = (s.eGenerator == BENCH_GEN_FF_RUN) ? BENCH_BIN_EP : BENCH_BIN_CTX;
+    bins[i].ctxIdx = xContextIndex(s, uiSeed, i);
+    ContextModel &rCtx = ctx[bins[i].ctxIdx];
+    switch (s.eGenerator)
+    {
+    case BENCH_GEN_LPS:        bins[i].bin = 1 - rCtx.getMps(); break;
+    case BENCH_GEN_LPS_SHIFT6: bins[i].bin = (rCtx.getState() == 62) ? 1 - rCtx.getMps() : rCtx.getMps(); break;
+    default:                   bins[i].bin = (i + 1 < bins.size()); break;
+    }
+    if (bins[i].type == BENCH_BIN_CTX)
+    {
+      (bins[i].bin == rCtx.getMps()) ? rCtx.updateMPS() : rCtx.updateLPS();
+    }
+  }
+}
+
+static void xGenerateBins(const BenchScenario &s, vector<BenchBin> &bins)
+{
+  if (s.eGenerator != BENCH_GEN_RANDOM)
+  {
+    xGenerateAdversarialBins(s, bins);
+    return;
+  }
+  unsigned int uiSeed = 1;
+  const unsigned int uiThreshold = (unsigned int)(s.p1 * (1 << 24));
+  const unsigned int uiEpThreshold = (unsigned int)(s.epRatio * (1 << 24));
+  const unsigned int uiTrmThreshold = (unsigned int)((s.epRatio + s.trmRatio) * (1 << 24));
+  for (size_t i = 0; i < bins.size(); i++)
+  {
+    unsigned int uiType = xRandom(uiSeed);
+    bins[i].type = (uiType < uiEpThreshold) ? BENCH_BIN_EP : (uiType < uiTrmThreshold) ? BENCH_BIN_TRM : BENCH_BIN_CTX;
+    bins[i].ctxIdx = xContextIndex(s, uiSeed, i);
+    bins[i].bin = (bins[i].type == BENCH_BIN_TRM) ? 0 
+                : (bins[i].type == BENCH_BIN_EP) ? (xRandom(uiSeed) >> 23) : (xRandom(uiSeed) < uiThreshold);
+  }
+}
+
+// Encode all bins with the given encoder and context model, returns the time in seconds
+template <class TEncoder, class TModel>
+static double xEncode(const BenchScenario &s, const vector<BenchBin> &bins, CABAC_BitstreamMemory &outStream)
+{
+  outStream.openOutput(bins.size() / 8);
+  TEncoder encoder(&outStream);
+  vector<TModel> ctx;
+  xInitContexts(s, bins.size(), ctx);
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  encoder.start();
+  for (size_t i = 0; i < bins.size(); i++)
+  {
+    switch (bins[i].type)
+    {
+    case BENCH_BIN_CTX: encoder.encodeBin(bins[i].bin, &ctx[bins[i].ctxIdx]); break;
+    case BENCH_BIN_EP:  encoder.encodeBinEP(bins[i].bin); break;
+    default:            encoder.encodeBinTrm(bins[i].bin); break;
+    }
+  }
+  encoder.finish();
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Encode all bins with the 64 bit encoder into a CABAC_BitstreamSink, which hands the bytes to a
+// callback or to a ring buffer drained by a consumer thread. The received bytes are returned in
+// rBytes, the time in seconds includes starting and joining the consumer.
+template <bool bRingBuffer>
+static double xEncodeStreaming(const BenchScenario &s, const vector<BenchBin> &bins, vector<unsigned char> &rBytes)
+{
+  rBytes.clear();
+  rBytes.reserve(bins.size() / 8);
+  CABAC_CallbackSink callback([&rBytes](const unsigned char *pData, size_t uiNumBytes) { rBytes.insert(rBytes.end(), pData, pData + uiNumBytes); });
+  CABAC_ByteRingBuffer ringBuffer(1 << 16);
+  CABAC_BitstreamSink outStream(bRingBuffer ? (CABAC_ByteSink*)&ringBuffer : &callback);
+  CABAC_ArithmeticEncoder64Sink encoder(&outStream);
+  vector<ContextModel> ctx;
+  xInitContexts(s, bins.size(), ctx);
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  thread consumer;
+  if (bRingBuffer)
+  {
+    consumer = thread([&ringBuffer, &rBytes]()
+    {
+      unsigned char aucBytes[4096];
+      bool bFinished = false;
+      while (!bFinished)
+      {
+        // check before taking the bytes, so that the bytes appended before close() are not lost
+        bFinished = ringBuffer.isFinished();
+        size_t uiNumBytes = ringBuffer.getBytes(aucBytes, sizeof(aucBytes));
+        rBytes.insert(rBytes.end(), aucBytes, aucBytes + uiNumBytes);
+        if (!uiNumBytes && !bFinished)
+        {
+          this_thread::yield();
+        }
+      }
+    });
+  }
+  encoder.start();
+  for (size_t i = 0; i < bins.size(); i++)
+  {
+    switch (bins[i].type)
+    {
+    case BENCH_BIN_CTX: encoder.encodeBin(bins[i].bin, &ctx[bins[i].ctxIdx]); break;
+    case BENCH_BIN_EP:  encoder.encodeBinEP(bins[i].bin); break;
+    default:            encoder.encodeBinTrm(bins[i].bin); break;
+    }
+  }
+  encoder.finish();
+  if (bRingBuffer)
+  {
+    ringBuffer.close();
+    consumer.join();
+  }
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Decode all bins with decodeBin or decodeBinPacked, returns the time in seconds
+template <class TModel, bool bPacked>
+static double xDecode(const BenchScenario &s, const CABAC_BitstreamMemory &encoded, const vector<BenchBin> &bins, bool &rbOk)
+{
+  CABAC_BitstreamMemory inStream;
+  inStream.openInput(encoded.getData(), encoded.getNumBytes());
+  CABAC_ArithmeticDecoderMemory decoder(&inStream);
+  vector<TModel> ctx;
+  xInitContexts(s, bins.size(), ctx);
+  unsigned int uiErrors = 0;
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  decoder.start();
+  for (size_t i = 0; i < bins.size(); i++)
+  {
+    unsigned int uiBin;
+    switch (bins[i].type)
+    {
+    case BENCH_BIN_CTX: 
+      if (bPacked)
+      {
+        decoder.decodeBinPacked(uiBin, &ctx[bins[i].ctxIdx]);
+      }
+      else
+      {
+        decoder.decodeBin(uiBin, &ctx[bins[i].ctxIdx]);
+      }
+      break;
+    case BENCH_BIN_EP:  decoder.decodeBinEP(uiBin); break;
+    default:            decoder.decodeBinTrm(uiBin); break;
+    }
+    uiErrors += (uiBin != bins[i].bin);
+  }
+  decoder.finish();
+  double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  rbOk = (uiErrors == 0);
+  return seconds;
+}
+
+// Encode bypass words with encodeBinsEP, returns the time in seconds
+template <class TEncoder>
+static double xEncodeEP(const vector<unsigned int> &words, const vector<unsigned char> &lengths, CABAC_BitstreamMemory &outStream)
+{
+  outStream.openOutput(words.size() * 2);
+  TEncoder encoder(&outStream);
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  encoder.start();
+  for (size_t i = 0; i < words.size(); i++)
+  {
+    encoder.encodeBinsEP(words[i], lengths[i]);
+  }
+  encoder.finish();
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Decode bypass words bin by bin with decodeBinEP or at once with decodeBinsEP, returns the time in seconds
+template <bool bBinByBin>
+static double xDecodeEP(const CABAC_BitstreamMemory &encoded, const vector<unsigned char> &lengths, vector<unsigned int> &words)
+{
+  CABAC_BitstreamMemory inStream;
+  inStream.openInput(encoded.getData(), encoded.getNumBytes());
+  CABAC_ArithmeticDecoderMemory decoder(&inStream);
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  decoder.start();
+  for (size_t i = 0; i < lengths.size(); i++)
+  {
+    unsigned int uiWord = 0;
+    if (bBinByBin)
+    {
+      for (int k = 0; k < lengths[i]; k++)
+      {
+        unsigned int uiBin;
+        decoder.decodeBinEP(uiBin);
+        uiWord = (uiWord << 1) | uiBin;
+      }
+    }
+    else
+    {
+      decoder.decodeBinsEP(uiWord, lengths[i]);
+    }
+    words[i] = uiWord;
+  }
+  decoder.finish();
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static bool xEqual(const CABAC_BitstreamMemory &a, const CABAC_BitstreamMemory &b)
+{
+  return a.getNumBytes() == b.getNumBytes() && equal(a.getData(), a.getData() + a.getNumBytes(), b.getData());
+}
+
+static bool xEqual(const CABAC_BitstreamMemory &a, const vector<unsigned char> &b)
+{
+  return a.getNumBytes() == b.size() && equal(b.begin(), b.end(), a.getData());
+}
+
+// print a result as table row or JSON object
+static void xReport(const BenchResult &r, bool bJson, bool bFirst)
+{
+  const double binsPerSecond = r.numBins / r.seconds;
+  const double nsPerBin = r.seconds * 1e9 / r.numBins;
+  const double bytesPerSecond = r.numBytes / r.seconds;
+  if (bJson)
+  {
+    printf("%s\n  {\"scenario\": \"%s\", \"operation\": \"%s\", \"engine\": \"%s\", \"model\": \"%s\", "
+      "\"bins\": %zu, \"bytes\": %zu, \"seconds\": %.6f, \"bins_per_s\": %.0f, \"ns_per_bin\": %.3f, "
+      "\"bytes_per_s\": %.0f, \"ok\": %s}",
+      bFirst ? "" : ",", r.scenario, r.operation, r.engine, r.model, r.numBins, r.numBytes, r.seconds,
+      binsPerSecond, nsPerBin, bytesPerSecond, r.ok ? "true" : "false");
+  }
+  else
+  {
+    printf("%-15s %-6s %-16s %-8s %10zu bins %9zu bytes %8.1f Mbins/s %6.2f ns/bin %8.1f MB/s%s\n",
+      r.scenario, r.operation, r.engine, r.model, r.numBins, r.numBytes, 
+      binsPerSecond * 1e-6, nsPerBin, bytesPerSecond * 1e-6, r.ok ? "" : "  MISMATCH");
+  }
+}
+
+static bool xSameVariant(const BenchResult &a, const BenchResult &b)
+{
+  return !strcmp(a.operation, b.operation) && !strcmp(a.engine, b.engine) && !strcmp(a.model, b.model);
+}
+
+// print the worst bins/s and bytes/s of every variant coding more than one scenario, with the
+// ratio of the worst to the median bins/s of the variant. The bytes/s are only compared for
+// the scenarios with at least half the output of the "equiprobable" scenario of the variant.
+static void xReportWorstCase(const vector<BenchResult> &results, bool bJson)
+{
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    bool bFirstOfVariant = true;
+    for (size_t j = 0; j < i && bFirstOfVariant; j++)
+    {
+      bFirstOfVariant = !xSameVariant(results[i], results[j]);
+    }
+    if (!bFirstOfVariant)
+    {
+      continue;
+    }
+    size_t minBytes = 0;
+    for (size_t j = i; j < results.size(); j++)
+    {
+      if (xSameVariant(results[i], results[j]) && !strcmp(results[j].scenario, "equiprobable"))
+      {
+        minBytes = results[j].numBytes / 2;
+      }
+    }
+    const BenchResult *pWorstBins = &results[i];
+    const BenchResult *pWorstBytes = NULL;
+    vector<double> binsPerSecond;
+    for (size_t j = i; j < results.size(); j++)
+    {
+      const BenchResult &r = results[j];
+      if (xSameVariant(results[i], r))
+      {
+        binsPerSecond.push_back(r.numBins / r.seconds);
+        pWorstBins = (r.numBins / r.seconds < pWorstBins->numBins / pWorstBins->seconds) ? &r : pWorstBins;
+        if (r.numBytes >= minBytes && (!pWorstBytes || r.numBytes / r.seconds < pWorstBytes->numBytes / pWorstBytes->seconds))
+        {
+          pWorstBytes = &r;
+        }
+      }
+    }
+    if (binsPerSecond.size() < 2 || !pWorstBytes)
+    {
+      continue;
+    }
+    sort(binsPerSecond.begin(), binsPerSecond.end());
+    const double worstBinsPerSecond = pWorstBins->numBins / pWorstBins->seconds;
+    const double worstBytesPerSecond = pWorstBytes->numBytes / pWorstBytes->seconds;
+    const double ratio = worstBinsPerSecond / binsPerSecond[binsPerSecond.size() / 2];
+    if (bJson)
+    {
+      printf(",\n  {\"scenario\": \"worst_case\", \"operation\": \"%s\", \"engine\": \"%s\", \"model\": \"%s\", "
+        "\"bins_per_s\": %.0f, \"bins_scenario\": \"%s\", \"ratio_to_median\": %.3f, "
+        "\"bytes_per_s\": %.0f, \"bytes_scenario\": \"%s\"}",
+        results[i].operation, results[i].engine, results[i].model, 
+        worstBinsPerSecond, pWorstBins->scenario, ratio, worstBytesPerSecond, pWorstBytes->scenario);
+    }
+    else
+    {
+      printf("worst case %-6s %-16s %-8s %8.1f Mbins/s (%s, %.2f of the median) %8.1f MB/s (%s)\n",
+        results[i].operation, results[i].engine, results[i].model, 
+        worstBinsPerSecond * 1e-6, pWorstBins->scenario, ratio, worstBytesPerSecond * 1e-6, pWorstBytes->scenario);
+    }
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  size_t numBins = 10000000;
+  bool bJson = false;
+  for (int i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i], "--json"))
+    {
+      bJson = true;
+    }
+    else
+    {
+      numBins = (size_t)atol(argv[i]);
+    }
+  }
+  const BenchScenario scenarios[] = 
+  { 
+    { "equiprobable",   BENCH_GEN_RANDOM,     0.5,   16,   0,  0.0,  0.0  }, 
+    { "skewed",         BENCH_GEN_RANDOM,     0.05,  16,   0,  0.0,  0.0  }, 
+    { "very_skewed",    BENCH_GEN_RANDOM,     0.005, 16,   0,  0.0,  0.0  }, 
+    { "many_contexts",  BENCH_GEN_RANDOM,     0.1,   1024, 0,  0.0,  0.0  }, 
+    { "mixed_ep",       BENCH_GEN_RANDOM,     0.1,   16,   0,  0.3,  0.0  }, 
+    { "bypass",         BENCH_GEN_RANDOM,     0.5,   1,    0,  1.0,  0.0  }, 
+    { "terminate",      BENCH_GEN_RANDOM,     0.5,   1,    0,  0.0,  1.0  }, 
+    { "mixed_all",      BENCH_GEN_RANDOM,     0.1,   64,   0,  0.2,  0.05 },
+    { "lps_high_state", BENCH_GEN_LPS,        0.0,   0,    62, 0.0,  0.0  }, 
+    { "lps_shift6",     BENCH_GEN_LPS_SHIFT6, 0.0,   16,   0,  0.0,  0.0  }, 
+    { "ff_run",         BENCH_GEN_FF_RUN,     0.0,   1,    0,  1.0,  0.0  }
+  };
+  vector<BenchResult> results;
+
+  for (size_t k = 0; k < sizeof(scenarios) / sizeof(scenarios[0]); k++)
+  {
+    const BenchScenario &s = scenarios[k];
+    vector<BenchBin> bins(numBins);
+    xGenerateBins(s, bins);
+
+    CABAC_BitstreamMemory outStream, outStream64, outStreamDual;
+    vector<unsigned char> callbackBytes, ringBufferBytes;
+    double tEnc = 0, tEnc64 = 0, tEncDual = 0, tCallback = 0, tRingBuffer = 0, tRef = 0, tPacked = 0, tDual = 0;
+    bool bRefOk = true, bPackedOk = true, bDualOk = true, bCallbackOk = true, bRingBufferOk = true;
+    for (int r = 0; r < s_iRepetitions; r++)
+    {
+      bool bOk;
+      xMinTime(tEnc, xEncode<CABAC_ArithmeticEncoderMemory, ContextModel>(s, bins, outStream), r);
+      xMinTime(tEnc64, xEncode<CABAC_ArithmeticEncoder64Memory, ContextModel>(s, bins, outStream64), r);
+      xMinTime(tEncDual, xEncode<CABAC_ArithmeticEncoder64Memory, ContextModelDualRate>(s, bins, outStreamDual), r);
+      xMinTime(tCallback, xEncodeStreaming<false>(s, bins, callbackBytes), r);
+      bCallbackOk = bCallbackOk && xEqual(outStream, callbackBytes);
+      xMinTime(tRingBuffer, xEncodeStreaming<true>(s, bins, ringBufferBytes), r);
+      bRingBufferOk = bRingBufferOk && xEqual(outStream, ringBufferBytes);
+      xMinTime(tRef, xDecode<ContextModel, false>(s, outStream, bins, bOk), r);
+      bRefOk = bRefOk && bOk;
+      xMinTime(tPacked, xDecode<ContextModel, true>(s, outStream, bins, bOk), r);
+      bPackedOk = bPackedOk && bOk;
+      xMinTime(tDual, xDecode<ContextModelDualRate, false>(s, outStreamDual, bins, bOk), r);
+      bDualOk = bDualOk && bOk;
+    }
+
+    const BenchResult r[] = 
+    {
+      { s.name, "encode", "encoder",         "hevc",     numBins, outStream.getNumBytes(),     tEnc,     true },
+      { s.name, "encode", "encoder64",       "hevc",     numBins, outStream64.getNumBytes(),   tEnc64,   xEqual(outStream, outStream64) },
+      { s.name, "encode", "encoder64",       "dualRate", numBins, outStreamDual.getNumBytes(), tEncDual, true },
+      { s.name, "encode", "sinkCallback",    "hevc",     numBins, callbackBytes.size(),        tCallback,   bCallbackOk },
+      { s.name, "encode", "sinkRingBuffer",  "hevc",     numBins, ringBufferBytes.size(),      tRingBuffer, bRingBufferOk },
+      { s.name, "decode", "decodeBin",       "hevc",     numBins, outStream.getNumBytes(),     tRef,     bRefOk },
+      { s.name, "decode", "decodeBinPacked", "hevc",     numBins, outStream.getNumBytes(),     tPacked,  bPackedOk },
+      { s.name, "decode", "decodeBin",       "dualRate", numBins, outStreamDual.getNumBytes(), tDual,    bDualOk }
+    };
+    results.insert(results.end(), r, r + sizeof(r) / sizeof(r[0]));
+  }
+
+  // Bypass words of 1 to 32 bins
+  unsigned int uiSeed = 1;
+  size_t numBypassBins = 0;
+  vector<unsigned int> words, decodedWords;
+  vector<unsigned char> lengths;
+  while (numBypassBins < numBins)
+  {
+    unsigned char length = (unsigned char)(1 + xRandom(uiSeed) % 32);
+    unsigned int uiWord = (xRandom(uiSeed) << 16) ^ xRandom(uiSeed);
+    words.push_back(length < 32 ? uiWord & ((1u << length) - 1) : uiWord);
+    lengths.push_back(length);
+    numBypassBins += length;
+  }
+  decodedWords.resize(words.size());
+
+  CABAC_BitstreamMemory outStream, outStream64;
+  double tEnc = 0, tEnc64 = 0, tSingle = 0, tWide = 0;
+  bool bSingleOk = true, bWideOk = true;
+  for (int r = 0; r < s_iRepetitions; r++)
+  {
+    xMinTime(tEnc, xEncodeEP<CABAC_ArithmeticEncoderMemory>(words, lengths, outStream), r);
+    xMinTime(tEnc64, xEncodeEP<CABAC_ArithmeticEncoder64Memory>(words, lengths, outStream64), r);
+    xMinTime(tSingle, xDecodeEP<true>(outStream, lengths, decodedWords), r);
+    bSingleOk = bSingleOk && (decodedWords == words);
+    xMinTime(tWide, xDecodeEP<false>(outStream, lengths, decodedWords), r);
+    bWideOk = bWideOk && (decodedWords == words);
+  }
+  const BenchResult r[] = 
+  {
+    { "bypass_words", "encode", "encodeBinsEP",   "-", numBypassBins, outStream.getNumBytes(), tEnc,    true },
+    { "bypass_words", "encode", "encodeBinsEP64", "-", numBypassBins, outStream.getNumBytes(), tEnc64,  xEqual(outStream, outStream64) },
+    { "bypass_words", "decode", "decodeBinEP",    "-", numBypassBins, outStream.getNumBytes(), tSingle, bSingleOk },
+    { "bypass_words", "decode", "decodeBinsEP",   "-", numBypassBins, outStream.getNumBytes(), tWide,   bWideOk }
+  };
+  results.insert(results.end(), r, r + sizeof(r) / sizeof(r[0]));
+
+  int iResult = 0;
+  if (bJson)
+  {
+    printf("[");
+  }
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    xReport(results[i], bJson, i == 0);
+    if (!results[i].ok)
+    {
+      iResult = 1;
+    }
+  }
+  xReportWorstCase(results, bJson);
+  if (bJson)
+  {
+    printf("\n]\n");
+  }
+  return iResult;
+}
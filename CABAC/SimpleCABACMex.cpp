@@ -38,21 +38,47 @@
 #include <stdint.h>
 #include <fstream>
 #include <list>
+#include <map>
 #include <math.h>
 #include <assert.h>
 #include <vector>
 #include <bitset>
 #include <string>
+#include <string.h>
 #include "CABAC_ArithmeticEncoder.h"
+#include "CABAC_ArithmeticEncoder64.h"
 #include "CABAC_ArithmeticDecoder.h"
 #include "CABAC_BitstreamFile.h"
+#include "CABAC_BitstreamMemory.h"
+#include "CABAC_BitstreamMmap.h"
 #include "ContextModel.h"
 #include "CABAC_ContextModelsInit.h"
+#include "CABAC_Trace.h"
+#include "CABAC_ThreadPool.h"
+#include "CABAC_Substreams.h"
+#include "CABAC_Wavefront.h"
+#include "CABAC_Binarizer.h"
+#include "CABAC_MatrixCoder.h"
+#include "CABAC_RateEstimator.h"
+#include "CABAC_ConfigSearch.h"
+#include "CABAC_EncoderCheckpoint.h"
+#include "CABAC_BinCapture.h"
 
 #include "CABAC_ArithmeticEncoder.cpp"
+#include "CABAC_ArithmeticEncoder64.cpp"
 #include "CABAC_ArithmeticDecoder.cpp"
 #include "CABAC_BitstreamFile.cpp"
+#include "CABAC_BitstreamMemory.cpp"
+#include "CABAC_BitstreamMmap.cpp"
 #include "CABAC_ContextModelsInit.cpp"
+#include "CABAC_Trace.cpp"
+#include "CABAC_ThreadPool.cpp"
+#include "CABAC_Substreams.cpp"
+#include "CABAC_Wavefront.cpp"
+#include "CABAC_Binarizer.cpp"
+#include "CABAC_MatrixCoder.cpp"
+#include "CABAC_ConfigSearch.cpp"
+#include "CABAC_BinCapture.cpp"
 #include "ContextModel.cpp"
 
 
@@ -63,39 +89,874 @@ void _main();
 // this is the CABAC base class, which contains the encoder and decoder and all models used by them
 // coding can be done using a specific contexts
 // this class can be easily modified if more contexts are needed
-// output bits are written into or input bits are read from a CABAC_BitstreamFile
+// the encoder (64 bit low register variant) writes into a CABAC_BitstreamMemory, which is stored to the file at the end 
+// or returned if the filename is empty. The decoder reads from a CABAC_BitstreamMmap, 
+// which maps the file or holds a copy of the given bytes if the filename is empty.
+// Using concrete bitstream classes lets the compiler inline the byte input / output.
+// The state statistics of the encoder and decoder contexts are only collected after 
+// setTraceMode, see CABAC_Trace.
+// Between encodeStart and encodeFinish, the encoder state can be saved with saveState and 
+// restored with loadState (see CABAC_EncoderCheckpoint).
+// After setCapture, the bins coded by the encoder are recorded into a file (see CABAC_BinCapture).
 
 // TODO: make the CABAC class a singleton implementation
 class CABAC {
 public:
-  CABAC() {};
+  CABAC() : bEncoding(false), uiEncodeCount(0) {};
   ~CABAC() {};
   std::string fn;
   bool bFileNameIsSet;
-  CABAC_BitstreamFile bitStream;
+  std::ofstream outFile;
+  CABAC_BitstreamMemory outStream;
+  CABAC_BitstreamMmap inStream;
   CABAC_ContextModels encoderModels;
   CABAC_ContextModels decoderModels;
-  CABAC_ArithmeticEncoder encoder;
-  CABAC_ArithmeticDecoder decoder;
+  CABAC_ArithmeticEncoder64Memory encoder;
+  CABAC_ArithmeticDecoderMmap decoder;
+  CABAC_Trace encoderTrace;
+  CABAC_Trace decoderTrace;
+  CABAC_ThreadPool threadPool;   // codes the substreams
+  std::vector<ContextModel> wavefrontContexts;  // decoder contexts stored by wavefrontSync
+  TCABAC_EncoderCheckpoint<CABAC_ArithmeticEncoder64Memory> checkpoint;  // used by saveState / loadState
+  bool bEncoding;              // between encodeStart and encodeFinish
+  uint32_t uiEncodeCount;      // number of encodeStart calls, a saved state only fits the encoding it was saved in
+  CABAC_BinCapture capture;    // records the bins of every encoding if open
+
+  bool isInMemory() { return fn.empty(); }
+
+  // close the streams and set the contexts back to their initialization, the traces are cleared
+  void reset()
+  {
+    if (outFile.is_open())
+    {
+      outFile.close();
+    }
+    outStream.close();
+    inStream.closeFile();
+    encoderModels.resetContextModels();
+    decoderModels.resetContextModels();
+    encoderTrace.reset();
+    decoderTrace.reset();
+    wavefrontContexts.clear();
+    if (bEncoding && capture.isOpen())
+    {
+      // the encoding is dropped without its coded bytes
+      capture.finishStream(NULL, 0);
+    }
+    bEncoding = false;
+  }
 };
 
+// the sessions handed out to MATLAB. A handle is a number which is never given out twice, 
+// so a handle of a destroyed session is rejected instead of accessing freed memory.
+// Destroyed sessions are kept in s_sessionPool (up to RWTH_CABAC_MAX_POOLED_SESSIONS) and
+// reused by the next init, so that repeated init / destroy cycles keep their allocated buffers.
+static std::map<uint32_t, CABAC*> s_sessions;
+static std::vector<CABAC*> s_sessionPool;
+static uint32_t s_uiNextHandle = 1;
+
+// delete all sessions when the MEX file is cleared
+static void xFreeSessions()
+{
+  for (std::map<uint32_t, CABAC*>::iterator it = s_sessions.begin(); it != s_sessions.end(); ++it)
+  {
+    delete it->second;
+  }
+  s_sessions.clear();
+  for (size_t i = 0; i < s_sessionPool.size(); i++)
+  {
+    delete s_sessionPool[i];
+  }
+  s_sessionPool.clear();
+}
 
-// function to retrieve the CABAC instance
+// take a session from the pool or allocate a new one and register it, returns the handle
+static uint32_t xCreateSession(CABAC *&c)
+{
+  if (s_sessions.empty() && s_sessionPool.empty())
+  {
+    mexAtExit(xFreeSessions);
+  }
+  if (s_sessionPool.empty())
+  {
+    c = new CABAC;
+  }
+  else
+  {
+    c = s_sessionPool.back();
+    s_sessionPool.pop_back();
+  }
+  uint32_t handle = s_uiNextHandle++;
+  s_sessions[handle] = c;
+  return handle;
+}
+
+// unregister a session and put it back into the pool
+static void xDestroySession(uint32_t handle)
+{
+  std::map<uint32_t, CABAC*>::iterator it = s_sessions.find(handle);
+  CABAC *c = it->second;
+  s_sessions.erase(it);
+  c->reset();
+  c->capture.close();
+  // release the trace memory, the next user of the session chooses its own trace mode
+  c->encoderTrace.init(0, CABAC_TRACE_OFF);
+  c->decoderTrace.init(0, CABAC_TRACE_OFF);
+  if (s_sessionPool.size() < RWTH_CABAC_MAX_POOLED_SESSIONS)
+  {
+    s_sessionPool.push_back(c);
+  }
+  else
+  {
+    delete c;
+  }
+}
+
+// the handle given in prhs[1], or 0 if it is not a scalar
+static uint32_t xGetHandle(const mxArray *prhs[])
+{
+  if (!mxIsDouble(prhs[1]) || mxGetNumberOfElements(prhs[1]) != 1)
+  {
+    return 0;
+  }
+  double value = mxGetScalar(prhs[1]);
+  if (value < 1 || value >= 4294967296.0 || value != (double)(uint32_t)value)
+  {
+    return 0;
+  }
+  return (uint32_t)value;
+}
+
+
+// function to retrieve the CABAC instance of the handle
 static CABAC* getPointer(const mxArray *prhs[])
 {
-  uintptr_t c_value = *mxGetPr(prhs[1]);
-  CABAC *c_pointer =  (CABAC *)c_value;
-  if (c_pointer==NULL)
+  std::map<uint32_t, CABAC*>::iterator it = s_sessions.find(xGetHandle(prhs));
+  if (it == s_sessions.end())
   {
-    mexErrMsgTxt("Error: No initialized CABAC instance provided \n");
-    assert(c_pointer);
+    mexErrMsgTxt("Error: No initialized CABAC instance provided, the handle is invalid or was destroyed \n");
   }
 #if RWTH_CABAC_DEBUG_OUTPUT && 0
-  mexPrintf("Status: CABAC pointer retrived in CPP, Pointer address: %p\n", c_pointer );
+  mexPrintf("Status: CABAC pointer retrived in CPP, Pointer address: %p\n", it->second );
 #endif
-  return c_pointer;
+  return it->second;
 };
 
+// the substreams, the wavefront, the rate estimation and the encoder states copy or estimate
+// the contexts as ContextModel, they are not available with the dual-rate model. Neither is
+// the trace, its transition statistics are the ones of the ContextModel state machine
+static void xCheckHevcModel(CABAC *c)
+{
+  if (c->encoderModels.getProbabilityModel() != CABAC_PROB_HEVC)
+  {
+    mexErrMsgTxt("Error: this command is only available with the HEVC probability model\n");
+  }
+}
+
+// the substreams and the wavefront are coded by their own encoders and loadState takes back 
+// coded bins, so they can not be captured
+static void xCheckNoCapture(CABAC *c)
+{
+  if (c->capture.isOpen())
+  {
+    mexErrMsgTxt("Error: this command can not be captured, stop the capture with setCapture first\n");
+  }
+}
+
+// the probability model named by arg ('hevc' or 'dualRate'), returns false for an unknown name
+static bool xGetProbabilityModel(const mxArray *arg, CABAC_ProbabilityModel &eModel)
+{
+  char name[16];
+  if (!mxIsChar(arg) || mxGetString(arg, name, sizeof(name)))
+  {
+    return false;
+  }
+  if (!strcmp(name, "hevc"))
+  {
+    eModel = CABAC_PROB_HEVC;
+  }
+  else if (!strcmp(name, "dualRate"))
+  {
+    eModel = CABAC_PROB_DUAL_RATE;
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+// record the start of an encoding with the current encoder contexts
+static void xCaptureStart(CABAC *c)
+{
+  if (c->bEncoding)
+  {
+    // the previous encoding was started again without encodeFinish
+    c->capture.finishStream(NULL, 0);
+  }
+  if (c->encoderModels.getProbabilityModel() == CABAC_PROB_DUAL_RATE)
+  {
+    std::vector<ContextModelDualRate> models;
+    c->encoderModels.getDualRateModels(models);
+    c->capture.startStream(models);
+  }
+  else
+  {
+    std::vector<ContextModel> models;
+    c->encoderModels.getContextModels(models);
+    c->capture.startStream(models);
+  }
+}
+
+// open the output (the file if the filename is set) and start the encoder
+static void xEncodeStart(CABAC *c)
+{
+  // open bitstream for writing
+  c->outStream.openOutput();
+  if (!c->isInMemory())
+  {
+    c->outFile.open(c->fn.c_str(), std::ofstream::binary | std::ofstream::out);
+  }
+  if (!c->isInMemory() && !c->outFile) 
+  {
+    mexPrintf("Error: filename %s cannot be opened for writing\n", c->fn.c_str());
+    mexErrMsgTxt("Error: bitstreamfile access error\n");
+  }
+#if RWTH_CABAC_DEBUG_OUTPUT
+  mexPrintf("Status: filename: %s opened for writing\n", c->fn.c_str());
+#endif
+  // set bitstream to encoder
+  c->encoder.setBitstream(&(c->outStream));
+  if (c->capture.isOpen())
+  {
+    xCaptureStart(c);
+  }
+  // start the encoder
+  c->encoder.start();
+  c->bEncoding = true;
+  c->uiEncodeCount++;
+}
+
+// finish the encoder and return the coded bytes in plhs[0] or write them to the file
+static void xEncodeFinish(CABAC *c, mxArray *plhs[])
+{
+  c->encoder.finish();
+  c->bEncoding = false;
+  if (c->capture.isOpen())
+  {
+    c->capture.finishStream(c->outStream.getData(), c->outStream.getNumBytes());
+  }
+#if RWTH_CABAC_DEBUG_OUTPUT
+  mexPrintf("Status: number of written bits: %d\n", c->outStream.getNumberOfWrittenBits());
+#endif
+  if (c->isInMemory())
+  {
+    // return the coded bytes
+    plhs[0] = mxCreateNumericMatrix(c->outStream.getNumBytes(), 1, mxUINT8_CLASS, mxREAL);
+    if (c->outStream.getNumBytes() > 0)
+    {
+      memcpy(mxGetData(plhs[0]), c->outStream.getData(), c->outStream.getNumBytes());
+    }
+  }
+  else
+  {
+    c->outFile.write((const char*)c->outStream.getData(), c->outStream.getNumBytes());
+    c->outFile.close();
+  }
+  c->outStream.close();
+#if RWTH_CABAC_DEBUG_OUTPUT
+  mexPrintf("Status: encoding finished, outstream closed\n");
+#endif
+}
+
+// the header of a state returned by saveState, followed by the serialized checkpoint
+struct CABAC_SavedStateHeader
+{
+  uint32_t uiMagic;
+  uint32_t uiHandle;
+  uint32_t uiEncodeCount;
+};
+static const uint32_t s_uiSavedStateMagic = 0x53424143; // "CABS"
+
+// return the encoder state (engine, contexts and output position) as uint8 array in plhs[0]
+static void xSaveState(CABAC *c, uint32_t handle, mxArray *plhs[])
+{
+  if (!c->bEncoding)
+  {
+    mexErrMsgTxt("Error: the encoder state can only be saved between encodeStart and encodeFinish\n");
+  }
+  c->checkpoint.save(c->encoder, c->outStream, c->encoderModels);
+  CABAC_SavedStateHeader header = { s_uiSavedStateMagic, handle, c->uiEncodeCount };
+  plhs[0] = mxCreateNumericMatrix(sizeof(header) + c->checkpoint.getNumBytes(), 1, mxUINT8_CLASS, mxREAL);
+  unsigned char *pData = (unsigned char*)mxGetData(plhs[0]);
+  memcpy(pData, &header, sizeof(header));
+  c->checkpoint.write(pData + sizeof(header));
+}
+
+// continue encoding from a state returned by saveState, the output written after it is dropped
+static void xLoadState(CABAC *c, uint32_t handle, const mxArray *state)
+{
+  if (!c->bEncoding)
+  {
+    mexErrMsgTxt("Error: the encoder state can only be loaded between encodeStart and encodeFinish\n");
+  }
+  CABAC_SavedStateHeader header;
+  if (!mxIsUint8(state) || mxGetNumberOfElements(state) < sizeof(header))
+  {
+    mexErrMsgTxt("Error: invalid input 3, provide a state returned by saveState\n");
+  }
+  const unsigned char *pData = (const unsigned char*)mxGetData(state);
+  memcpy(&header, pData, sizeof(header));
+  if (header.uiMagic != s_uiSavedStateMagic || header.uiHandle != handle || header.uiEncodeCount != c->uiEncodeCount)
+  {
+    mexErrMsgTxt("Error: invalid input 3, the state was not saved during the current encoding of this instance\n");
+  }
+  if (!c->checkpoint.read(pData + sizeof(header), mxGetNumberOfElements(state) - sizeof(header)) 
+      || !c->checkpoint.restore(c->encoder, c->outStream, c->encoderModels))
+  {
+    mexErrMsgTxt("Error: invalid input 3, the state does not fit the contexts or the bytes written so far\n");
+  }
+}
+
+// open the coded bytes (uint8 array) if decoding from memory, otherwise the file of the session
+static void xOpenInput(CABAC *c, const mxArray *bytes)
+{
+  if (c->isInMemory())
+  {
+    if (!bytes || !mxIsUint8(bytes))
+    {
+      mexErrMsgTxt("Error: provide the coded bytes as uint8 array when decoding from memory (empty filename)\n");
+    }
+    // copy the bytes, the MATLAB array is not guaranteed to live until decodeFinish
+    c->inStream.openInputBuffer((const unsigned char*)mxGetData(bytes), mxGetNumberOfElements(bytes));
+  }
+  else if (!c->inStream.openInputFile(c->fn.c_str())) 
+  {
+    mexPrintf("Error: filename %s cannot be opened for reading\n", c->fn.c_str());
+    mexErrMsgTxt("Error: bitstreamfile access error\n");
+  }
+#if RWTH_CABAC_DEBUG_OUTPUT
+  mexPrintf("Status: filename %s opened for reading\n", c->fn.c_str());
+#endif
+}
+
+// the coding loop of xEncodeBins, without any tracing code if bTrace is false
+template <bool bTrace, class TModel, typename TBin, typename TCtx>
+static void xEncodeBinsLoop(CABAC *c, const TBin *bins, const TCtx *ctxIdx, size_t numBins)
+{
+  for (size_t i = 0; i < numBins; i++)
+  {
+    unsigned int encodedBin = static_cast<unsigned int>(bins[i]);
+    int ctx_idx = static_cast<int>(ctxIdx[i]);
+    TModel *ctx = c->encoderModels.getModel<TModel>(ctx_idx);
+    unsigned char ucStateIdx = ctx->getStateIdx();
+    c->encoder.encodeBin(encodedBin, ctx);
+    if (bTrace)
+    {
+      c->encoderTrace.addStep(ctx_idx, encodedBin, ucStateIdx, ctx->getStateIdx());
+    }
+  }
+}
+
+// xEncodeBinsLoop for the probability model and the trace mode of the session, the input is not checked
+template <typename TBin, typename TCtx>
+static void xEncodeBinsChecked(CABAC *c, const TBin *bins, const TCtx *ctxIdx, size_t numBins)
+{
+  if (c->capture.isOpen())
+  {
+    c->capture.addBins(bins, ctxIdx, numBins);
+  }
+  const bool bTrace = c->encoderTrace.getMode() != CABAC_TRACE_OFF;
+  if (c->encoderModels.getProbabilityModel() == CABAC_PROB_DUAL_RATE)
+  {
+    // setTraceMode does not trace the dual-rate model
+    xEncodeBinsLoop<false, ContextModelDualRate>(c, bins, ctxIdx, numBins);
+  }
+  else
+  {
+    bTrace ? xEncodeBinsLoop<true, ContextModel>(c, bins, ctxIdx, numBins)
+           : xEncodeBinsLoop<false, ContextModel>(c, bins, ctxIdx, numBins);
+  }
+}
+
+// encode numBins bins, bins[i] is coded into context ctxIdx[i]
+template <typename TBin, typename TCtx>
+static void xEncodeBins(CABAC *c, const TBin *bins, const TCtx *ctxIdx, size_t numBins)
+{
+  const int numContextModels = c->encoderModels.getNumContextModels();
+  // check the complete input first, so that a bad entry does not leave a half coded vector behind
+  for (size_t i = 0; i < numBins; i++)
+  {
+    if (bins[i] != 0 && bins[i] != 1)
+    {
+      mexErrMsgTxt("Error: invalid input 3, bins to be encoded should either be 1 or 0\n");
+    }
+    // NaN and non-integer indices of a double input are rejected as well
+    if (!(ctxIdx[i] >= 0) || ctxIdx[i] >= numContextModels || ctxIdx[i] != floor(ctxIdx[i]))
+    {
+      mexErrMsgTxt("Error: invalid input 4, context index out of range\n");
+    }
+  }
+
+  xEncodeBinsChecked(c, bins, ctxIdx, numBins);
+}
+
+// resolve the class of the context index vector
+template <typename TBin>
+static void xEncodeBins(CABAC *c, const TBin *bins, const mxArray *ctxIdx, size_t numBins)
+{
+  switch (mxGetClassID(ctxIdx))
+  {
+  case mxDOUBLE_CLASS: xEncodeBins(c, bins, (const double*)mxGetData(ctxIdx), numBins);  break;
+  case mxUINT8_CLASS:  xEncodeBins(c, bins, (const uint8_t*)mxGetData(ctxIdx), numBins); break;
+  case mxINT32_CLASS:  xEncodeBins(c, bins, (const int32_t*)mxGetData(ctxIdx), numBins); break;
+  default:
+    mexErrMsgTxt("Error: invalid input 4, context indices must be double, uint8 or int32\n");
+  }
+}
+
+// the decoding loop of xDecodeBins, without any tracing code if bTrace is false
+template <bool bTrace, class TModel, typename TCtx>
+static void xDecodeBinsLoop(CABAC *c, const TCtx *ctxIdx, uint8_t *bins, size_t numBins)
+{
+  for (size_t i = 0; i < numBins; i++)
+  {
+    unsigned int decodedBin = 0;
+    int ctx_idx = static_cast<int>(ctxIdx[i]);
+    TModel *ctx = c->decoderModels.getModel<TModel>(ctx_idx);
+    unsigned char ucStateIdx = ctx->getStateIdx();
+#if RWTH_CABAC_PACKED_DECODER
+    c->decoder.decodeBinPacked(decodedBin, ctx);
+#else
+    c->decoder.decodeBin(decodedBin, ctx);
+#endif
+    if (bTrace)
+    {
+      c->decoderTrace.addStep(ctx_idx, decodedBin, ucStateIdx, ctx->getStateIdx());
+    }
+    bins[i] = static_cast<uint8_t>(decodedBin);
+  }
+}
+
+// xDecodeBinsLoop for the probability model and the trace mode of the session, the input is not checked
+template <typename TCtx>
+static void xDecodeBinsChecked(CABAC *c, const TCtx *ctxIdx, uint8_t *bins, size_t numBins)
+{
+  const bool bTrace = c->decoderTrace.getMode() != CABAC_TRACE_OFF;
+  if (c->decoderModels.getProbabilityModel() == CABAC_PROB_DUAL_RATE)
+  {
+    // setTraceMode does not trace the dual-rate model
+    xDecodeBinsLoop<false, ContextModelDualRate>(c, ctxIdx, bins, numBins);
+  }
+  else
+  {
+    bTrace ? xDecodeBinsLoop<true, ContextModel>(c, ctxIdx, bins, numBins)
+           : xDecodeBinsLoop<false, ContextModel>(c, ctxIdx, bins, numBins);
+  }
+}
+
+// decode numBins bins, bin i is decoded from context ctxIdx[i]
+template <typename TCtx>
+static void xDecodeBins(CABAC *c, const TCtx *ctxIdx, uint8_t *bins, size_t numBins)
+{
+  const int numContextModels = c->decoderModels.getNumContextModels();
+  for (size_t i = 0; i < numBins; i++)
+  {
+    if (!(ctxIdx[i] >= 0) || ctxIdx[i] >= numContextModels || ctxIdx[i] != floor(ctxIdx[i]))
+    {
+      mexErrMsgTxt("Error: invalid input 3, context index out of range\n");
+    }
+  }
+
+  xDecodeBinsChecked(c, ctxIdx, bins, numBins);
+}
+
+// copy and check the bins of a substream command
+template <typename TBin>
+static void xCopyBins(const TBin *src, size_t numBins, std::vector<uint8_t> &bins)
+{
+  bins.resize(numBins);
+  for (size_t i = 0; i < numBins; i++)
+  {
+    if (src[i] != 0 && src[i] != 1)
+    {
+      mexErrMsgTxt("Error: invalid input 3, bins to be encoded should either be 1 or 0\n");
+    }
+    bins[i] = static_cast<uint8_t>(src[i]);
+  }
+}
+
+static void xCopyBins(const mxArray *src, std::vector<uint8_t> &bins)
+{
+  switch (mxGetClassID(src))
+  {
+  case mxDOUBLE_CLASS:  xCopyBins((const double*)mxGetData(src), mxGetNumberOfElements(src), bins);  break;
+  case mxLOGICAL_CLASS: xCopyBins((const uint8_t*)mxGetData(src), mxGetNumberOfElements(src), bins); break;
+  case mxUINT8_CLASS:   xCopyBins((const uint8_t*)mxGetData(src), mxGetNumberOfElements(src), bins); break;
+  case mxINT32_CLASS:   xCopyBins((const int32_t*)mxGetData(src), mxGetNumberOfElements(src), bins); break;
+  default:
+    mexErrMsgTxt("Error: invalid input 3, bins must be double, logical, uint8 or int32\n");
+  }
+}
+
+// copy and check the context indices of a substream command
+template <typename TCtx>
+static void xCopyContexts(const TCtx *src, size_t numBins, int numContextModels, std::vector<int32_t> &ctxIdx)
+{
+  ctxIdx.resize(numBins);
+  for (size_t i = 0; i < numBins; i++)
+  {
+    // checked before the cast, NaN and non-integer indices of a double input are rejected
+    if (!(src[i] >= 0) || src[i] >= numContextModels || src[i] != floor(src[i]))
+    {
+      mexErrMsgTxt("Error: invalid input, context index out of range\n");
+    }
+    ctxIdx[i] = static_cast<int32_t>(src[i]);
+  }
+}
+
+static void xCopyContexts(const mxArray *src, int numContextModels, std::vector<int32_t> &ctxIdx)
+{
+  switch (mxGetClassID(src))
+  {
+  case mxDOUBLE_CLASS: xCopyContexts((const double*)mxGetData(src), mxGetNumberOfElements(src), numContextModels, ctxIdx);  break;
+  case mxUINT8_CLASS:  xCopyContexts((const uint8_t*)mxGetData(src), mxGetNumberOfElements(src), numContextModels, ctxIdx); break;
+  case mxINT32_CLASS:  xCopyContexts((const int32_t*)mxGetData(src), mxGetNumberOfElements(src), numContextModels, ctxIdx); break;
+  default:
+    mexErrMsgTxt("Error: invalid input, context indices must be double, uint8 or int32\n");
+  }
+}
+
+// the (0-based) first bin of every substream followed by numBins
+static void xGetFirstBins(const mxArray *src, size_t numBins, std::vector<size_t> &firstBin)
+{
+  if (!mxIsDouble(src) || mxGetNumberOfElements(src) == 0)
+  {
+    mexErrMsgTxt("Error: invalid input, provide the first bin of every substream as double vector\n");
+  }
+  const double *first = mxGetPr(src);
+  size_t numSubstreams = mxGetNumberOfElements(src);
+  firstBin.resize(numSubstreams + 1);
+  for (size_t i = 0; i < numSubstreams; i++)
+  {
+    if ((i == 0 && first[i] != 0) || (i > 0 && first[i] < first[i - 1]) || first[i] > numBins || first[i] != (double)(size_t)first[i])
+    {
+      mexErrMsgTxt("Error: invalid input, the first bins of the substreams must start at 0 and be non-decreasing\n");
+    }
+    firstBin[i] = (size_t)first[i];
+  }
+  firstBin[numSubstreams] = numBins;
+}
+
+// the (0-based) first bin after the sync row of every column, see CABAC_Wavefront
+static void xGetSyncBins(const mxArray *src, const std::vector<size_t> &firstBin, std::vector<size_t> &syncBin)
+{
+  if (!mxIsDouble(src) || mxGetNumberOfElements(src) != firstBin.size() - 1)
+  {
+    mexErrMsgTxt("Error: invalid input, provide the sync bin of every column as double vector\n");
+  }
+  const double *sync = mxGetPr(src);
+  syncBin.resize(firstBin.size() - 1);
+  for (size_t k = 0; k < syncBin.size(); k++)
+  {
+    if (sync[k] < firstBin[k] || sync[k] > firstBin[k + 1] || sync[k] != (double)(size_t)sync[k])
+    {
+      mexErrMsgTxt("Error: invalid input, the sync bin of a column must be within the column\n");
+    }
+    syncBin[k] = (size_t)sync[k];
+  }
+}
+
+// the number of bits of the bins coded as a single stream, to measure the cost of substreams
+static double xCountSingleStreamBits(std::vector<ContextModel> models, const std::vector<uint8_t> &bins, const std::vector<int32_t> &ctxIdx)
+{
+  CABAC_BitstreamNull nullStream;
+  CABAC_ArithmeticEncoder64Null nullEncoder(&nullStream);
+  nullEncoder.start();
+  for (size_t i = 0; i < bins.size(); i++)
+  {
+    nullEncoder.encodeBin(bins[i], &models[ctxIdx[i]]);
+  }
+  nullEncoder.finish();
+  return nullStream.getNumberOfWrittenBits();
+}
+
+// estimate the bins with the rate estimator, the estimated bits of every context are added to ctxFracBits
+static void xEstimateBinsLoop(CABAC_RateEstimator &estimator, std::vector<ContextModel> &models, const uint8_t *bins, const int32_t *ctxIdx, 
+                              size_t numBins, std::vector<uint64_t> &ctxFracBits)
+{
+  for (size_t i = 0; i < numBins; i++)
+  {
+    uint64_t fracBits = estimator.getFracBits();
+    estimator.encodeBin(bins[i], &models[ctxIdx[i]]);
+    ctxFracBits[ctxIdx[i]] += estimator.getFracBits() - fracBits;
+  }
+}
+
+// the estimated bits and (if requested) the estimated bits of every context of estimateBits
+static void xReturnEstimate(const CABAC_RateEstimator &estimator, const std::vector<uint64_t> &ctxFracBits, int nlhs, mxArray *plhs[])
+{
+  plhs[0] = mxCreateDoubleMatrix(1, 1, mxREAL);
+  *mxGetPr(plhs[0]) = estimator.getNumBits();
+  if (nlhs > 1)
+  {
+    plhs[1] = mxCreateDoubleMatrix(1, ctxFracBits.size(), mxREAL);
+    for (size_t i = 0; i < ctxFracBits.size(); i++)
+    {
+      mxGetPr(plhs[1])[i] = ctxFracBits[i] / 32768.0;
+    }
+  }
+}
+
+// the coded bytes and the bits of every substream (if requested) of encodeSubstreams and encodeWavefront
+static void xReturnSubstreams(const std::vector<unsigned char> &coded, const std::vector<size_t> &substreamBytes, int nlhs, mxArray *plhs[])
+{
+  plhs[0] = mxCreateNumericMatrix(coded.size(), 1, mxUINT8_CLASS, mxREAL);
+  memcpy(mxGetData(plhs[0]), &coded[0], coded.size());
+  if (nlhs > 1)
+  {
+    plhs[1] = mxCreateDoubleMatrix(substreamBytes.size(), 1, mxREAL);
+    for (size_t i = 0; i < substreamBytes.size(); i++)
+    {
+      mxGetPr(plhs[1])[i] = 8.0 * substreamBytes[i];
+    }
+  }
+}
+
+// set the number of threads of the session from an optional input, 0 or missing uses all cores
+static void xInitThreadPool(CABAC *c, int nrhs, const mxArray *prhs[], int arg)
+{
+  int numThreads = (nrhs > arg) ? (int)mxGetScalar(prhs[arg]) : 0;
+  c->threadPool.init(numThreads);
+}
+
+// the number of quantization intervals Nq of a matrix command
+static unsigned int xGetNq(const mxArray *src)
+{
+  double Nq = mxGetScalar(src);
+  if (Nq < 1 || Nq > 4294967295.0 || Nq != floor(Nq))
+  {
+    mexErrMsgTxt("Error: invalid input, Nq must be a positive integer\n");
+  }
+  return (unsigned int)Nq;
+}
+
+// set up the binarization and context selection of a matrix command from the inputs
+// Nq, binMethod, cmTypes and Nlbp starting at prhs[arg], the contexts must exist in the session
+static void xInitMatrixCoder(CABAC_MatrixCoder &coder, int numContextModels, const mxArray *prhs[], int arg)
+{
+  char method[16];
+  unsigned int uiNq = xGetNq(prhs[arg]);
+  double Nlbp = mxGetScalar(prhs[arg + 3]);
+  if (!mxIsClass(prhs[arg + 1], "char") || mxGetString(prhs[arg + 1], method, sizeof(method)) 
+      || Nlbp < 0 || Nlbp != floor(Nlbp) || !coder.init(method, uiNq, (int)Nlbp))
+  {
+    mexErrMsgTxt("Error: invalid input, binMethod must be DEC2TU, DEC2TR0...2, DEC2EG0...2 or DEC2FL32 and Nlbp a non-negative integer\n");
+  }
+  // cmTypes is a cell array of type names or a single name
+  const mxArray *types = prhs[arg + 2];
+  size_t numTypes = mxIsCell(types) ? mxGetNumberOfElements(types) : 1;
+  for (size_t i = 0; i < numTypes; i++)
+  {
+    char type[16];
+    const mxArray *name = mxIsCell(types) ? mxGetCell(types, i) : types;
+    if (!name || !mxIsClass(name, "char") || mxGetString(name, type, sizeof(type)) || !coder.addContextModelType(type))
+    {
+      mexErrMsgTxt("Error: invalid input, cmTypes may only contain cond0, cond1, condbinlft, conds0 and conds1\n");
+    }
+  }
+  if (coder.getNumContextModels() > numContextModels)
+  {
+    mexErrMsgTxt("Error: the session has less than 7*Nlbp+2 contexts\n");
+  }
+}
+
+// copy and check the quantization indices of a matrix command
+template <typename T>
+static void xGetMatrixValues(const T *src, size_t numValues, const CABAC_Binarizer &binarizer, std::vector<unsigned int> &values)
+{
+  values.resize(numValues);
+  for (size_t i = 0; i < numValues; i++)
+  {
+    const double value = (double)src[i];
+    if (!(value >= 0) || value >= (double)binarizer.getNq() || value != floor(value))
+    {
+      mexErrMsgTxt("Error: invalid input, the values must be integers between 0 and Nq-1\n");
+    }
+    values[i] = (unsigned int)src[i];
+  }
+}
+
+// resolve the class of the quantization index matrix
+static void xGetMatrixValues(const mxArray *src, const CABAC_Binarizer &binarizer, std::vector<unsigned int> &values)
+{
+  size_t numValues = mxGetNumberOfElements(src);
+  switch (mxGetClassID(src))
+  {
+  case mxDOUBLE_CLASS: xGetMatrixValues((const double*)mxGetData(src), numValues, binarizer, values);  break;
+  case mxUINT8_CLASS:  xGetMatrixValues((const uint8_t*)mxGetData(src), numValues, binarizer, values); break;
+  case mxINT32_CLASS:  xGetMatrixValues((const int32_t*)mxGetData(src), numValues, binarizer, values); break;
+  default:
+    mexErrMsgTxt("Error: invalid input, the matrix must be double, uint8 or int32\n");
+  }
+}
+
+// the strings of a cell array or a single string, false if an element is no string
+static bool xGetStrings(const mxArray *src, std::vector<std::string> &strings)
+{
+  size_t numStrings = mxIsCell(src) ? mxGetNumberOfElements(src) : 1;
+  strings.resize(numStrings);
+  for (size_t i = 0; i < numStrings; i++)
+  {
+    const mxArray *str = mxIsCell(src) ? mxGetCell(src, i) : src;
+    char *buffer = (str && mxIsClass(str, "char")) ? mxArrayToString(str) : NULL;
+    if (!buffer)
+    {
+      return false;
+    }
+    strings[i] = buffer;
+    mxFree(buffer);
+  }
+  return true;
+}
+
+// the candidates of searchConfig starting at prhs[arg]: a list of binMethods, a list of cmTypes 
+// (a cell array of cmTypes, or a single cmTypes) and a vector of Nlbp
+static void xGetSearchCandidates(const mxArray *prhs[], int arg, std::vector<std::string> &binMethods, 
+                                 std::vector<std::vector<std::string> > &cmTypes, std::vector<int> &Nlbps)
+{
+  if (!xGetStrings(prhs[arg], binMethods) || binMethods.empty())
+  {
+    mexErrMsgTxt("Error: invalid input, provide the binMethods as cell array of strings\n");
+  }
+  const mxArray *types = prhs[arg + 1];
+  bool bList = mxIsCell(types) && mxGetNumberOfElements(types) > 0;
+  for (size_t i = 0; bList && i < mxGetNumberOfElements(types); i++)
+  {
+    bList = mxGetCell(types, i) && mxIsCell(mxGetCell(types, i));
+  }
+  cmTypes.resize(bList ? mxGetNumberOfElements(types) : 1);
+  for (size_t i = 0; i < cmTypes.size(); i++)
+  {
+    const mxArray *set = bList ? mxGetCell(types, i) : types;
+    if (mxIsCell(set) && mxGetNumberOfElements(set) == 0)
+    {
+      cmTypes[i].clear();
+    }
+    else if (!xGetStrings(set, cmTypes[i]))
+    {
+      mexErrMsgTxt("Error: invalid input, provide the cmTypes as cell array of cmTypes\n");
+    }
+  }
+  if (!mxIsDouble(prhs[arg + 2]) || mxGetNumberOfElements(prhs[arg + 2]) == 0)
+  {
+    mexErrMsgTxt("Error: invalid input, provide the Nlbp candidates as double vector\n");
+  }
+  Nlbps.resize(mxGetNumberOfElements(prhs[arg + 2]));
+  for (size_t i = 0; i < Nlbps.size(); i++)
+  {
+    double Nlbp = mxGetPr(prhs[arg + 2])[i];
+    if (!(Nlbp >= 0) || Nlbp > 1024 || Nlbp != floor(Nlbp))
+    {
+      mexErrMsgTxt("Error: invalid input, Nlbp must be a non-negative integer\n");
+    }
+    Nlbps[i] = (int)Nlbp;
+  }
+}
+
+// decode the columns of a matrix one after another, the bin strings end as detected by the coder
+template <bool bTrace, class TModel, typename T>
+static void xDecodeMatrixLoop(CABAC *c, CABAC_MatrixCoder &coder, size_t numRows, size_t numCols, T *values)
+{
+  for (size_t k = 0; k < numCols; k++)
+  {
+    coder.startColumn();
+    for (size_t d = 0; d < numRows; d++)
+    {
+      unsigned int decodedBin;
+      coder.startValue();
+      do
+      {
+        int ctx_idx = coder.getNextContext();
+        TModel *ctx = c->decoderModels.getModel<TModel>(ctx_idx);
+        unsigned char ucStateIdx = ctx->getStateIdx();
+#if RWTH_CABAC_PACKED_DECODER
+        c->decoder.decodeBinPacked(decodedBin, ctx);
+#else
+        c->decoder.decodeBin(decodedBin, ctx);
+#endif
+        if (bTrace)
+        {
+          c->decoderTrace.addStep(ctx_idx, decodedBin, ucStateIdx, ctx->getStateIdx());
+        }
+      } while (!coder.addBin(decodedBin));
+      values[k * numRows + d] = static_cast<T>(coder.getValue());
+    }
+  }
+}
+
+// resolve the probability model and the tracing of xDecodeMatrixLoop
+template <typename T>
+static void xDecodeMatrix(CABAC *c, CABAC_MatrixCoder &coder, size_t numRows, size_t numCols, T *values)
+{
+  const bool bTrace = c->decoderTrace.getMode() != CABAC_TRACE_OFF;
+  if (c->decoderModels.getProbabilityModel() == CABAC_PROB_DUAL_RATE)
+  {
+    // setTraceMode does not trace the dual-rate model
+    xDecodeMatrixLoop<false, ContextModelDualRate>(c, coder, numRows, numCols, values);
+  }
+  else
+  {
+    bTrace ? xDecodeMatrixLoop<true, ContextModel>(c, coder, numRows, numCols, values)
+           : xDecodeMatrixLoop<false, ContextModel>(c, coder, numRows, numCols, values);
+  }
+}
+
+// the values of a matrix decoded in parallel, in the class of xDecodeMatrix (see decodeMatrix)
+template <typename T>
+static mxArray* xCopyMatrix(const std::vector<unsigned int> &values, mxArray *G)
+{
+  T *dst = (T*)mxGetData(G);
+  for (size_t i = 0; i < values.size(); i++)
+  {
+    dst[i] = static_cast<T>(values[i]);
+  }
+  return G;
+}
+
+static mxArray* xCreateMatrix(const std::vector<unsigned int> &values, size_t numRows, size_t numCols, unsigned int uiNq)
+{
+  if (uiNq <= 256)
+  {
+    return xCopyMatrix<uint8_t>(values, mxCreateNumericMatrix(numRows, numCols, mxUINT8_CLASS, mxREAL));
+  }
+  else if (uiNq <= 0x80000000u)
+  {
+    return xCopyMatrix<int32_t>(values, mxCreateNumericMatrix(numRows, numCols, mxINT32_CLASS, mxREAL));
+  }
+  return xCopyMatrix<double>(values, mxCreateDoubleMatrix(numRows, numCols, mxREAL));
+}
+
+// the recorded steps (5 x N, empty unless tracing steps) and the 128 x 128 transition counts of a context
+static void xGetStats(const CABAC_Trace &trace, int ctx_idx, mxArray *plhs[])
+{
+  std::vector<CABACStep> steps;
+  trace.getSteps(ctx_idx, steps);
+  plhs[0] = mxCreateNumericMatrix(5, steps.size(), mxUINT8_CLASS, mxREAL);
+  uint8_t* out1Data = (uint8_t*)mxGetData(plhs[0]);
+  for (size_t entry = 0; entry < steps.size(); entry++)
+  {
+    out1Data[entry * 5 + 0] = steps[entry].codedBin;
+    out1Data[entry * 5 + 1] = steps[entry].state_p;
+    out1Data[entry * 5 + 2] = steps[entry].mps_p;
+    out1Data[entry * 5 + 3] = steps[entry].state_a;
+    out1Data[entry * 5 + 4] = steps[entry].mps_a;
+  }
+
+  plhs[1] = mxCreateNumericMatrix(RWTH_TRACE_CABAC_STATES_NUM_STATES, RWTH_TRACE_CABAC_STATES_NUM_STATES, mxUINT32_CLASS, mxREAL);
+  trace.getTransitions(ctx_idx, (unsigned int*)mxGetData(plhs[1]));
+}
+
 // the MEX interface function
 void mexFunction(
   int               nlhs, 		// Number of expected output mxArrays
@@ -110,7 +971,7 @@ void mexFunction(
 
   if (nrhs < 1 || !mxIsClass(prhs[0], "char") || mxGetString(prhs[0], cmd, sizeof(cmd))) 
   {
-    mexErrMsgTxt("Error: input 0 must be a valid keyword - init, encodeStart, encodeBin, encodeFinish, decodeStart, decodeBin, decodeFinish\n");
+    mexErrMsgTxt("Error: input 0 must be a valid keyword - initByProb, initByState, encodeStart, encodeBin, encodeBins, encodeFinish, decodeStart, decodeBin, decodeBins, decodeFinish, setTraceMode, getEncoderStats, getDecoderStats, getNumBits, encodeSubstreams, decodeSubstreams, encodeWavefront, decodeWavefront, wavefrontSync, encodeMatrix, decodeMatrix, estimateBits, searchConfig, saveState, loadState, setCapture, reset, destroy\n");
   }
 
   // start parsing the input command
@@ -124,9 +985,9 @@ void mexFunction(
     { 
       mexErrMsgTxt("Error: please provide the filename string and the context initializations\n"); 
     }
-    else if (nrhs>3) 
+    else if (nrhs > 4 || (nrhs == 4 && inputCmd != "initByProb")) 
     { 
-      mexErrMsgTxt("Error: too many parameters, provide the filename and the context initializations");
+      mexErrMsgTxt("Error: too many parameters, provide the filename, the context initializations and for initByProb optionally the probability model");
     }
     else 
     {
@@ -137,23 +998,26 @@ void mexFunction(
      else
      {
        fn = std::string(mxArrayToString(prhs[1]));
+       CABAC_ProbabilityModel eModel = CABAC_PROB_HEVC;
        if (!mxIsClass(prhs[2], "double"))
        {
          mexErrMsgTxt("Error: invalid context initialization\n");
        }
+       else if (nrhs == 4 && !xGetProbabilityModel(prhs[3], eModel))
+       {
+         mexErrMsgTxt("Error: invalid input 4, the probability model must be 'hevc' or 'dualRate'\n");
+       }
        else
        {
          // all clear
 
-         // set up an instance
-         c = new CABAC;
-         mexMakeMemoryPersistent((void*)c);
+         // set up an instance, reusing a destroyed one if available
+         uint32_t handle = xCreateSession(c);
 #if RWTH_CABAC_DEBUG_OUTPUT
-         mexPrintf("CABAC instance created. Pointer address c = %p\n", c);
+         mexPrintf("CABAC instance created. Handle %u, pointer address c = %p\n", handle, c);
 #endif
-         uintptr_t c_value = (uintptr_t)c;
          plhs[0] = mxCreateDoubleMatrix(1, 1, mxREAL);
-         *mxGetPr(plhs[0]) = c_value; // return pointer to matlab environment
+         *mxGetPr(plhs[0]) = handle; // return the handle to matlab environment
 
          // copy the filename
          //memcpy(c->fn, fn, sizeof(fn));
@@ -172,8 +1036,8 @@ void mexFunction(
            //init the contexts
            int numberOfContextModels = mxGetNumberOfElements(prhs[2]);
 
-           c->encoderModels.initContextModelsByP0Prob(numberOfContextModels, prhs[2]);
-           c->decoderModels.initContextModelsByP0Prob(numberOfContextModels, prhs[2]);
+           c->encoderModels.initContextModelsByP0Prob(numberOfContextModels, prhs[2], eModel);
+           c->decoderModels.initContextModelsByP0Prob(numberOfContextModels, prhs[2], eModel);
          }
 
 #if RWTH_CABAC_DEBUG_OUTPUT
@@ -191,21 +1055,7 @@ void mexFunction(
     }
     c = getPointer(prhs);
     assert(c);
-    // open bitstream for writing
-    if (!c->bitStream.openOutputFile(c->fn.c_str())) 
-    {
-      mexPrintf("Error: filename %s cannot be opened for writing\n", c->fn.c_str());
-      mexErrMsgTxt("Error: bitstreamfile access error\n");
-    }
-#if RWTH_CABAC_DEBUG_OUTPUT
-    mexPrintf("Status: filename: %s opened for writing\n", c->fn.c_str());
-#endif
-    // set bitstream to encoder
-    c->encoder.setBitstream(&(c->bitStream));
-    // start the encoder
-    c->encoder.start();
-    // initialize the context model
-  
+    xEncodeStart(c);
   }
   else if (inputCmd == "encodeBin")
   {
@@ -221,29 +1071,49 @@ void mexFunction(
       mexErrMsgTxt("Error: invalid input, provide the bin and context index to be encoded with\n"); 
     }
     encodedBin = static_cast<unsigned int>((*mxGetPr(prhs[2])));
-    int ctx_idx = static_cast<int>((*mxGetPr(prhs[3])));
+    double ctx_idx = *mxGetPr(prhs[3]);
     if (encodedBin != 0 && encodedBin != 1) 
     { 
       mexErrMsgTxt("Error: invalid input 3, bin to be encoded should either be 1 or 0\n"); 
     }
-    else
+    else
+    {
+      // encode bin, xEncodeBins checks the context index
+      xEncodeBins(c, &encodedBin, &ctx_idx, 1);
+#if RWTH_CABAC_DEBUG_OUTPUT
+      mexPrintf("Status: bin value %d encoded into context %d\n", encodedBin, static_cast<int>(ctx_idx));
+#endif
+    }
+  }
+  else if (inputCmd == "encodeBins")
+  {
+    if (nrhs < 2) 
+    {
+      mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
+    }
+    c = getPointer(prhs);
+    assert(c);
+    if (nrhs != 4) 
+    { 
+      mexErrMsgTxt("Error: invalid input, provide the bins and the context indices to be encoded with\n"); 
+    }
+    size_t numBins = mxGetNumberOfElements(prhs[2]);
+    if (mxGetNumberOfElements(prhs[3]) != numBins)
+    {
+      mexErrMsgTxt("Error: invalid input, bins and context indices must have the same number of elements\n");
+    }
+    switch (mxGetClassID(prhs[2]))
     {
-#if RWTH_TRACE_CABAC_STATES
-      uint8_t bin = encodedBin;
-      uint8_t mps_p = c->encoderModels.getContextModel(ctx_idx)->getMps();
-      uint8_t state_p = c->encoderModels.getContextModel(ctx_idx)->getState();
-#endif
-      // encode bin
-      c->encoder.encodeBin(encodedBin, c->encoderModels.getContextModel(ctx_idx));
-#if RWTH_TRACE_CABAC_STATES
-      uint8_t mps_a = c->encoderModels.getContextModel(ctx_idx)->getMps();
-      uint8_t state_a = c->encoderModels.getContextModel(ctx_idx)->getState();
-      c->encoderModels.getContextModel(ctx_idx)->addCabacStep(bin, state_p, mps_p, state_a, mps_a);
-#endif
+    case mxDOUBLE_CLASS:  xEncodeBins(c, (const double*)mxGetData(prhs[2]), prhs[3], numBins);  break;
+    case mxLOGICAL_CLASS: xEncodeBins(c, (const uint8_t*)mxGetData(prhs[2]), prhs[3], numBins); break;
+    case mxUINT8_CLASS:   xEncodeBins(c, (const uint8_t*)mxGetData(prhs[2]), prhs[3], numBins); break;
+    case mxINT32_CLASS:   xEncodeBins(c, (const int32_t*)mxGetData(prhs[2]), prhs[3], numBins); break;
+    default:
+      mexErrMsgTxt("Error: invalid input 3, bins must be double, logical, uint8 or int32\n");
+    }
 #if RWTH_CABAC_DEBUG_OUTPUT
-      mexPrintf("Status: bin value %d encoded into context %d\n", encodedBin,ctx_idx);
+    mexPrintf("Status: %d bins encoded\n", (int)numBins);
 #endif
-    }
   }
   else if (inputCmd == "getNumBits")
   {
@@ -258,7 +1128,7 @@ void mexFunction(
     { 
       mexErrMsgTxt("Error: invalid input\n"); 
     }
-    unsigned int bits = c->bitStream.getNumberOfWrittenBits();
+    unsigned int bits = c->outStream.getNumberOfWrittenBits();
     plhs[0] = mxCreateDoubleMatrix(1, 1, mxREAL);
     *mxGetPr(plhs[0]) = bits;
   }
@@ -270,12 +1140,11 @@ void mexFunction(
     }
     c = getPointer(prhs);
     assert(c);
-    c->encoder.finish();
-    c->bitStream.closeFile();
-#if RWTH_CABAC_DEBUG_OUTPUT
-    mexPrintf("Status: encoding finished, outstream closed\n");
-    mexPrintf("Status: number of written bits: %d\n", c->bitStream.getNumberOfWrittenBits());
-#endif
+    if (nlhs > 0 && !c->isInMemory())
+    {
+      mexErrMsgTxt("Error: the coded bytes are only returned if coding into memory (empty filename)\n");
+    }
+    xEncodeFinish(c, plhs);
   }
   else if (inputCmd == "decodeStart")
   {
@@ -285,16 +1154,42 @@ void mexFunction(
     }
     c = getPointer(prhs);
     // open bitstream for reading
-    if (!c->bitStream.openInputFile(c->fn.c_str())) 
+    if (c->isInMemory() && (nrhs == 4 || nrhs == 5))
     {
-      mexPrintf("Error: filename %s cannot be opened for reading\n", c->fn.c_str());
-      mexErrMsgTxt("Error: bitstreamfile access error\n");
+      // decode a single substream of the output of encodeSubstreams, starting with the initial contexts,
+      // or a column of the output of encodeWavefront, starting with the contexts of the last wavefrontSync
+      xCheckHevcModel(c);
+      CABAC_Substreams substreams;
+      int substreamIdx = (int)mxGetScalar(prhs[3]);
+      if (!mxIsUint8(prhs[2]) || !substreams.parse((const unsigned char*)mxGetData(prhs[2]), mxGetNumberOfElements(prhs[2])))
+      {
+        mexErrMsgTxt("Error: provide the output of encodeSubstreams as uint8 array to decode a substream\n");
+      }
+      if (substreamIdx < 0 || substreamIdx >= substreams.getNumSubstreams())
+      {
+        mexErrMsgTxt("Error: invalid input 4, substream index out of range\n");
+      }
+      c->inStream.openInputBuffer(substreams.getSubstreamData(substreamIdx), substreams.getSubstreamLength(substreamIdx));
+      if (nrhs == 5 && substreamIdx > 0)
+      {
+        char mode[16];
+        if (mxGetString(prhs[4], mode, sizeof(mode)) || string(mode) != "wavefront" || c->wavefrontContexts.empty())
+        {
+          mexErrMsgTxt("Error: invalid input 5, use 'wavefront' after a wavefrontSync of the previous column\n");
+        }
+        c->decoderModels.setContextModels(c->wavefrontContexts);
+      }
+      else
+      {
+        c->decoderModels.resetContextModels();
+      }
+    }
+    else
+    {
+      xOpenInput(c, (nrhs == 3) ? prhs[2] : NULL);
     }
-#if RWTH_CABAC_DEBUG_OUTPUT
-    mexPrintf("Status: filename %s opened for reading\n", c->fn.c_str());
-#endif
     // set bitstream to decoder
-    c->decoder.setBitstream(&(c->bitStream));
+    c->decoder.setBitstream(&(c->inStream));
     // start the decoder
     c->decoder.start();
   }
@@ -308,31 +1203,53 @@ void mexFunction(
     { 
       mexErrMsgTxt("Error: invalid command, provide a variable to store the decoded bin \n"); 
     }
+    else if (nrhs != 3) 
+    { 
+      mexErrMsgTxt("Error: invalid input, provide the context index to decode from\n"); 
+    }
     else
     {
       c = getPointer(prhs);
       assert(c);
-      unsigned int decodedBin = 0;
-      int ctx_idx = static_cast<int>((*mxGetPr(prhs[2])));
-      // decode Bin
-#if RWTH_TRACE_CABAC_STATES
-      uint8_t bin = decodedBin;
-      uint8_t mps_p = c->decoderModels.getContextModel(ctx_idx)->getMps();
-      uint8_t state_p = c->decoderModels.getContextModel(ctx_idx)->getState();
-#endif
-      c->decoder.decodeBin(decodedBin, c->decoderModels.getContextModel(ctx_idx));
-#if RWTH_TRACE_CABAC_STATES
-      uint8_t mps_a = c->decoderModels.getContextModel(ctx_idx)->getMps();
-      uint8_t state_a = c->decoderModels.getContextModel(ctx_idx)->getState();
-      c->decoderModels.getContextModel(ctx_idx)->addCabacStep(bin, state_p, mps_p, state_a, mps_a);
-#endif
+      uint8_t decodedBin = 0;
+      double ctx_idx = *mxGetPr(prhs[2]);
+      // decode Bin, xDecodeBins checks the context index
+      xDecodeBins(c, &ctx_idx, &decodedBin, 1);
 #if RWTH_CABAC_DEBUG_OUTPUT
-      mexPrintf("Status: bin value %d decoded from context %d\n", decodedBin,ctx_idx);
+      mexPrintf("Status: bin value %d decoded from context %d\n", decodedBin, static_cast<int>(ctx_idx));
 #endif
       plhs[0] = mxCreateDoubleMatrix(1, 1, mxREAL);
       *mxGetPr(plhs[0]) = decodedBin;
     }
   }
+  else if (inputCmd == "decodeBins")
+  {
+    if (nrhs < 2) 
+    {
+      mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
+    }
+    if (nrhs != 3 || nlhs != 1) 
+    { 
+      mexErrMsgTxt("Error: invalid command, provide the context indices and a variable to store the decoded bins \n"); 
+    }
+    c = getPointer(prhs);
+    assert(c);
+    size_t numBins = mxGetNumberOfElements(prhs[2]);
+    // the output has the shape of the context index array
+    plhs[0] = mxCreateNumericArray(mxGetNumberOfDimensions(prhs[2]), mxGetDimensions(prhs[2]), mxUINT8_CLASS, mxREAL);
+    uint8_t *bins = (uint8_t*)mxGetData(plhs[0]);
+    switch (mxGetClassID(prhs[2]))
+    {
+    case mxDOUBLE_CLASS: xDecodeBins(c, (const double*)mxGetData(prhs[2]), bins, numBins);  break;
+    case mxUINT8_CLASS:  xDecodeBins(c, (const uint8_t*)mxGetData(prhs[2]), bins, numBins); break;
+    case mxINT32_CLASS:  xDecodeBins(c, (const int32_t*)mxGetData(prhs[2]), bins, numBins); break;
+    default:
+      mexErrMsgTxt("Error: invalid input 3, context indices must be double, uint8 or int32\n");
+    }
+#if RWTH_CABAC_DEBUG_OUTPUT
+    mexPrintf("Status: %d bins decoded\n", (int)numBins);
+#endif
+  }
   else if (inputCmd == "decodeFinish")
   {
     if (nrhs < 2) 
@@ -342,129 +1259,625 @@ void mexFunction(
     c = getPointer(prhs);
     assert(c);
     c->decoder.finish();
-    c->bitStream.closeFile();
+    c->inStream.closeFile();
 #if RWTH_CABAC_DEBUG_OUTPUT
     mexPrintf("Status: decoding finished, instream closed\n");
 #endif
-#if RWTH_TRACE_CABAC_STATES && RWTH_TRACE_CABAC_TO_FILE
-    FILE* traceFile = fopen("CABAC_DEC_STATS_TRACE.log", "w");
-    c->decoderModels.writeCompleteTraces(traceFile);
-    fclose(traceFile);
+#if RWTH_TRACE_CABAC_TO_FILE
+    if (c->decoderTrace.getMode() != CABAC_TRACE_OFF)
+    {
+      FILE* traceFile = fopen("CABAC_DEC_STATS_TRACE.log", "w");
+      c->decoderTrace.writeStateCounts(traceFile);
+      fclose(traceFile);
+    }
 #endif
   }
-#if RWTH_TRACE_CABAC_STATES
-  else if (inputCmd == "getEncoderStats")
+  else if (inputCmd == "setTraceMode")
+  {
+    if (nrhs < 2) 
+    {
+      mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
+    }
+    if (nrhs < 3 || nrhs > 5 || !mxIsClass(prhs[2], "char"))
+    {
+      mexErrMsgTxt("Error: invalid command, provide the trace mode ('off', 'counters' or 'steps') and optionally the ring buffer size and sampling interval\n");
+    }
+    c = getPointer(prhs);
+    assert(c);
+    char mode[16];
+    mxGetString(prhs[2], mode, sizeof(mode));
+    CABAC_TraceMode traceMode = CABAC_TRACE_OFF;
+    if (string(mode) == "counters")
+    {
+      traceMode = CABAC_TRACE_COUNTERS;
+    }
+    else if (string(mode) == "steps")
+    {
+      traceMode = CABAC_TRACE_STEPS;
+    }
+    else if (string(mode) != "off")
+    {
+      mexErrMsgTxt("Error: invalid input 3, the trace mode must be 'off', 'counters' or 'steps'\n");
+    }
+    double ringSize = (nrhs > 3) ? mxGetScalar(prhs[3]) : 65536;
+    double sampleInterval = (nrhs > 4) ? mxGetScalar(prhs[4]) : 1;
+    if (ringSize < 0 || sampleInterval < 1)
+    {
+      mexErrMsgTxt("Error: invalid input, the ring buffer size must be >= 0 and the sampling interval >= 1\n");
+    }
+    if (traceMode != CABAC_TRACE_OFF)
+    {
+      xCheckHevcModel(c);
+    }
+    c->encoderTrace.init(c->encoderModels.getNumContextModels(), traceMode, (size_t)ringSize, (unsigned int)sampleInterval);
+    c->decoderTrace.init(c->decoderModels.getNumContextModels(), traceMode, (size_t)ringSize, (unsigned int)sampleInterval);
+  }
+  else if (inputCmd == "getEncoderStats" || inputCmd == "getDecoderStats")
   {
     if (nrhs < 2) 
     {
       mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
     }
-    if (nlhs != 2) 
+    if (nrhs != 3 || nlhs != 2) 
     { 
-      mexErrMsgTxt("Error: invalid command, provide two variables to store the trace \n"); 
+      mexErrMsgTxt("Error: invalid command, provide the context index and two variables to store the trace \n"); 
     }
-    else
+    c = getPointer(prhs);
+    assert(c);
+    const CABAC_Trace &trace = (inputCmd == "getEncoderStats") ? c->encoderTrace : c->decoderTrace;
+    int ctx_idx = static_cast<int>((*mxGetPr(prhs[2])));
+    if (trace.getMode() == CABAC_TRACE_OFF)
+    {
+      mexErrMsgTxt("Error: tracing is off, enable it with setTraceMode before coding\n");
+    }
+    if (ctx_idx < 0 || ctx_idx >= trace.getNumContexts())
+    {
+      mexErrMsgTxt("Error: invalid input 3, context index out of range\n");
+    }
+    xGetStats(trace, ctx_idx, plhs);
+  }
+  else if (inputCmd == "encodeSubstreams")
+  {
+    if (nrhs < 2) 
+    {
+      mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
+    }
+    if (nrhs < 5 || nrhs > 6) 
+    { 
+      mexErrMsgTxt("Error: invalid input, provide the bins, the context indices, the first bin of every substream and optionally the number of threads\n"); 
+    }
+    c = getPointer(prhs);
+    xCheckHevcModel(c);
+    xCheckNoCapture(c);
+    if (!c->isInMemory())
     {
-        c = getPointer(prhs);
-        int ctx_idx = static_cast<int>((*mxGetPr(prhs[2])));
-        std::vector<CABACStep>* stepsTrace = c->encoderModels.getContextModel(ctx_idx)->getCabacSteps();
-        std::vector<std::vector<unsigned int>>* transTrace = c->encoderModels.getContextModel(ctx_idx)->getCabactTransitions();
+      mexErrMsgTxt("Error: substreams are only coded into memory (empty filename)\n");
+    }
+    size_t numBins = mxGetNumberOfElements(prhs[2]);
+    if (mxGetNumberOfElements(prhs[3]) != numBins)
+    {
+      mexErrMsgTxt("Error: invalid input, bins and context indices must have the same number of elements\n");
+    }
+    std::vector<uint8_t> bins;
+    std::vector<int32_t> ctxIdx;
+    std::vector<size_t> firstBin;
+    std::vector<ContextModel> initModels;
+    xCopyBins(prhs[2], bins);
+    xCopyContexts(prhs[3], c->encoderModels.getNumContextModels(), ctxIdx);
+    xGetFirstBins(prhs[4], numBins, firstBin);
+    xInitThreadPool(c, nrhs, prhs, 5);
+    c->encoderModels.getInitContextModels(initModels);
 
-        //plhs[0] = mxCreateNumericMatrix(5, stepsTrace->size(), mxUINT8_CLASS, mxREAL);
-        plhs[0] = mxCreateNumericMatrix(5, stepsTrace->size(), mxUINT8_CLASS, mxREAL);
-        if (plhs[0])
-        {
-          uint8_t* out1Data = (uint8_t*)mxGetData(plhs[0]);
-          for (int entry=0;entry<stepsTrace->size();entry++)
-          { 
-            CABACStep temp = stepsTrace->at(entry);
-            out1Data[entry * 5 + 0] = temp.codedBin;
-            out1Data[entry * 5 + 1] = temp.state_p;
-            out1Data[entry * 5 + 2] = temp.mps_p;
-            out1Data[entry * 5 + 3] = temp.state_a;
-            out1Data[entry * 5 + 4] = temp.mps_a;
-          }
-        }
-        else
-        {
-          printf("output0 array was not created\n");
-        }
+    std::vector<unsigned char> coded;
+    std::vector<size_t> substreamBytes;
+    CABAC_Substreams::encode(c->threadPool, initModels, numBins ? &bins[0] : NULL, numBins ? &ctxIdx[0] : NULL, firstBin, coded, &substreamBytes);
+    xReturnSubstreams(coded, substreamBytes, nlhs, plhs);
+    if (nlhs > 2)
+    {
+      plhs[2] = mxCreateDoubleMatrix(1, 1, mxREAL);
+      *mxGetPr(plhs[2]) = xCountSingleStreamBits(initModels, bins, ctxIdx);
+    }
+#if RWTH_CABAC_DEBUG_OUTPUT
+    mexPrintf("Status: %d bins encoded into %d substreams, %d bytes\n", (int)numBins, (int)substreamBytes.size(), (int)coded.size());
+#endif
+  }
+  else if (inputCmd == "decodeSubstreams")
+  {
+    if (nrhs < 2) 
+    {
+      mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
+    }
+    if (nrhs < 5 || nrhs > 6 || nlhs != 1 || !mxIsUint8(prhs[2])) 
+    { 
+      mexErrMsgTxt("Error: invalid command, provide the coded bytes as uint8 array, the context indices, the first bin of every substream, optionally the number of threads and a variable to store the decoded bins\n"); 
+    }
+    c = getPointer(prhs);
+    xCheckHevcModel(c);
+    CABAC_Substreams substreams;
+    if (!substreams.parse((const unsigned char*)mxGetData(prhs[2]), mxGetNumberOfElements(prhs[2])))
+    {
+      mexErrMsgTxt("Error: invalid input 3, the entry point table is corrupt\n");
+    }
+    size_t numBins = mxGetNumberOfElements(prhs[3]);
+    std::vector<int32_t> ctxIdx;
+    std::vector<size_t> firstBin;
+    std::vector<ContextModel> initModels;
+    xCopyContexts(prhs[3], c->decoderModels.getNumContextModels(), ctxIdx);
+    xGetFirstBins(prhs[4], numBins, firstBin);
+    if ((int)firstBin.size() != substreams.getNumSubstreams() + 1)
+    {
+      mexErrMsgTxt("Error: invalid input 5, the number of substreams does not match the bitstream\n");
+    }
+    xInitThreadPool(c, nrhs, prhs, 5);
+    c->decoderModels.getInitContextModels(initModels);
+
+    // the output has the shape of the context index array
+    plhs[0] = mxCreateNumericArray(mxGetNumberOfDimensions(prhs[3]), mxGetDimensions(prhs[3]), mxUINT8_CLASS, mxREAL);
+    substreams.decode(c->threadPool, initModels, numBins ? &ctxIdx[0] : NULL, firstBin, (uint8_t*)mxGetData(plhs[0]));
+#if RWTH_CABAC_DEBUG_OUTPUT
+    mexPrintf("Status: %d bins decoded from %d substreams\n", (int)numBins, substreams.getNumSubstreams());
+#endif
+  }
+  else if (inputCmd == "encodeWavefront")
+  {
+    if (nrhs < 2) 
+    {
+      mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
+    }
+    if (nrhs < 6 || nrhs > 7) 
+    { 
+      mexErrMsgTxt("Error: invalid input, provide the bins, the context indices, the first bin and the sync bin of every column and optionally the number of threads\n"); 
+    }
+    c = getPointer(prhs);
+    xCheckHevcModel(c);
+    xCheckNoCapture(c);
+    if (!c->isInMemory())
+    {
+      mexErrMsgTxt("Error: substreams are only coded into memory (empty filename)\n");
+    }
+    size_t numBins = mxGetNumberOfElements(prhs[2]);
+    if (mxGetNumberOfElements(prhs[3]) != numBins)
+    {
+      mexErrMsgTxt("Error: invalid input, bins and context indices must have the same number of elements\n");
+    }
+    std::vector<uint8_t> bins;
+    std::vector<int32_t> ctxIdx;
+    std::vector<size_t> firstBin, syncBin;
+    std::vector<ContextModel> initModels;
+    xCopyBins(prhs[2], bins);
+    xCopyContexts(prhs[3], c->encoderModels.getNumContextModels(), ctxIdx);
+    xGetFirstBins(prhs[4], numBins, firstBin);
+    xGetSyncBins(prhs[5], firstBin, syncBin);
+    xInitThreadPool(c, nrhs, prhs, 6);
+    c->encoderModels.getInitContextModels(initModels);
+
+    std::vector<unsigned char> coded;
+    std::vector<size_t> substreamBytes;
+    CABAC_Wavefront::encode(c->threadPool, initModels, numBins ? &bins[0] : NULL, numBins ? &ctxIdx[0] : NULL, firstBin, syncBin, coded, &substreamBytes);
+    xReturnSubstreams(coded, substreamBytes, nlhs, plhs);
+    if (nlhs > 2)
+    {
+      plhs[2] = mxCreateDoubleMatrix(1, 1, mxREAL);
+      *mxGetPr(plhs[2]) = xCountSingleStreamBits(initModels, bins, ctxIdx);
+    }
+#if RWTH_CABAC_DEBUG_OUTPUT
+    mexPrintf("Status: %d bins encoded into %d wavefront columns, %d bytes\n", (int)numBins, (int)substreamBytes.size(), (int)coded.size());
+#endif
+  }
+  else if (inputCmd == "decodeWavefront")
+  {
+    if (nrhs < 2) 
+    {
+      mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
+    }
+    if (nrhs < 6 || nrhs > 7 || nlhs != 1 || !mxIsUint8(prhs[2])) 
+    { 
+      mexErrMsgTxt("Error: invalid command, provide the coded bytes as uint8 array, the context indices, the first bin and the sync bin of every column, optionally the number of threads and a variable to store the decoded bins\n"); 
+    }
+    c = getPointer(prhs);
+    xCheckHevcModel(c);
+    CABAC_Substreams substreams;
+    if (!substreams.parse((const unsigned char*)mxGetData(prhs[2]), mxGetNumberOfElements(prhs[2])))
+    {
+      mexErrMsgTxt("Error: invalid input 3, the entry point table is corrupt\n");
+    }
+    size_t numBins = mxGetNumberOfElements(prhs[3]);
+    std::vector<int32_t> ctxIdx;
+    std::vector<size_t> firstBin, syncBin;
+    std::vector<ContextModel> initModels;
+    xCopyContexts(prhs[3], c->decoderModels.getNumContextModels(), ctxIdx);
+    xGetFirstBins(prhs[4], numBins, firstBin);
+    if ((int)firstBin.size() != substreams.getNumSubstreams() + 1)
+    {
+      mexErrMsgTxt("Error: invalid input 5, the number of columns does not match the bitstream\n");
+    }
+    xGetSyncBins(prhs[5], firstBin, syncBin);
+    xInitThreadPool(c, nrhs, prhs, 6);
+    c->decoderModels.getInitContextModels(initModels);
+
+    // the output has the shape of the context index array
+    plhs[0] = mxCreateNumericArray(mxGetNumberOfDimensions(prhs[3]), mxGetDimensions(prhs[3]), mxUINT8_CLASS, mxREAL);
+    CABAC_Wavefront::decode(c->threadPool, initModels, substreams, numBins ? &ctxIdx[0] : NULL, firstBin, syncBin, (uint8_t*)mxGetData(plhs[0]));
+  }
+  else if (inputCmd == "wavefrontSync")
+  {
+    if (nrhs != 2) 
+    {
+      mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
+    }
+    c = getPointer(prhs);
+    xCheckHevcModel(c);
+    // the next column decoded with decodeStart(..., 'wavefront') starts with these contexts
+    c->decoderModels.getContextModels(c->wavefrontContexts);
+  }
+  else if (inputCmd == "encodeMatrix")
+  {
+    if (nrhs < 2) 
+    {
+      mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
+    }
+    c = getPointer(prhs);
+    if (nrhs != 7)
+    {
+      mexErrMsgTxt("Error: invalid input, provide the matrix, Nq, binMethod, cmTypes and Nlbp\n");
+    }
+    CABAC_MatrixCoder coder;
+    std::vector<unsigned int> values;
+    xInitMatrixCoder(coder, c->encoderModels.getNumContextModels(), prhs, 3);
+    xGetMatrixValues(prhs[2], coder.getBinarizer(), values);
+    const size_t numRows = mxGetM(prhs[2]);
+    const size_t numCols = numRows ? values.size() / numRows : 0;
+
+    // histogram of the selected contexts (indexed by the 1-based MATLAB ID) and the bits of every 
+    // value, only if requested
+    mxArray *hist = (nlhs > 1) ? mxCreateDoubleMatrix(1, coder.getNumContextModels() + 1, mxREAL) : NULL;
+    mxArray *heatMap = (nlhs > 2) ? mxCreateDoubleMatrix(numRows, numCols, mxREAL) : NULL;
+    double *ctxHist = hist ? mxGetPr(hist) : NULL;
+    double *H = heatMap ? mxGetPr(heatMap) : NULL;
+
+    // binarize the whole matrix in one pass, the contexts depend on the upper neighbor
+    std::vector<CABAC_Codeword> codewords(values.size());
+    if (!values.empty())
+    {
+      coder.getBinarizer().binarize(&values[0], values.size(), &codewords[0]);
+    }
 
-        plhs[1] = mxCreateNumericMatrix(RWTH_TRACE_CABAC_STATES_NUM_STATES, RWTH_TRACE_CABAC_STATES_NUM_STATES,mxUINT32_CLASS, mxREAL);
-        if (plhs[1])
-        {     
-          unsigned int* out2Data = (unsigned int*)mxGetData(plhs[1]);
-          for (int state_p = 0; state_p < RWTH_TRACE_CABAC_STATES_NUM_STATES; state_p++)
+    xEncodeStart(c);
+    for (size_t k = 0; k < numCols; k++)
+    {
+      coder.startColumn();
+      for (size_t d = 0; d < numRows; d++)
+      {
+        const size_t i = k * numRows + d;
+        unsigned int bits = H ? c->outStream.getNumberOfWrittenBits() : 0;
+        int numBins = coder.setValue(codewords[i]);
+        xEncodeBinsChecked(c, coder.getBins(), coder.getContexts(), numBins);
+        if (ctxHist)
+        {
+          for (int n = 0; n < numBins; n++)
           {
-            for (int state_a = 0; state_a < RWTH_TRACE_CABAC_STATES_NUM_STATES; state_a++)
-            {
-              unsigned int temp = (*transTrace)[state_p][state_a];
-              out2Data[state_p * RWTH_TRACE_CABAC_STATES_NUM_STATES + state_a] = temp;
-            }
+            ctxHist[coder.getContexts()[n]]++;
           }
         }
-        else
+        if (H)
         {
-          printf("output1 array was not created\n");
+          H[i] = c->outStream.getNumberOfWrittenBits() - bits;
         }
+      }
+    }
+    xEncodeFinish(c, plhs);
+    if (!c->isInMemory())
+    {
+      plhs[0] = mxCreateDoubleMatrix(0, 0, mxREAL);
+    }
+    if (nlhs > 1)
+    {
+      plhs[1] = hist;
+    }
+    if (nlhs > 2)
+    {
+      plhs[2] = heatMap;
     }
   }
-  else if (inputCmd == "getDecoderStats")
+  else if (inputCmd == "decodeMatrix")
   {
     if (nrhs < 2) 
     {
       mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
     }
-    if (nlhs != 2) 
-    { 
-      mexErrMsgTxt("Error: invalid command, provide two variables to store the trace \n"); 
+    c = getPointer(prhs);
+    if (nrhs != 7 && nrhs != 8 && nrhs != 10 && nrhs != 11)
+    {
+      mexErrMsgTxt("Error: invalid input, provide the size, Nq, binMethod, cmTypes, Nlbp, the coded bytes if decoding from memory and optionally 'substreams' with the first columns or 'wavefront' with the sync row and the number of threads\n");
     }
-    else
+    CABAC_MatrixCoder coder;
+    xInitMatrixCoder(coder, c->decoderModels.getNumContextModels(), prhs, 3);
+    const double *siz = mxIsDouble(prhs[2]) && mxGetNumberOfElements(prhs[2]) == 2 ? mxGetPr(prhs[2]) : NULL;
+    if (!siz || !(siz[0] >= 0) || !(siz[1] >= 0) || siz[0] != floor(siz[0]) || siz[1] != floor(siz[1]))
     {
-        c = getPointer(prhs);
-        int ctx_idx = static_cast<int>((*mxGetPr(prhs[2])));
-        std::vector<CABACStep>* stepsTrace = c->decoderModels.getContextModel(ctx_idx)->getCabacSteps();
-        std::vector<std::vector<unsigned int>>* transTrace = c->decoderModels.getContextModel(ctx_idx)->getCabactTransitions();
+      mexErrMsgTxt("Error: invalid input 3, provide the size of the matrix as [rows cols]\n");
+    }
+    const size_t numRows = (size_t)siz[0];
+    const size_t numCols = (size_t)siz[1];
+    const unsigned int uiNq = coder.getBinarizer().getNq();
 
-        plhs[0] = mxCreateNumericMatrix(5,stepsTrace->size(), mxUINT8_CLASS, mxREAL);
-        if (plhs[0])
+    if (nrhs > 8)
+    {
+      // the output of encodeSubstreams or encodeWavefront, every substream is decoded by its own 
+      // copy of the coder
+      xCheckHevcModel(c);
+      char mode[16];
+      CABAC_Substreams substreams;
+      if (!mxIsUint8(prhs[7]) || !substreams.parse((const unsigned char*)mxGetData(prhs[7]), mxGetNumberOfElements(prhs[7])))
+      {
+        mexErrMsgTxt("Error: invalid input 8, provide the output of encodeSubstreams or encodeWavefront as uint8 array\n");
+      }
+      if (!mxIsClass(prhs[8], "char") || mxGetString(prhs[8], mode, sizeof(mode)) || (string(mode) != "substreams" && string(mode) != "wavefront"))
+      {
+        mexErrMsgTxt("Error: invalid input 9, the decoding mode must be 'substreams' or 'wavefront'\n");
+      }
+      const bool bWavefront = string(mode) == "wavefront";
+      std::vector<size_t> firstCol;
+      double syncRows = 0;
+      if (bWavefront)
+      {
+        syncRows = mxGetScalar(prhs[9]);
+        if (!(syncRows >= 0) || syncRows != floor(syncRows))
         {
-          uint8_t* out1Data = (uint8_t*)mxGetData(plhs[0]);
-          for (int entry = 0; entry < stepsTrace->size(); entry++)
-          {
-            CABACStep temp = stepsTrace->at(entry);
-            out1Data[entry * 5 + 0] = temp.codedBin;
-            out1Data[entry * 5 + 1] = temp.state_p;
-            out1Data[entry * 5 + 2] = temp.mps_p;
-            out1Data[entry * 5 + 3] = temp.state_a;
-            out1Data[entry * 5 + 4] = temp.mps_a;
-          }
+          mexErrMsgTxt("Error: invalid input 10, the sync row must be a non-negative integer\n");
         }
-        else
+        if ((size_t)substreams.getNumSubstreams() != numCols)
         {
-          printf("output0 array was not created\n");
+          mexErrMsgTxt("Error: invalid input 8, the number of columns does not match the bitstream\n");
         }
+      }
+      else
+      {
+        xGetFirstBins(prhs[9], numCols, firstCol);
+        if ((int)firstCol.size() != substreams.getNumSubstreams() + 1)
+        {
+          mexErrMsgTxt("Error: invalid input 10, the number of substreams does not match the bitstream\n");
+        }
+      }
+      xInitThreadPool(c, nrhs, prhs, 10);
+      std::vector<ContextModel> initModels;
+      c->decoderModels.getInitContextModels(initModels);
 
-        plhs[1] = mxCreateNumericMatrix(RWTH_TRACE_CABAC_STATES_NUM_STATES, RWTH_TRACE_CABAC_STATES_NUM_STATES, mxUINT32_CLASS, mxREAL);
-        if (plhs[1])
+      std::vector<unsigned int> values(numRows * numCols);
+      if (bWavefront)
+      {
+        const size_t uiSyncRow = syncRows < numRows ? (size_t)syncRows : numRows;
+        CABAC_Wavefront::decodeMatrix(c->threadPool, initModels, substreams, coder, numRows, uiSyncRow, values.empty() ? NULL : &values[0]);
+      }
+      else
+      {
+        substreams.decodeMatrix(c->threadPool, initModels, coder, numRows, firstCol, values.empty() ? NULL : &values[0]);
+      }
+      plhs[0] = xCreateMatrix(values, numRows, numCols, uiNq);
+#if RWTH_CABAC_DEBUG_OUTPUT
+      mexPrintf("Status: %d x %d matrix decoded from %d substreams\n", (int)numRows, (int)numCols, substreams.getNumSubstreams());
+#endif
+    }
+    else
+    {
+      xOpenInput(c, (nrhs == 8) ? prhs[7] : NULL);
+      c->decoder.setBitstream(&(c->inStream));
+      c->decoder.start();
+      // the smallest class holding 0...Nq-1
+      if (uiNq <= 256)
+      {
+        plhs[0] = mxCreateNumericMatrix(numRows, numCols, mxUINT8_CLASS, mxREAL);
+        xDecodeMatrix(c, coder, numRows, numCols, (uint8_t*)mxGetData(plhs[0]));
+      }
+      else if (uiNq <= 0x80000000u)
+      {
+        plhs[0] = mxCreateNumericMatrix(numRows, numCols, mxINT32_CLASS, mxREAL);
+        xDecodeMatrix(c, coder, numRows, numCols, (int32_t*)mxGetData(plhs[0]));
+      }
+      else
+      {
+        plhs[0] = mxCreateDoubleMatrix(numRows, numCols, mxREAL);
+        xDecodeMatrix(c, coder, numRows, numCols, mxGetPr(plhs[0]));
+      }
+      c->decoder.finish();
+      c->inStream.closeFile();
+    }
+  }
+  else if (inputCmd == "estimateBits")
+  {
+    if (nrhs < 2) 
+    {
+      mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
+    }
+    c = getPointer(prhs);
+    xCheckHevcModel(c);
+    if (nrhs != 4 && nrhs != 7)
+    {
+      mexErrMsgTxt("Error: invalid input, provide the bins and the context indices or the matrix, Nq, binMethod, cmTypes and Nlbp\n");
+    }
+    // the estimate starts from the initialization like a new bitstream, the session is not changed
+    std::vector<ContextModel> models;
+    c->encoderModels.getInitContextModels(models);
+    std::vector<uint8_t> bins;
+    std::vector<int32_t> ctxIdx;
+    std::vector<uint64_t> ctxFracBits;
+    CABAC_RateEstimator estimator;
+    estimator.start();
+    if (nrhs == 4)
+    {
+      if (mxGetNumberOfElements(prhs[3]) != mxGetNumberOfElements(prhs[2]))
+      {
+        mexErrMsgTxt("Error: invalid input, bins and context indices must have the same number of elements\n");
+      }
+      xCopyBins(prhs[2], bins);
+      xCopyContexts(prhs[3], c->encoderModels.getNumContextModels(), ctxIdx);
+      ctxFracBits.resize(models.size(), 0);
+      xEstimateBinsLoop(estimator, models, bins.empty() ? NULL : &bins[0], ctxIdx.empty() ? NULL : &ctxIdx[0], bins.size(), ctxFracBits);
+    }
+    else
+    {
+      CABAC_MatrixCoder coder;
+      std::vector<unsigned int> values;
+      xInitMatrixCoder(coder, c->encoderModels.getNumContextModels(), prhs, 3);
+      xGetMatrixValues(prhs[2], coder.getBinarizer(), values);
+      const size_t numRows = mxGetM(prhs[2]);
+      const bool bCoded = nlhs > 2;
+      ctxFracBits.resize(coder.getNumContextModels(), 0);
+      for (size_t i = 0; i < values.size(); i++)
+      {
+        if (i % numRows == 0)
         {
-          unsigned int* out2Data = (unsigned int*)mxGetData(plhs[1]);
-          for (int state_p = 0; state_p < RWTH_TRACE_CABAC_STATES_NUM_STATES; state_p++)
-          {
-            for (int state_a = 0; state_a < RWTH_TRACE_CABAC_STATES_NUM_STATES; state_a++)
-            {
-              unsigned int temp = (*transTrace)[state_p][state_a];
-              out2Data[state_p * RWTH_TRACE_CABAC_STATES_NUM_STATES + state_a] = temp;
-            }
-          }
+          coder.startColumn();
+        }
+        int numBins = coder.binarize(values[i]);
+        xEstimateBinsLoop(estimator, models, coder.getBins(), coder.getContexts(), numBins, ctxFracBits);
+        if (bCoded)
+        {
+          // keep the bins for the coded size
+          bins.insert(bins.end(), coder.getBins(), coder.getBins() + numBins);
+          ctxIdx.insert(ctxIdx.end(), coder.getContexts(), coder.getContexts() + numBins);
         }
-        else
+      }
+    }
+    estimator.finish();
+    xReturnEstimate(estimator, ctxFracBits, nlhs, plhs);
+    if (nlhs > 2)
+    {
+      // the actual size for comparison, coded without storing the bitstream
+      c->encoderModels.getInitContextModels(models);
+      plhs[2] = mxCreateDoubleMatrix(1, 1, mxREAL);
+      *mxGetPr(plhs[2]) = xCountSingleStreamBits(models, bins, ctxIdx);
+    }
+  }
+  else if (inputCmd == "searchConfig")
+  {
+    if (nrhs < 2) 
+    {
+      mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
+    }
+    c = getPointer(prhs);
+    xCheckHevcModel(c);
+    if (nrhs < 7 || nrhs > 8)
+    {
+      mexErrMsgTxt("Error: invalid input, provide the matrix, Nq, the binMethods, cmTypes and Nlbp candidates and optionally the number of threads\n");
+    }
+    const unsigned int uiNq = xGetNq(prhs[3]);
+    std::vector<std::string> binMethods;
+    std::vector<std::vector<std::string> > cmTypes;
+    std::vector<int> Nlbps;
+    xGetSearchCandidates(prhs, 4, binMethods, cmTypes, Nlbps);
+    // check every candidate here, the search itself runs on the worker threads
+    CABAC_MatrixCoder coder;
+    for (size_t i = 0; i < binMethods.size(); i++)
+    {
+      for (size_t j = 0; j < cmTypes.size(); j++)
+      {
+        CABAC_SearchConfig config = { binMethods[i], cmTypes[j], Nlbps[0] };
+        if (!CABAC_ConfigSearch::initCoder(coder, config, uiNq))
         {
-          printf("output1 array was not created\n");
+          mexErrMsgTxt("Error: invalid input, binMethods may only contain DEC2TU, DEC2TR0...2, DEC2EG0...2 and DEC2FL32, cmTypes cond0, cond1, condbinlft, conds0 and conds1\n");
         }
+      }
+    }
+    std::vector<unsigned int> values;
+    xGetMatrixValues(prhs[2], coder.getBinarizer(), values);
+    xInitThreadPool(c, nrhs, prhs, 7);
+
+    std::vector<CABAC_SearchResult> ranking;
+    CABAC_ConfigSearch::search(c->threadPool, values, mxGetM(prhs[2]), uiNq, binMethods, cmTypes, Nlbps, ranking);
+    // one row per configuration, the best first: binMethod index, cmTypes index, Nlbp, total, coded and init bits
+    plhs[0] = mxCreateDoubleMatrix(ranking.size(), 6, mxREAL);
+    double *table = mxGetPr(plhs[0]);
+    const size_t numConfigs = ranking.size();
+    for (size_t i = 0; i < numConfigs; i++)
+    {
+      table[i] = ranking[i].iMethod + 1;
+      table[numConfigs + i] = ranking[i].iTypes + 1;
+      table[2 * numConfigs + i] = Nlbps[ranking[i].iNlbp];
+      table[3 * numConfigs + i] = ranking[i].getTotalBits();
+      table[4 * numConfigs + i] = ranking[i].dCodedBits;
+      table[5 * numConfigs + i] = ranking[i].dInitBits;
+    }
+  }
+  else if (inputCmd == "saveState")
+  {
+    if (nrhs != 2) 
+    {
+      mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
+    }
+    c = getPointer(prhs);
+    xCheckHevcModel(c);
+    xSaveState(c, xGetHandle(prhs), plhs);
+  }
+  else if (inputCmd == "loadState")
+  {
+    if (nrhs < 2) 
+    {
+      mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
+    }
+    c = getPointer(prhs);
+    xCheckHevcModel(c);
+    xCheckNoCapture(c);
+    if (nrhs != 3)
+    {
+      mexErrMsgTxt("Error: invalid input, provide the state returned by saveState\n");
+    }
+    xLoadState(c, xGetHandle(prhs), prhs[2]);
+  }
+  else if (inputCmd == "setCapture")
+  {
+    if (nrhs < 2) 
+    {
+      mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
+    }
+    c = getPointer(prhs);
+    if (nrhs != 3 || !mxIsChar(prhs[2]))
+    {
+      mexErrMsgTxt("Error: invalid input, provide the filename of the capture or '' to stop capturing\n");
+    }
+    if (c->bEncoding)
+    {
+      mexErrMsgTxt("Error: the capture can only be started or stopped outside of encodeStart and encodeFinish\n");
+    }
+    char *captureFn = mxArrayToString(prhs[2]);
+    bool bOk = c->capture.close();
+    if (bOk && captureFn[0] && !c->capture.open(captureFn))
+    {
+      mexPrintf("Error: capture file %s cannot be opened for writing\n", captureFn);
+      mxFree(captureFn);
+      mexErrMsgTxt("Error: capture file access error\n");
+    }
+    mxFree(captureFn);
+    if (!bOk)
+    {
+      mexErrMsgTxt("Error: writing the capture file failed\n");
     }
   }
+  else if (inputCmd == "reset")
+  {
+    if (nrhs != 2) 
+    {
+      mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
+    }
+    c = getPointer(prhs);
+    c->reset();
+#if RWTH_CABAC_DEBUG_OUTPUT
+    mexPrintf("Status: CABAC instance reset\n");
+#endif
+  }
+  else if (inputCmd == "destroy")
+  {
+    if (nrhs != 2) 
+    {
+      mexErrMsgTxt("Error: You need to provide the pointer to the initialized CABAC engine \n");
+    }
+    // check the handle
+    getPointer(prhs);
+    xDestroySession(xGetHandle(prhs));
+#if RWTH_CABAC_DEBUG_OUTPUT
+    mexPrintf("Status: CABAC instance destroyed, %d instances pooled\n", (int)s_sessionPool.size());
 #endif
+  }
   else
   {
     mexErrMsgTxt("Error: Invalid Command\n");
@@ -8,38 +8,179 @@
 %   handle = SimpleCABACMex('initByProb', fn, ctxInit); 
 %   or
 %   handle = SimpleCABACMex('initByState', fn, ctxInit);
-%   fn is the filename string to write / read the bits.
+%   fn is the filename string to write / read the bits. If fn is empty (''),
+%   the bits are written to / read from memory instead of a file.
 %   ctxInit is an 1xN array of N numbers of p(0) probabilities for 
 %   'initByProb' or
 %   ctxInit is an 3xN array of N numbers of mps, state and ctxId values for
 %   'initByState'
+%   With 'initByProb', the contexts can use the dual-rate probability
+%   model (two 15 bit estimates with different adaptation rates) instead of
+%   the 64 states of HEVC, which codes strongly skewed bins with less bits
+%   handle = SimpleCABACMex('initByProb', fn, ctxInit, 'dualRate');
+%   ('hevc' is the default). The substreams, the wavefront, the rate
+%   estimation, searchConfig, saveState / loadState and the trace modes
+%   'counters' and 'steps' need 'hevc'.
+%   
+%   To collect context state statistics (needed for 'getEncoderStats' and
+%   'getDecoderStats'), choose a trace mode before coding. The mode is
+%   'off' (default), 'counters' (state histograms and transition counts) or
+%   'steps' (counters plus the last ringSize coding steps per context,
+%   recording every sampleInterval-th step; defaults 65536 and 1)
+%   SimpleCABACMex('setTraceMode', handle, mode);
+%   SimpleCABACMex('setTraceMode', handle, mode, ringSize, sampleInterval);
 %   
 %   Encoding Steps:
 %   1. Start the encoding engine
 %   SimpleCABACMex('encodeStart', handle); 
 %   2. Encode a bin into a context
 %   SimpleCABACMex('encodeBin', handle, binValue, ctxId);
+%   or encode a whole vector of bins at once, where binValues(i) is coded
+%   into context ctxIds(i) (double, uint8 or int32 vectors of equal length)
+%   SimpleCABACMex('encodeBins', handle, binValues, ctxIds);
 %   3. Code more bits and finally deactivate the coding engine
 % 	SimpleCABACMex('encodeFinish', handle);
+%   or, when coding into memory, retrieve the coded bytes as uint8 array
+% 	[bytes] = SimpleCABACMex('encodeFinish', handle);
 %   4. Optionally, before you finish encoding, retrieve some statistics
 %   for a specific context or get information about the bits written
 %   [trace, stats] = SimpleCABACMex('getEncoderStats',handle,ctxId);
 %   [bits] = SimpleCABACMex('getNumBits',handle);
 %
+%   5. Optionally, to try alternatives from the same state, save the
+%   encoder state (engine, contexts and written bytes) and load it again
+%   before the next alternative, the bytes written after it are dropped
+%   state = SimpleCABACMex('saveState', handle);
+%   SimpleCABACMex('loadState', handle, state);
+%   A state is only valid until encodeFinish, and loading it invalidates
+%   the states saved after it. The statistics are not restored.
+%
+%   6. Optionally, to benchmark the engine with real bins, record the bins
+%   (with their contexts) and the coded bytes of every encoding into a
+%   file, which SimpleCABACReplay codes with all engine variants. Start it
+%   before encodeStart and stop it with an empty filename
+%   SimpleCABACMex('setCapture', handle, captureFn);
+%   SimpleCABACMex('setCapture', handle, '');
+%   The substreams, the wavefront and loadState can not be captured.
+%
 %   Decoding Steps: 
 %   1. Start the decoding engine
 %   SimpleCABACMex('decodeStart', handle); 
+%   or, when decoding from memory, provide the coded bytes as uint8 array
+%   SimpleCABACMex('decodeStart', handle, bytes); 
 %   2. Decode a bin from a context
 %   [decodedBin] = SimpleCABACMex('decodeBin', handle, ctxId);
+%   or, if the context sequence is known in advance, decode one bin per
+%   entry of ctxIds at once (returned as uint8 array of the same size)
+%   [decodedBins] = SimpleCABACMex('decodeBins', handle, ctxIds);
 %   3. Decode more bits and finally deactivate the coding engine
 % 	SimpleCABACMex('decodeFinish', handle);
 %   4. Optionally, before you finish decoding, retrieve some statistics
 %   for a specific context
-%   [trace, stats] = SimpleCABACMex('getEncoderStats',handle,ctxId);
+%   [trace, stats] = SimpleCABACMex('getDecoderStats',handle,ctxId);
+%   trace is a 5xN uint8 array of the recorded steps [bin; state before;
+%   mps before; state after; mps after] (empty unless tracing 'steps'),
+%   stats(a,p) counts the transitions from state p-1 to state a-1
+%
+%   Substreams:
+%   The bins can also be coded as independent substreams, each one with
+%   its own coding engine starting from the initial contexts. The
+%   substreams are coded in parallel by numThreads threads (0 or omitted:
+%   all cores) and stored behind an entry point table. Substream i starts
+%   with bin firstBin(i) (0-based, firstBin(1) = 0). Only in memory.
+%   [bytes, substreamBits, singleStreamBits] = SimpleCABACMex(...
+%     'encodeSubstreams', handle, binValues, ctxIds, firstBin, numThreads);
+%   singleStreamBits is the size of the same bins coded as one stream.
+%   If the contexts are known in advance, decode all substreams with
+%   [decodedBins] = SimpleCABACMex('decodeSubstreams', handle, bytes,...
+%     ctxIds, firstBin, numThreads);
+%   the substreams of a matrix with decodeMatrix (see Matrix),
+%   otherwise decode one substream after the other with the decoding
+%   steps below, starting each one with
+%   SimpleCABACMex('decodeStart', handle, bytes, substreamIdx);
+%   The substreams are not traced.
+%
+%   Wavefront:
+%   Like substreams, but every column starts with the contexts of the
+%   column to its left at its sync point instead of the initial contexts.
+%   Column i starts with bin firstBin(i) and column i+1 can start as soon
+%   as column i reaches bin syncBin(i) (both 0-based indices into
+%   binValues, firstBin(i) <= syncBin(i) <= firstBin(i+1)).
+%   [bytes, substreamBits, singleStreamBits] = SimpleCABACMex(...
+%     'encodeWavefront', handle, binValues, ctxIds, firstBin, syncBin,...
+%     numThreads);
+%   [decodedBins] = SimpleCABACMex('decodeWavefront', handle, bytes,...
+%     ctxIds, firstBin, syncBin, numThreads);
+%   A matrix coded with a wavefront column per column of G is decoded
+%   with decodeMatrix (see Matrix).
+%   When decoding bin by bin, store the contexts at the sync point of
+%   the current column with
+%   SimpleCABACMex('wavefrontSync', handle);
+%   and start the next column with the stored contexts by
+%   SimpleCABACMex('decodeStart', handle, bytes, columnIdx, 'wavefront');
+%
+%   Matrix:
+%   Binarize a matrix of quantization indices G (0...Nq-1) with binMethod
+%   (see cabacBinarizer), select the context of every bin with cmTypes
+%   and Nlbp like cabacContextSelection and encode the columns of G one
+%   after another in one call, including encodeStart and encodeFinish.
+%   The session needs the 7*Nlbp+2 contexts of cabacInitContextModel.
+%   [bytes, ctxHist, H] = SimpleCABACMex('encodeMatrix', handle, G, Nq,...
+%     binMethod, cmTypes, Nlbp);
+%   bytes is empty if coding into a file, ctxHist counts the coded bins
+%   per context ID (1-based) and H(d,k) the bits written for G(d,k).
+%   Decode such a stream into a matrix of size siz = [rows cols] with
+%   [G] = SimpleCABACMex('decodeMatrix', handle, siz, Nq, binMethod,...
+%     cmTypes, Nlbp, bytes);
+%   (bytes only when decoding from memory), including decodeStart and
+%   decodeFinish. G is uint8 for Nq <= 256, int32 up to Nq = 2^31 and
+%   double above. If the columns of G were coded as substreams with
+%   encodeSubstreams, substream i holding the columns from firstCol(i)
+%   (0-based, firstCol(1) = 0), decode them in parallel with
+%   [G] = SimpleCABACMex('decodeMatrix', handle, siz, Nq, binMethod,...
+%     cmTypes, Nlbp, bytes, 'substreams', firstCol, numThreads);
+%   and with encodeWavefront, every column syncing after its first
+%   syncRow rows (syncBin is the first bin of row syncRow+1), with
+%   [G] = SimpleCABACMex('decodeMatrix', handle, siz, Nq, binMethod,...
+%     cmTypes, Nlbp, bytes, 'wavefront', syncRow, numThreads);
+%
+%   Rate estimation:
+%   Estimate the size of a stream without coding it, from the sum of the
+%   entropies of the bins with the adapting contexts (1/32768 bit steps).
+%   The contexts start from their initialization, the session is not
+%   changed.
+%   [bits, ctxBits, codedBits] = SimpleCABACMex('estimateBits', handle,...
+%     bins, ctxIdx);
+%   [bits, ctxBits, codedBits] = SimpleCABACMex('estimateBits', handle,...
+%     G, Nq, binMethod, cmTypes, Nlbp);
+%   bits is the estimate including the termination of the stream, ctxBits
+%   the estimated bits per context ID (1-based). The actual size codedBits
+%   is only determined if requested. The estimate is typically within
+%   0.2% of the coded size.
+%
+%   Configuration search:
+%   Code a matrix G with every combination of the candidates like
+%   cabacEncode, i.e. with the initial probabilities of
+%   cabacInitContextModel quantized to 8 bits, and rank the combinations.
+%   T = SimpleCABACMex('searchConfig', handle, G, Nq, binMethods,...
+%     cmTypes, Nlbps, numThreads);
+%   binMethods is a cell array of binMethod, cmTypes a cell array of
+%   cmTypes (or a single cmTypes) and Nlbps a vector. The combinations are
+%   coded in parallel, numThreads = 0 or missing uses all cores. Every row
+%   of T is a combination, the best first:
+%   [binMethod index, cmTypes index, Nlbp, total bits, coded bits,
+%   ctxInit bits], the total is the sum of the coded bits and the 8 bits
+%   per context of ctxInit. The contexts of the session are not used.
+%
+%   To code a new stream with the same context initialization, set the
+%   contexts back to their initial states and clear the statistics with
+%   SimpleCABACMex('reset', handle);
+%   When the handle is not needed anymore, release it with
+%   SimpleCABACMex('destroy', handle);
+%   The handle is invalid afterwards, the memory is reused by the next
+%   init.
 %
-%   Created with: 
-%   MATLAB R2016b
-%   Platform: win64
-%   Microsoft Visual C++ 2015 
+%   Build with (see README.md): 
+%   mex CXXFLAGS="\$CXXFLAGS -std=c++11 -pthread" LDFLAGS="\$LDFLAGS -pthread" SimpleCABACMex.cpp
 
 %   MEX File function.
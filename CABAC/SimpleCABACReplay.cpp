@@ -0,0 +1,315 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.  
+ *
+ * Copyright (c) 2016-2017, Institut für Nachrichtentechnik, RWTH Aachen University
+ *
+ * Christian Feldmann, Christian Rohlfing, Yingbo Gao, Max Bläser
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ 
+// Replay of captured bin streams (cabac_replay)
+// Reads a capture written by CABAC_BinCapture, e.g. by SimpleCABACMex after 'setCapture' while
+// ISS codes its matrices (p.cabac.captureFile), and codes the recorded bins with the same 
+// contexts through the 32 bit and the 64 bit encoder and through decodeBin and decodeBinPacked.
+// So engine changes can be timed with the real context switching of cabacContextSelection
+// instead of synthetic bins. Every encoder has to reproduce the captured bytes (size and hash,
+// if the capture holds them), every decoder the captured bins. The time of a variant is the
+// fastest of the repetitions, summed over all encodings of the capture. Like SimpleCABACBench,
+// the results are printed as table or as JSON array and the exit code is 1 on a mismatch.
+// Usage: SimpleCABACReplay capture [repetitions] [--json]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+
+#include "CABAC_ArithmeticEncoder.h"
+#include "CABAC_ArithmeticEncoder64.h"
+#include "CABAC_ArithmeticDecoder.h"
+#include "CABAC_BitstreamMemory.h"
+#include "CABAC_BinCapture.h"
+#include "ContextModel.h"
+#include "ContextModelDualRate.h"
+#include "CommonDef.h"
+
+using namespace std;
+
+/// one variant, printed by xReport
+struct ReplayResult
+{
+  const char *operation;  ///< encode or decode
+  const char *engine;
+  size_t      numBins;
+  size_t      numBytes;
+  double      seconds;    ///< fastest repetition
+  bool        ok;
+};
+
+// code the bins of one stream, models is a copy of the contexts at its start
+template <class TEncoder, class TModel>
+static double xEncodeStream(const CABAC_CapturedStream &s, vector<TModel> models, TEncoder &encoder)
+{
+  const CABAC_CapturedBin *bins = s.bins.empty() ? NULL : &s.bins[0];
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  encoder.start();
+  for (size_t i = 0; i < s.bins.size(); i++)
+  {
+    switch (bins[i].ucKind)
+    {
+    case CABAC_CAPTURE_CTX: encoder.encodeBin(bins[i].ucBin, &models[bins[i].uiCtxIdx]); break;
+    case CABAC_CAPTURE_EP:  encoder.encodeBinEP(bins[i].ucBin); break;
+    default:                encoder.encodeBinTrm(bins[i].ucBin); break;
+    }
+  }
+  encoder.finish();
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// encode all streams of the capture, returns the time in seconds
+template <class TEncoder>
+static double xEncode(const vector<CABAC_CapturedStream> &streams, vector<CABAC_BitstreamMemory> &outStreams)
+{
+  double seconds = 0;
+  for (size_t k = 0; k < streams.size(); k++)
+  {
+    outStreams[k].openOutput(streams[k].bins.size() / 8);
+    TEncoder encoder(&outStreams[k]);
+    seconds += streams[k].bDualRate ? xEncodeStream(streams[k], streams[k].dualRateModels, encoder)
+                                    : xEncodeStream(streams[k], streams[k].models, encoder);
+  }
+  return seconds;
+}
+
+// decode the bins of one stream and count the bins differing from the capture
+template <bool bPacked, class TModel>
+static double xDecodeStream(const CABAC_CapturedStream &s, vector<TModel> models, const CABAC_BitstreamMemory &encoded, size_t &rNumErrors)
+{
+  CABAC_BitstreamMemory inStream;
+  inStream.openInput(encoded.getData(), encoded.getNumBytes());
+  CABAC_ArithmeticDecoderMemory decoder(&inStream);
+  const CABAC_CapturedBin *bins = s.bins.empty() ? NULL : &s.bins[0];
+  size_t numErrors = 0;
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  decoder.start();
+  for (size_t i = 0; i < s.bins.size(); i++)
+  {
+    unsigned int uiBin;
+    switch (bins[i].ucKind)
+    {
+    case CABAC_CAPTURE_CTX: 
+      if (bPacked)
+      {
+        decoder.decodeBinPacked(uiBin, &models[bins[i].uiCtxIdx]);
+      }
+      else
+      {
+        decoder.decodeBin(uiBin, &models[bins[i].uiCtxIdx]);
+      }
+      break;
+    case CABAC_CAPTURE_EP:  decoder.decodeBinEP(uiBin); break;
+    default:                decoder.decodeBinTrm(uiBin); break;
+    }
+    numErrors += (uiBin != bins[i].ucBin);
+  }
+  decoder.finish();
+  double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  rNumErrors += numErrors;
+  return seconds;
+}
+
+// decode all streams of the capture, returns the time in seconds
+template <bool bPacked>
+static double xDecode(const vector<CABAC_CapturedStream> &streams, const vector<CABAC_BitstreamMemory> &encoded, bool &rbOk)
+{
+  double seconds = 0;
+  size_t numErrors = 0;
+  for (size_t k = 0; k < streams.size(); k++)
+  {
+    seconds += streams[k].bDualRate ? xDecodeStream<bPacked>(streams[k], streams[k].dualRateModels, encoded[k], numErrors)
+                                    : xDecodeStream<bPacked>(streams[k], streams[k].models, encoded[k], numErrors);
+  }
+  rbOk = (numErrors == 0);
+  return seconds;
+}
+
+// true if all streams were coded into the captured bytes (as far as they are known) and into the reference
+static bool xCheckOutput(const vector<CABAC_CapturedStream> &streams, const vector<CABAC_BitstreamMemory> &outStreams, 
+                         const vector<CABAC_BitstreamMemory> &reference)
+{
+  for (size_t k = 0; k < streams.size(); k++)
+  {
+    const CABAC_BitstreamMemory &out = outStreams[k];
+    if (streams[k].bHasOutput && (out.getNumBytes() != streams[k].uiNumBytes 
+        || CABAC_BinCapture::hash(out.getData(), out.getNumBytes()) != streams[k].uiHash))
+    {
+      return false;
+    }
+    if (out.getNumBytes() != reference[k].getNumBytes() 
+        || (out.getNumBytes() && memcmp(out.getData(), reference[k].getData(), out.getNumBytes())))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static size_t xGetNumBytes(const vector<CABAC_BitstreamMemory> &outStreams)
+{
+  size_t numBytes = 0;
+  for (size_t k = 0; k < outStreams.size(); k++)
+  {
+    numBytes += outStreams[k].getNumBytes();
+  }
+  return numBytes;
+}
+
+// print a result as table row or JSON object
+static void xReport(const ReplayResult &r, bool bJson, bool bFirst)
+{
+  const double binsPerSecond = r.numBins / r.seconds;
+  const double nsPerBin = r.seconds * 1e9 / r.numBins;
+  const double bytesPerSecond = r.numBytes / r.seconds;
+  if (bJson)
+  {
+    printf("%s\n  {\"operation\": \"%s\", \"engine\": \"%s\", \"bins\": %zu, \"bytes\": %zu, \"seconds\": %.6f, "
+      "\"bins_per_s\": %.0f, \"ns_per_bin\": %.3f, \"bytes_per_s\": %.0f, \"ok\": %s}",
+      bFirst ? "" : ",", r.operation, r.engine, r.numBins, r.numBytes, r.seconds,
+      binsPerSecond, nsPerBin, bytesPerSecond, r.ok ? "true" : "false");
+  }
+  else
+  {
+    printf("%-6s %-16s %10zu bins %9zu bytes %8.1f Mbins/s %6.2f ns/bin %8.1f MB/s%s\n",
+      r.operation, r.engine, r.numBins, r.numBytes, 
+      binsPerSecond * 1e-6, nsPerBin, bytesPerSecond * 1e-6, r.ok ? "" : "  MISMATCH");
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  const char *cFileName = NULL;
+  int iRepetitions = 5;
+  bool bJson = false;
+  for (int i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i], "--json"))
+    {
+      bJson = true;
+    }
+    else if (!cFileName)
+    {
+      cFileName = argv[i];
+    }
+    else
+    {
+      iRepetitions = atoi(argv[i]) > 0 ? atoi(argv[i]) : 1;
+    }
+  }
+  if (!cFileName)
+  {
+    fprintf(stderr, "Usage: SimpleCABACReplay capture [repetitions] [--json]\n");
+    return 2;
+  }
+
+  vector<CABAC_CapturedStream> streams;
+  if (!CABAC_BinCapture::read(cFileName, streams))
+  {
+    fprintf(stderr, "\nfailed to read the capture `%s'\n", cFileName);
+    return 2;
+  }
+  size_t numBins = 0, aNumKind[3] = { 0, 0, 0 };
+  for (size_t k = 0; k < streams.size(); k++)
+  {
+    numBins += streams[k].bins.size();
+    for (size_t i = 0; i < streams[k].bins.size(); i++)
+    {
+      aNumKind[streams[k].bins[i].ucKind]++;
+    }
+  }
+  if (!bJson)
+  {
+    printf("%s: %d encodings, %zu context coded, %zu bypass and %zu terminating bins\n", 
+      cFileName, (int)streams.size(), aNumKind[CABAC_CAPTURE_CTX], aNumKind[CABAC_CAPTURE_EP], aNumKind[CABAC_CAPTURE_TRM]);
+  }
+  if (numBins == 0)
+  {
+    return 0;
+  }
+
+  // the fastest of the repetitions, the outputs of the first repetition are checked
+  vector<CABAC_BitstreamMemory> outStreams(streams.size()), outStreams64(streams.size());
+  double tEnc = 0, tEnc64 = 0, tDec = 0, tPacked = 0;
+  bool bDecOk = true, bPackedOk = true, bEncOk = true, bEnc64Ok = true;
+  for (int r = 0; r < iRepetitions; r++)
+  {
+    double t = xEncode<CABAC_ArithmeticEncoderMemory>(streams, outStreams);
+    tEnc = (r == 0 || t < tEnc) ? t : tEnc;
+    t = xEncode<CABAC_ArithmeticEncoder64Memory>(streams, outStreams64);
+    tEnc64 = (r == 0 || t < tEnc64) ? t : tEnc64;
+    if (r == 0)
+    {
+      bEncOk = xCheckOutput(streams, outStreams, outStreams64);
+      bEnc64Ok = xCheckOutput(streams, outStreams64, outStreams);
+    }
+    bool bOk;
+    t = xDecode<false>(streams, outStreams, bOk);
+    tDec = (r == 0 || t < tDec) ? t : tDec;
+    bDecOk = bDecOk && bOk;
+    t = xDecode<true>(streams, outStreams, bOk);
+    tPacked = (r == 0 || t < tPacked) ? t : tPacked;
+    bPackedOk = bPackedOk && bOk;
+  }
+
+  const size_t numBytes = xGetNumBytes(outStreams);
+  const ReplayResult results[] = 
+  {
+    { "encode", "encoder",         numBins, numBytes, tEnc,    bEncOk },
+    { "encode", "encoder64",       numBins, numBytes, tEnc64,  bEnc64Ok },
+    { "decode", "decodeBin",       numBins, numBytes, tDec,    bDecOk },
+    { "decode", "decodeBinPacked", numBins, numBytes, tPacked, bPackedOk }
+  };
+  int iResult = 0;
+  if (bJson)
+  {
+    printf("[");
+  }
+  for (size_t i = 0; i < sizeof(results) / sizeof(results[0]); i++)
+  {
+    xReport(results[i], bJson, i == 0);
+    if (!results[i].ok)
+    {
+      iResult = 1;
+    }
+  }
+  if (bJson)
+  {
+    printf("\n]\n");
+  }
+  return iResult;
+}
@@ -17,7 +17,7 @@ function cabacDemo()
 
   % check if the SimpleCABAC MEX file exists
   if ~(exist('SimpleCABACMex')==3) %#ok<EXIST>
-    mex CXXFLAGS="\$CXXFLAGS -std=c++11" SimpleCABACMex.cpp
+    mex CXXFLAGS="\$CXXFLAGS -std=c++11 -pthread" LDFLAGS="\$LDFLAGS -pthread" SimpleCABACMex.cpp
   end
 
   %% Test symbols
@@ -79,6 +79,8 @@ function cabacDemo()
 
   % Create and initialize CABAC object
   encoder = cabacWrapper(ctxInit, param.filename);
+  % Collect the context state statistics for cabacVisualize
+  encoder.setTraceMode('counters');
   
   % Init
   encoder.encodeStart();
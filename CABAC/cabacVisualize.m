@@ -54,24 +54,26 @@ function cabacVisualize(encoder,ctxInit,ctxHist,H,titleStrings,Ncols)
       if it > length(ctxInit), break; end
       ax=subplot(Nrows,Ncols,it);
       
-      % Get debug trace from encoder
-      trace = encoder.getEncoderStats(it-1); trace = trace'; 
+      % Get state statistics from encoder (needs tracing 'counters' or
+      % 'steps'), stats(a,p) counts the transitions from state p-1 to a-1
+      [~, stats] = encoder.getEncoderStats(it-1);
+      stateCount = sum(double(stats),2);
       
       % Shift states
-      state0 = double(trace(:,4));
+      state0 = (0:127)';
       state = zeros(size(state0));
       mask = state0<=63; state(mask) = state0(mask)-64;
       mask = state0>=64; state(mask) = state0(mask)-63;
       
       % Histogram of state indices
-      histogram(state,-63.5:1:63.5);
+      bar(ax,state,stateCount,1);
       ax.XLim = [-64 64]; grid(ax, 'on'); hold(ax, 'all');
       % Initial state
       line(ax,[stateInit(it) stateInit(it)], [0 ax.YLim(2)], 'Color', [1 0 0], 'LineWidth',2);
       % Zero line
       line(ax,[0 0], [0 ax.YLim(2)], 'Color', 0.25*[1 1 1], 'LineWidth',1);
       
-      title(ax,sprintf('%s, total count: $%d$',titleStrings{it},length(state)),textArgs{:});
+      title(ax,sprintf('%s, total count: $%d$',titleStrings{it},sum(stateCount)),textArgs{:});
       
       % Beautify the plot
       ax.XTick = -60:20:60; ax.XTickLabel(1:3) = cellfun(@num2str,num2cell(60:-20:20),'unif',0); ax.TickLabelInterpreter = 'latex';ax.FontSize=fs2;
@@ -10,11 +10,14 @@ classdef cabacWrapper < handle
 		bitStreamName;
 		cabac_handle;
 		contextModelInitOptions; % [ctxID mps probIndex; ctxID mps probIndex; ...]
+		probabilityModel; % 'hevc' or 'dualRate' (only with initByProb)
 	end
 	methods
-		function obj = cabacWrapper(cm,fn,initByProb)
+		function obj = cabacWrapper(cm,fn,initByProb,probModel)
 			% contructor, set bitStreamName, context model
       if nargin < 3, initByProb=1; end
+      if nargin < 4, probModel='hevc'; end
+      obj.probabilityModel = probModel;
       
       if ischar(fn)
         obj.bitStreamName = fn;
@@ -31,8 +34,9 @@ classdef cabacWrapper < handle
 		function init(obj,initByProb)
       if nargin < 2, initByProb=1; end
 			% initialize the cabac class in cpp
+      obj.delete();
       if initByProb
-        obj.cabac_handle = SimpleCABACMex('initByProb', obj.bitStreamName,obj.contextModelInitOptions);
+        obj.cabac_handle = SimpleCABACMex('initByProb', obj.bitStreamName,obj.contextModelInitOptions,obj.probabilityModel);
       else
         obj.cabac_handle = SimpleCABACMex('initByState', obj.bitStreamName,obj.contextModelInitOptions);
       end
@@ -50,22 +54,50 @@ classdef cabacWrapper < handle
 				error('bin value to be encoded should either be 1 or 0');
 			end
 		end
-		function encodeFinish(obj)
-			% encode finish
-			SimpleCABACMex('encodeFinish', obj.cabac_handle);
+		function encodeBins(obj,binValues, ctxIDs)
+			% encode a vector of bins, binValues(i) is coded into context ctxIDs(i)
+			SimpleCABACMex('encodeBins', obj.cabac_handle, binValues, ctxIDs);
 		end
-		function decodeStart(obj)
-			% decode start
-			SimpleCABACMex('decodeStart', obj.cabac_handle);
+		function bytes = encodeFinish(obj)
+			% encode finish, returns the coded bytes if bitStreamName is empty
+			if nargout > 0
+				bytes = SimpleCABACMex('encodeFinish', obj.cabac_handle);
+			else
+				SimpleCABACMex('encodeFinish', obj.cabac_handle);
+			end
+		end
+		function decodeStart(obj, bytes, substream, mode)
+			% decode start, decodes the uint8 array bytes if bitStreamName is empty
+			% or the substream (0-based) of the output of encodeSubstreams,
+			% mode 'wavefront' starts with the contexts stored by wavefrontSync
+			if nargin > 3
+				SimpleCABACMex('decodeStart', obj.cabac_handle, bytes, substream, mode);
+			elseif nargin > 2
+				SimpleCABACMex('decodeStart', obj.cabac_handle, bytes, substream);
+			elseif nargin > 1
+				SimpleCABACMex('decodeStart', obj.cabac_handle, bytes);
+			else
+				SimpleCABACMex('decodeStart', obj.cabac_handle);
+			end
 		end
 		function decodedBin = decodeBin(obj, ctxID)
 			% decode bin
 			decodedBin = SimpleCABACMex('decodeBin', obj.cabac_handle, ctxID);
 		end
+		function decodedBins = decodeBins(obj, ctxIDs)
+			% decode one bin per entry of ctxIDs, returned as uint8 array
+			decodedBins = SimpleCABACMex('decodeBins', obj.cabac_handle, ctxIDs);
+		end
 		function decodeFinish(obj)
 			% decode finish
 			SimpleCABACMex('decodeFinish', obj.cabac_handle);
     end
+    function setTraceMode(obj, mode, ringSize, sampleInterval)
+      % mode is 'off', 'counters' or 'steps', see SimpleCABACMex.m
+      if nargin < 3, ringSize = 65536; end
+      if nargin < 4, sampleInterval = 1; end
+      SimpleCABACMex('setTraceMode', obj.cabac_handle, mode, ringSize, sampleInterval);
+    end
     function [trace, stats] = getEncoderStats(obj, ctxID)
       [trace, stats] = SimpleCABACMex('getEncoderStats',obj.cabac_handle,ctxID);
     end
@@ -74,6 +106,93 @@ classdef cabacWrapper < handle
     end
     function [bits] = getNumBits(obj)
       [bits] = SimpleCABACMex('getNumBits',obj.cabac_handle);
+    end
+    function state = saveState(obj)
+      % save the encoder state to continue from it later with loadState
+      state = SimpleCABACMex('saveState',obj.cabac_handle);
+    end
+    function loadState(obj, state)
+      % continue encoding from a state saved by saveState
+      SimpleCABACMex('loadState',obj.cabac_handle,state);
+    end
+    function setCapture(obj, fn)
+      % record the bins of the following encodings into the file fn for
+      % SimpleCABACReplay, '' stops recording
+      SimpleCABACMex('setCapture',obj.cabac_handle,fn);
+    end
+    function varargout = encodeSubstreams(obj, binValues, ctxIDs, firstBin, numThreads)
+      % [bytes, substreamBits, singleStreamBits] = encodeSubstreams(...)
+      % encode independent substreams in parallel, substream i starts with bin firstBin(i) (0-based)
+      if nargin < 5, numThreads = 0; end
+      [varargout{1:max(nargout,1)}] = SimpleCABACMex('encodeSubstreams', obj.cabac_handle, binValues, ctxIDs, firstBin, numThreads);
+    end
+    function decodedBins = decodeSubstreams(obj, bytes, ctxIDs, firstBin, numThreads)
+      % decode the output of encodeSubstreams in parallel, if the contexts are known in advance
+      if nargin < 5, numThreads = 0; end
+      decodedBins = SimpleCABACMex('decodeSubstreams', obj.cabac_handle, bytes, ctxIDs, firstBin, numThreads);
+    end
+    function varargout = encodeWavefront(obj, binValues, ctxIDs, firstBin, syncBin, numThreads)
+      % [bytes, substreamBits, singleStreamBits] = encodeWavefront(...)
+      % encode wavefront columns in parallel, column i starts with bin firstBin(i) and
+      % with the contexts of column i-1 before its bin syncBin(i-1) (0-based)
+      if nargin < 6, numThreads = 0; end
+      [varargout{1:max(nargout,1)}] = SimpleCABACMex('encodeWavefront', obj.cabac_handle, binValues, ctxIDs, firstBin, syncBin, numThreads);
+    end
+    function decodedBins = decodeWavefront(obj, bytes, ctxIDs, firstBin, syncBin, numThreads)
+      % decode the output of encodeWavefront in parallel, if the contexts are known in advance
+      if nargin < 6, numThreads = 0; end
+      decodedBins = SimpleCABACMex('decodeWavefront', obj.cabac_handle, bytes, ctxIDs, firstBin, syncBin, numThreads);
+    end
+    function wavefrontSync(obj)
+      % store the current decoder contexts for the next wavefront column
+      SimpleCABACMex('wavefrontSync', obj.cabac_handle);
+    end
+    function [bytes, ctxHist, H] = encodeMatrix(obj, G, Nq, binMethod, cmTypes, Nlbp)
+      % binarize the quantization indices G, select the contexts like cabacContextSelection
+      % and encode them column by column in one call, bytes is empty if coding into a file.
+      % ctxHist counts the bins per context ID (1-based), H(d,k) holds the bits of G(d,k)
+      [bytes, ctxHist, H] = SimpleCABACMex('encodeMatrix', obj.cabac_handle, G, Nq, binMethod, cmTypes, Nlbp);
+    end
+    function G = decodeMatrix(obj, siz, Nq, binMethod, cmTypes, Nlbp, varargin)
+      % decode the output of encodeMatrix into a matrix of size siz in one call,
+      % from the uint8 array bytes if bitStreamName is empty: decodeMatrix(..., bytes).
+      % decodeMatrix(..., bytes, 'substreams', firstCol, numThreads) decodes the output of
+      % encodeSubstreams in parallel, substream i holds the columns from firstCol(i) (0-based),
+      % decodeMatrix(..., bytes, 'wavefront', syncRow, numThreads) the output of encodeWavefront
+      % with one column per substream, which syncs after its first syncRow rows
+      G = SimpleCABACMex('decodeMatrix', obj.cabac_handle, siz, Nq, binMethod, cmTypes, Nlbp, varargin{:});
+    end
+    function varargout = estimateBits(obj, varargin)
+      % estimate the size of the bins with the context initialization without
+      % coding them, either estimateBits(bins, ctxIdx) or like encodeMatrix
+      % estimateBits(G, Nq, binMethod, cmTypes, Nlbp).
+      % [bits, ctxBits, codedBits]: ctxBits holds the bits per context ID (1-based),
+      % codedBits the actual size, which is only coded if requested
+      [varargout{1:max(nargout,1)}] = SimpleCABACMex('estimateBits', obj.cabac_handle, varargin{:});
+    end
+    function ranking = searchConfig(obj, G, Nq, binMethods, cmTypes, Nlbps, numThreads)
+      % code G with every combination of the binMethods, cmTypes (cell array of
+      % cmTypes) and Nlbps like cabacEncode, each with its own init statistics,
+      % in parallel. ranking holds the configurations sorted by totalBits, the
+      % sum of the codedBits and the ctxInitBits (8 bits per context)
+      if nargin < 7, numThreads = 0; end
+      if ischar(binMethods), binMethods = {binMethods}; end
+      if isempty(cmTypes) || ~iscell(cmTypes{1}), cmTypes = {cmTypes}; end
+      binMethods = binMethods(:)'; cmTypes = cmTypes(:)';
+      T = SimpleCABACMex('searchConfig', obj.cabac_handle, G, Nq, binMethods, cmTypes, Nlbps, numThreads);
+      ranking = struct('binMethod', binMethods(T(:,1)), 'cmTypes', cmTypes(T(:,2)), 'Nlbp', num2cell(T(:,3)'), ...
+        'totalBits', num2cell(T(:,4)'), 'codedBits', num2cell(T(:,5)'), 'ctxInitBits', num2cell(T(:,6)'));
+    end
+    function reset(obj)
+      % set the contexts back to their initialization and clear the statistics
+      SimpleCABACMex('reset', obj.cabac_handle);
+    end
+    function delete(obj)
+      % release the cabac instance in cpp, also called when the object is destroyed
+      if ~isempty(obj.cabac_handle)
+        SimpleCABACMex('destroy', obj.cabac_handle);
+        obj.cabac_handle = [];
+      end
     end
 	end
 end
\ No newline at end of file
@@ -1,4 +1,4 @@
-function [nbits, ctxInit0] = cabacEncode(G,Nq,param)
+function [nbits, ctxInit0, bytes] = cabacEncode(G,Nq,param)
 %-------------------------------------------------------------------------%
 % Encode integer values (between 0 and Nq-1) stored in G with CABAC
 %
@@ -8,6 +8,30 @@ function [nbits, ctxInit0] = cabacEncode(G,Nq,param)
   if nargin < 1, ISS(); return; end
   addpath('../CABAC')
   param.DEMO = parseinput(param,'DEMO',0);
+  param.fn = parseinput(param,'fn',''); % empty filename: code into memory
+  param.numSubstreams = parseinput(param,'numSubstreams',1); % >1: code groups of components as independent substreams
+  param.wavefrontRows = parseinput(param,'wavefrontRows',0); % >0: code every component as wavefront column, see below
+  param.numThreads = parseinput(param,'numThreads',0); % threads coding the substreams, 0: all cores
+  param.estimate = parseinput(param,'estimate',0); % 1: only estimate nbits (see estimateBits), bytes is empty
+  param.probModel = parseinput(param,'probModel','hevc'); % 'dualRate': contexts with two adaptation rates, single stream only
+  param.captureFile = parseinput(param,'captureFile',''); % record the coded bins into this file for SimpleCABACReplay, single stream only
+  param.numSubstreams = min(param.numSubstreams, size(G,2));
+  isParallel = param.numSubstreams > 1 || param.wavefrontRows > 0;
+  if isParallel && ~isempty(param.fn)
+    error('substreams are only coded into memory (empty filename)')
+  end
+  if param.numSubstreams > 1 && param.wavefrontRows > 0
+    error('use either numSubstreams or wavefrontRows')
+  end
+  if param.estimate && isParallel
+    error('the size is only estimated for a single stream')
+  end
+  if ~strcmp(param.probModel,'hevc') && (isParallel || param.estimate)
+    error('the dual-rate probability model only codes a single stream')
+  end
+  if ~isempty(param.captureFile) && (isParallel || param.estimate)
+    error('only a single coded stream can be captured')
+  end
   
   if nargin < 2, Nq = 2; end % number of quantization intervals
   
@@ -31,47 +55,84 @@ function [nbits, ctxInit0] = cabacEncode(G,Nq,param)
   ctxInit  = double(ctxInit0)/255; % this should match the dequantization done at decoderside
   
   % Create and initialize CABAC object
-  c = cabacWrapper(ctxInit, param.fn);
+  c = cabacWrapper(ctxInit, param.fn, 1, param.probModel);
+  % Collect the context state statistics for cabacVisualize (HEVC states only)
+  isTraced = param.DEMO && strcmp(param.probModel,'hevc');
+  if isTraced, c.setTraceMode('counters'); end
+  % Record the bins, contexts and coded bytes of the encoding
+  if ~isempty(param.captureFile), c.setCapture(param.captureFile); end
+  
+  if param.estimate
+    % Sum up the entropy of the bins with the adapting contexts, nothing is coded
+    nbits = c.estimateBits(G, Nq, param.binMethod, param.cmTypes, param.Nlbp);
+    bytes = [];
+    fprintf('CABAC estimation: %.0f bits\n', nbits);
+    return
+  end
   
-  % Init
-  c.encodeStart();
+  % First component of every substream, the left neighbor is not used across substreams
+  firstCol = floor((0:param.numSubstreams-1)*size(Gbin,2)/param.numSubstreams)+1;
+  binsCell = cell(size(Gbin)); ctxCell = cell(size(Gbin));
   
   % Statistics for debugging
   ctxHist = zeros(1,7*param.Nlbp+3); % Histogram of context selection
-  ctxCost = ctxHist;
   H = zeros(size(G)); % Heat map
   
   fprintf('CABAC encoding...')
-  for k=1:size(Gbin,2) % components      
-    for d=1:size(Gbin,1) % either frequency f or time t
-      % Binarized quantization index to encode
-      g = Gbin{d,k};
-      tmpBits = c.getNumBits();
+  if ~isParallel
+    % Binarize, select the contexts and encode all values in one call
+    [bytes, ctxHist, H] = c.encodeMatrix(G, Nq, param.binMethod, param.cmTypes, param.Nlbp);
+    if ~isempty(param.captureFile), c.setCapture(''); end
+  else
+    % Collect the bins and contexts of all substreams
+    for k=1:size(Gbin,2) % components
+      for d=1:size(Gbin,1) % either frequency f or time t
+        % Binarized quantization index to encode
+        g = Gbin{d,k};
 
-      % Get neighboring binarized quantization indices for contex selection
-      if d>1, g_up1 = Gbin{d-1,k}; else, g_up1=[]; end
-      if d>2, g_up2 = Gbin{d-2,k}; else, g_up2=[]; end
-      if k>1, g_lft = Gbin{d,k-1}; else, g_lft=[]; end
+        % Get neighboring binarized quantization indices for contex selection
+        if d>1, g_up1 = Gbin{d-1,k}; else, g_up1=[]; end
+        if d>2, g_up2 = Gbin{d-2,k}; else, g_up2=[]; end
+        if k>1 && ~any(k==firstCol), g_lft = Gbin{d,k-1}; else, g_lft=[]; end
 
-      % Loop over binarized quantization index  
-      for cnt=1:length(g) 
-        % Select corresponing contex
-        ctxID = coder.cabacContextSelection(cnt,g(1:(cnt-1)),g_up1,g_up2,g_lft,param.cmTypes,param.Nlbp);
-        ctxHist(ctxID) = ctxHist(ctxID) + 1;
-
-        % Encode
-        tmpBitsBin = c.getNumBits();
-        c.encodeBin(g(cnt),ctxID-1);
-        ctxCost(ctxID) = ctxCost(ctxID) + c.getNumBits() - tmpBitsBin;
-      end % bin index
-      H(d,k) = c.getNumBits()-tmpBits;
-    end  % either frequency f or time t
-    if mod(k,round(size(Gbin,2)/10))==0, fprintf('.'); end
-  end % components
+        % Loop over binarized quantization index  
+        ctxIDs = zeros(1,length(g));
+        for cnt=1:length(g) 
+          % Select corresponing contex
+          ctxIDs(cnt) = coder.cabacContextSelection(cnt,g(1:(cnt-1)),g_up1,g_up2,g_lft,param.cmTypes,param.Nlbp);
+          ctxHist(ctxIDs(cnt)) = ctxHist(ctxIDs(cnt)) + 1;
+        end % bin index
+      
+        % Collect the bins, the substreams are coded at once below
+        binsCell{d,k} = g; ctxCell{d,k} = ctxIDs-1;
+      end  % either frequency f or time t
+      if mod(k,round(size(Gbin,2)/10))==0, fprintf('.'); end
+    end % components
+  end
   disp('done!')
   
-  % DEMO
-  if param.DEMO
+  if isParallel
+    L = cellfun(@length,binsCell);
+    colBins = sum(L,1);
+    firstBin = [0 cumsum(colBins(1:end-1))];
+    if param.wavefrontRows > 0
+      % One substream per component, which starts with the contexts of
+      % the component to the left after its first wavefrontRows rows
+      syncBin = firstBin + sum(L(1:min(param.wavefrontRows,size(L,1)),:),1);
+      [bytes, ~, singleBits] = c.encodeWavefront([binsCell{:}], [ctxCell{:}], firstBin, syncBin, param.numThreads);
+      numSubstreams = size(L,2); mode = 'wavefront columns';
+    else
+      % Encode the substreams in parallel, each one starting from ctxInit
+      [bytes, ~, singleBits] = c.encodeSubstreams([binsCell{:}], [ctxCell{:}], firstBin(firstCol), param.numThreads);
+      numSubstreams = param.numSubstreams; mode = 'substreams';
+    end
+    nbits = numel(bytes)*8;
+    fprintf('%d %s: %d bits, %d bits (%.2f%%) more than a single stream, %d of them for the entry points\n', ...
+      numSubstreams, mode, nbits, nbits-singleBits, 100*(nbits-singleBits)/singleBits, 32*numSubstreams);
+  end
+  
+  % DEMO (the statistics are only collected for a single stream)
+  if isTraced && ~isParallel
     % TODO: titleStrings
     % Create fancy titles for each plot
     n=1:param.Nlbp;
@@ -93,10 +154,13 @@ function [nbits, ctxInit0] = cabacEncode(G,Nq,param)
   end % DEMO
   
   
-  % Tell engine to finish
-  c.encodeFinish();
-  
-  % Get bits
-  tmp = dir(param.fn);
-  nbits = tmp.bytes*8;
+  % Get bits, the engine is already finished
+  if isParallel
+    % already done
+  elseif isempty(param.fn)
+    nbits = numel(bytes)*8;
+  else
+    tmp = dir(param.fn);
+    nbits = tmp.bytes*8;
+  end
 end
\ No newline at end of file
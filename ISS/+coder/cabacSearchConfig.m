@@ -0,0 +1,28 @@
+function [param, ranking] = cabacSearchConfig(G,Nq,param)
+%-------------------------------------------------------------------------%
+% Choose binMethod, cmTypes and Nlbp for coding G with cabacEncode
+%
+%   Every combination of param.searchBinMethods, param.searchCmTypes and
+%   param.searchNlbp is coded with its own initial probabilities, the one
+%   with the least bits including ctxInit is written to param.
+%
+%   Christian Rohlfing
+%   (C) 2017 Institut fr Nachrichtentechnik, RWTH Aachen University
+
+  if nargin < 1, ISS(); return; end
+  addpath('../CABAC')
+  param.searchBinMethods = parseinput(param,'searchBinMethods',{'DEC2TU' 'DEC2TR0' 'DEC2TR1' 'DEC2EG0' 'DEC2EG1'});
+  param.searchCmTypes = parseinput(param,'searchCmTypes',{{'cond0' 'cond1' 'conds0' 'conds1'} {'cond0' 'cond1'} {'condbinlft'} {}});
+  param.searchNlbp = parseinput(param,'searchNlbp',1:4);
+  param.numThreads = parseinput(param,'numThreads',0);
+  
+  % The contexts of the session are not used by the search
+  c = cabacWrapper(0.5, '');
+  ranking = c.searchConfig(G, Nq, param.searchBinMethods, param.searchCmTypes, param.searchNlbp, param.numThreads);
+  
+  param.binMethod = ranking(1).binMethod;
+  param.cmTypes = ranking(1).cmTypes;
+  param.Nlbp = ranking(1).Nlbp;
+  fprintf('CABAC configuration: %s, {%s}, Nlbp %d: %d bits (%d configurations)\n', ...
+    param.binMethod, strjoin(param.cmTypes, ' '), param.Nlbp, ranking(1).totalBits, numel(ranking));
+end
@@ -51,6 +51,13 @@ function out = ISS(p)
   p.cabac.cmTypes = parseinput(p.cabac,'cmTypes', {'cond0' 'cond1' 'conds0' 'conds1'}); % context model types
   p.cabac.Nlbp = parseinput(p.cabac,'Nlbp',3); % position of last bin to be modeled with contexts (rest-context for all other bins)
   p.cabac.equalProb = parseinput(p.cabac,'equalProb',0);
+  p.cabac.numSubstreams = parseinput(p.cabac,'numSubstreams',1); % code groups of components as independent substreams
+  p.cabac.wavefrontRows = parseinput(p.cabac,'wavefrontRows',0); % code every component as wavefront column, synchronized after this many rows
+  p.cabac.numThreads = parseinput(p.cabac,'numThreads',0); % threads coding the substreams (0: all cores)
+  p.cabac.estimate = parseinput(p.cabac,'estimate',0); % estimate the bits instead of coding (no decoder check)
+  p.cabac.probModel = parseinput(p.cabac,'probModel','hevc'); % 'dualRate': probability estimation with two adaptation rates (no substreams, wavefront or estimate)
+  p.cabac.searchConfig = parseinput(p.cabac,'searchConfig',0); % choose binMethod, cmTypes and Nlbp for gW and gH with coder.cabacSearchConfig
+  p.cabac.captureFile = parseinput(p.cabac,'captureFile',''); % record the coded bins of gW and gH (name_W.ext, name_H.ext) for SimpleCABACReplay
   
   % Random seed
   p.randomseed = parseinput(p,'randomseed',0); % Random seed for consistency
@@ -182,16 +189,20 @@ function nbits = getBits(data, method, cabacParam, DEMO)
   
   switch method
     case 'CABAC'
-      % Create random filenames
-      fn = tempname;
-      fnW = sprintf('%s_W.bin',fn);
-      fnH = sprintf('%s_H.bin',fn);
-            
-      % Encode group indices
-      cabacParam.fn = fnW; cabacParam.DEMO = DEMO;
-      [bitsW, ctxInitW] = coder.cabacEncode(data.gW, length(data.cW), cabacParam);
-      cabacParam.fn = fnH; cabacParam.DEMO = DEMO;
-      [bitsH, ctxInitH] = coder.cabacEncode(data.gH, length(data.cH), cabacParam);
+      % Encode group indices into memory (empty filename)
+      cabacParam.fn = ''; cabacParam.DEMO = DEMO;
+      cabacParamW = cabacParam; cabacParamH = cabacParam;
+      if isfield(cabacParam,'searchConfig') && cabacParam.searchConfig % best configuration per matrix
+        cabacParamW = coder.cabacSearchConfig(data.gW, length(data.cW), cabacParam);
+        cabacParamH = coder.cabacSearchConfig(data.gH, length(data.cH), cabacParam);
+      end
+      if isfield(cabacParam,'captureFile') && ~isempty(cabacParam.captureFile) % one capture per matrix
+        [pth, name, ext] = fileparts(cabacParam.captureFile);
+        cabacParamW.captureFile = fullfile(pth, [name '_W' ext]);
+        cabacParamH.captureFile = fullfile(pth, [name '_H' ext]);
+      end
+      [bitsW, ctxInitW, bytesW] = coder.cabacEncode(data.gW, length(data.cW), cabacParamW);
+      [bitsH, ctxInitH, bytesH] = coder.cabacEncode(data.gH, length(data.cH), cabacParamH);
       
       % Encode rest (centroids and Q)
       paramRest=struct(); paramRest.cW = data.cW; paramRest.cH = data.cH; paramRest.Q = data.Q;
@@ -200,19 +211,16 @@ function nbits = getBits(data, method, cabacParam, DEMO)
       end
       nbits = bitsW + bitsH + getBits(paramRest,'GZIP0');
       
-      if DEMO % Test decoder match
-        cabacParam.fn = fnW;
-        gW = coder.cabacDecode(length(paramRest.cW), cabacParam, ctxInitW, size(data.gW));
-        cabacParam.fn = fnH;
-        gH = coder.cabacDecode(length(paramRest.cH), cabacParam, ctxInitH, size(data.gH));
+      if DEMO && ~cabacParam.estimate % Test decoder match
+        cabacParamW.bytes = bytesW;
+        gW = coder.cabacDecode(length(paramRest.cW), cabacParamW, ctxInitW, size(data.gW));
+        cabacParamH.bytes = bytesH;
+        gH = coder.cabacDecode(length(paramRest.cH), cabacParamH, ctxInitH, size(data.gH));
         
         % Detect mismatch error
         assert(all(gW(:)==data.gW(:)),'Mismatch for W'); assert(all(gH(:)==data.gH(:)),'Mismatch for H');
       end
       
-      % Clean up filenames
-      delete(fnW); delete(fnH);
-      
     case 'GZIP'
       % Encode gW and gH independently
       bitsW = getBits(data.gW,'GZIP0'); 